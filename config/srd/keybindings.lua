@@ -58,38 +58,25 @@ srd.bind("Mod4+l", function()
     srd.window.focus("right")
 end)
 
--- Window resizing
-srd.bind("Mod4+Shift+h", function() 
+-- Resize mode: Mod4+r, then h/j/k/l as often as needed, Escape or
+-- Return to leave
+local function resize_focused(dx, dy, dw, dh)
     local window = srd.window.focused()
     if window then
         local x, y, w, h = window:get_geometry()
-        window:set_geometry(x - 10, y, w + 10, h)
+        window:set_geometry(x + dx, y + dy, w + dw, h + dh)
     end
-end)
-
-srd.bind("Mod4+Shift+j", function() 
-    local window = srd.window.focused()
-    if window then
-        local x, y, w, h = window:get_geometry()
-        window:set_geometry(x, y, w, h + 10)
-    end
-end)
+end
 
-srd.bind("Mod4+Shift+k", function() 
-    local window = srd.window.focused()
-    if window then
-        local x, y, w, h = window:get_geometry()
-        window:set_geometry(x, y - 10, w, h + 10)
-    end
+srd.bind("Mod4+r", function() 
+    srd.enter_mode("resize")
 end)
 
-srd.bind("Mod4+Shift+l", function() 
-    local window = srd.window.focused()
-    if window then
-        local x, y, w, h = window:get_geometry()
-        window:set_geometry(x, y, w + 10, h)
-    end
-end)
+srd.bind_mode("resize", "h", function() resize_focused(-10, 0, 10, 0) end)
+srd.bind_mode("resize", "j", function() resize_focused(0, 0, 0, 10) end)
+srd.bind_mode("resize", "k", function() resize_focused(0, -10, 0, 10) end)
+srd.bind_mode("resize", "l", function() resize_focused(0, 0, 10, 0) end)
+srd.bind_mode("resize", "Return", function() srd.exit_mode() end)
 
 -- Workspace management
 srd.bind("Mod4+Tab", function() 
@@ -155,11 +142,12 @@ srd.bind("Mod4+Return", function()
     srd.spawn("alacritty")
 end)
 
-srd.bind("Mod4+r", function() 
+-- Launchers: Mod4+o, then the application's key
+srd.bind("Mod4+o r", function() 
     srd.spawn("rofi -show run")
 end)
 
-srd.bind("Mod4+w", function() 
+srd.bind("Mod4+o f", function() 
     srd.spawn("firefox")
 end)
 
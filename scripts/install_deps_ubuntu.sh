@@ -5,7 +5,7 @@ sudo apt-get update
 sudo apt-get install -y \
   build-essential cmake ninja-build pkg-config git \
   liblua5.4-dev \
-  libx11-dev libxrandr-dev libxinerama-dev libxfixes-dev libxcursor-dev \
+  libx11-dev libx11-xcb-dev libxrandr-dev libxinerama-dev libxfixes-dev libxcursor-dev \
   libxcb1-dev libxcb-keysyms1-dev libxcb-icccm4-dev libxcb-ewmh-dev libxcb-randr0-dev \
   libxft-dev \
   libwayland-dev wayland-protocols \
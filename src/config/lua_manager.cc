@@ -1,4 +1,5 @@
 #include "lua_manager.h"
+#include "../core/window_manager.h"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -17,16 +18,20 @@ namespace Defaults {
         config["general.smart_placement"] = {LuaConfigValue::Type::Boolean, "", 0.0, true, {}, ""};
         config["general.window_gap"] = {LuaConfigValue::Type::Number, "", 8.0, false, {}, ""};
         config["general.border_width"] = {LuaConfigValue::Type::Number, "", 2.0, false, {}, ""};
+        config["general.decoration_mode"] = {LuaConfigValue::Type::String, "frame", 0.0, false, {}, ""};
+        config["general.compositor"] = {LuaConfigValue::Type::Boolean, "", 0.0, false, {}, ""};
         config["general.animations"] = {LuaConfigValue::Type::Boolean, "", 0.0, true, {}, ""};
         config["general.animation_duration"] = {LuaConfigValue::Type::Number, "", 200.0, false, {}, ""};
         config["general.focus_follows_mouse"] = {LuaConfigValue::Type::Boolean, "", 0.0, false, {}, ""};
         config["general.mouse_follows_focus"] = {LuaConfigValue::Type::Boolean, "", 0.0, true, {}, ""};
         config["general.auto_raise"] = {LuaConfigValue::Type::Boolean, "", 0.0, false, {}, ""};
         config["general.auto_focus"] = {LuaConfigValue::Type::Boolean, "", 0.0, true, {}, ""};
+        config["general.key_sequence_timeout"] = {LuaConfigValue::Type::Number, "", 1000.0, false, {}, ""};
         
         config["monitor.primary_layout"] = {LuaConfigValue::Type::String, "dynamic", 0.0, false, {}, ""};
         config["monitor.secondary_layout"] = {LuaConfigValue::Type::String, "tiling", 0.0, false, {}, ""};
         config["monitor.auto_detect"] = {LuaConfigValue::Type::Boolean, "", 0.0, true, {}, ""};
+        config["monitor.auto_scale"] = {LuaConfigValue::Type::Boolean, "", 0.0, false, {}, ""};
         config["monitor.primary_workspace"] = {LuaConfigValue::Type::Number, "", 1.0, false, {}, ""};
         config["monitor.workspace_count"] = {LuaConfigValue::Type::Number, "", 10.0, false, {}, ""};
         
@@ -39,6 +44,7 @@ namespace Defaults {
         config["debug.log_level"] = {LuaConfigValue::Type::String, "info", 0.0, false, {}, ""};
         config["debug.profile"] = {LuaConfigValue::Type::Boolean, "", 0.0, false, {}, ""};
         config["debug.trace_events"] = {LuaConfigValue::Type::Boolean, "", 0.0, false, {}, ""};
+        config["debug.immediate_flush"] = {LuaConfigValue::Type::Boolean, "", 0.0, false, {}, ""};
         
         return config;
     }
@@ -91,6 +97,7 @@ bool LuaManager::initialize() {
 }
 
 void LuaManager::shutdown() {
+    release_lua_key_bindings();
     if (L_) {
         lua_close(L_);
         L_ = nullptr;
@@ -437,7 +444,7 @@ void LuaManager::register_utility_functions() {
     
     // Register bind function
     lua_pushcfunction(L_, [](lua_State* L) -> int {
-        // srd.bind(key, function)
+        // srd.bind(key, function); key may be a sequence ("Mod4+w f")
         const char* key = lua_tostring(L, 1);
         if (key && lua_isfunction(L, 2)) {
             // Get the global Lua manager instance
@@ -445,9 +452,9 @@ void LuaManager::register_utility_functions() {
             if (lua_islightuserdata(L, -1)) {
                 LuaManager* manager = static_cast<LuaManager*>(lua_touserdata(L, -1));
                 if (manager) {
-                    // Store the function reference
-                    // For now, just store the key binding
-                    manager->bind_key(key, "lua_function");
+                    // Keep the function alive in the registry
+                    lua_pushvalue(L, 2);
+                    manager->bind_lua_key("", key, luaL_ref(L, LUA_REGISTRYINDEX));
                 }
             }
             lua_pop(L, 1); // Remove the userdata
@@ -457,6 +464,60 @@ void LuaManager::register_utility_functions() {
     });
     lua_setfield(L_, -2, "bind");
     
+    // Register bind_mode function
+    lua_pushcfunction(L_, [](lua_State* L) -> int {
+        // srd.bind_mode(mode, key, function): active only inside the mode
+        const char* mode = lua_tostring(L, 1);
+        const char* key = lua_tostring(L, 2);
+        if (mode && key && lua_isfunction(L, 3)) {
+            lua_getglobal(L, "_lua_manager_instance");
+            if (lua_islightuserdata(L, -1)) {
+                LuaManager* manager = static_cast<LuaManager*>(lua_touserdata(L, -1));
+                if (manager) {
+                    lua_pushvalue(L, 3);
+                    manager->bind_lua_key(mode, key, luaL_ref(L, LUA_REGISTRYINDEX));
+                }
+            }
+            lua_pop(L, 1); // Remove the userdata
+            std::cout << "Binding key: " << key << " in mode " << mode << std::endl;
+        }
+        return 0;
+    });
+    lua_setfield(L_, -2, "bind_mode");
+    
+    // Register enter_mode function
+    lua_pushcfunction(L_, [](lua_State* L) -> int {
+        // srd.enter_mode(mode)
+        const char* mode = lua_tostring(L, 1);
+        if (mode) {
+            lua_getglobal(L, "_lua_manager_instance");
+            if (lua_islightuserdata(L, -1)) {
+                LuaManager* manager = static_cast<LuaManager*>(lua_touserdata(L, -1));
+                if (manager) {
+                    manager->enter_key_mode(mode);
+                }
+            }
+            lua_pop(L, 1); // Remove the userdata
+        }
+        return 0;
+    });
+    lua_setfield(L_, -2, "enter_mode");
+    
+    // Register exit_mode function
+    lua_pushcfunction(L_, [](lua_State* L) -> int {
+        // srd.exit_mode()
+        lua_getglobal(L, "_lua_manager_instance");
+        if (lua_islightuserdata(L, -1)) {
+            LuaManager* manager = static_cast<LuaManager*>(lua_touserdata(L, -1));
+            if (manager) {
+                manager->exit_key_mode();
+            }
+        }
+        lua_pop(L, 1); // Remove the userdata
+        return 0;
+    });
+    lua_setfield(L_, -2, "exit_mode");
+    
     // Register load function
     lua_pushcfunction(L_, [](lua_State* L) -> int {
         // srd.load(module_name)
@@ -570,6 +631,7 @@ bool LuaManager::reload_config() {
     // Clear current configuration
     config_values_.clear();
     key_bindings_.clear();
+    release_lua_key_bindings();
     clear_errors();
     
     // Reload default configuration
@@ -784,6 +846,78 @@ bool LuaManager::unbind_key(const std::string& key_combination) {
     return false;
 }
 
+bool LuaManager::bind_lua_key(const std::string& mode, const std::string& key_combination, int function_ref) {
+    auto& ref = lua_key_bindings_[{mode, key_combination}];
+    if (ref != 0 && L_) {
+        luaL_unref(L_, LUA_REGISTRYINDEX, ref); // Rebound
+    }
+    ref = function_ref;
+    if (mode.empty()) {
+        return bind_key(key_combination, "lua_function");
+    }
+    std::cout << "Bound key: " << key_combination << " in mode " << mode << " -> lua_function" << std::endl;
+    return true;
+}
+
+void LuaManager::apply_key_bindings() {
+    if (!window_manager_) {
+        std::cerr << "SRDWindow manager not available for Lua key bindings" << std::endl;
+        return;
+    }
+    
+    // The actions look their function up when run, so a binding dropped by
+    // a config reload does nothing instead of calling a reused reference
+    for (const auto& binding : lua_key_bindings_) {
+        const std::string& mode = binding.first.first;
+        const std::string& keys = binding.first.second;
+        auto action = [this, mode, keys]() { call_lua_key_binding(mode, keys); };
+        if (mode.empty()) {
+            window_manager_->bind_key(keys, action);
+        } else {
+            window_manager_->bind_mode_key(mode, keys, action);
+        }
+    }
+    std::cout << "LuaManager: Applied " << lua_key_bindings_.size() << " key bindings" << std::endl;
+}
+
+void LuaManager::enter_key_mode(const std::string& mode) {
+    if (window_manager_) {
+        window_manager_->enter_key_mode(mode);
+    }
+}
+
+void LuaManager::exit_key_mode() {
+    if (window_manager_) {
+        window_manager_->exit_key_mode();
+    }
+}
+
+void LuaManager::set_window_manager(SRDWindowManager* manager) {
+    window_manager_ = manager;
+    std::cout << "LuaManager: Window manager connected" << std::endl;
+}
+
+void LuaManager::call_lua_key_binding(const std::string& mode, const std::string& key_combination) {
+    auto it = lua_key_bindings_.find({mode, key_combination});
+    if (!L_ || it == lua_key_bindings_.end()) return;
+    
+    lua_rawgeti(L_, LUA_REGISTRYINDEX, it->second);
+    if (lua_pcall(L_, 0, 0, 0) != LUA_OK) {
+        std::string error = lua_tostring(L_, -1);
+        add_lua_error("Key binding '" + key_combination + "' failed: " + error);
+        lua_pop(L_, 1);
+    }
+}
+
+void LuaManager::release_lua_key_bindings() {
+    if (L_) {
+        for (const auto& binding : lua_key_bindings_) {
+            luaL_unref(L_, LUA_REGISTRYINDEX, binding.second);
+        }
+    }
+    lua_key_bindings_.clear();
+}
+
 std::vector<std::string> LuaManager::get_bound_keys() const {
     std::vector<std::string> keys;
     for (const auto& binding : key_bindings_) {
@@ -73,6 +73,16 @@ public:
     bool bind_key(const std::string& key_combination, const std::string& lua_function);
     bool unbind_key(const std::string& key_combination);
     std::vector<std::string> get_bound_keys() const;
+    // srd.bind / srd.bind_mode: the function is held as a registry
+    // reference; an empty mode is a normal binding. The combination may
+    // be a space-separated sequence ("Mod4+w f").
+    bool bind_lua_key(const std::string& mode, const std::string& key_combination, int function_ref);
+    // Hand the Lua bindings to the window manager; call before it
+    // compiles its bindings
+    void apply_key_bindings();
+    void enter_key_mode(const std::string& mode);
+    void exit_key_mode();
+    void set_window_manager(SRDWindowManager* manager);
     
     // Layout system
     bool configure_layout(const std::string& layout_name, const std::map<std::string, LuaConfigValue>& config);
@@ -122,6 +132,7 @@ private:
     lua_State* L_;
     std::map<std::string, LuaConfigValue> config_values_;
     std::map<std::string, std::string> key_bindings_;
+    std::map<std::pair<std::string, std::string>, int> lua_key_bindings_; // (mode, keys) -> function ref
     std::vector<std::string> lua_errors_;
     std::vector<std::string> validation_errors_;
     
@@ -140,6 +151,8 @@ private:
     
     // Configuration helpers
     void parse_config_value(lua_State* L, int index, const std::string& key);
+    void call_lua_key_binding(const std::string& mode, const std::string& key_combination);
+    void release_lua_key_bindings();
     void save_config_to_lua();
     void load_default_config();
     
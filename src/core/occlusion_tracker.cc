@@ -0,0 +1,170 @@
+#include "occlusion_tracker.h"
+#include <algorithm>
+
+namespace {
+
+using Rect = OcclusionTracker::Rect;
+
+// Append the parts of rect not covered by hole (at most four)
+void subtract(const Rect& rect, const Rect& hole, std::vector<Rect>& out) {
+    if (!rect.intersects(hole)) {
+        out.push_back(rect);
+        return;
+    }
+
+    const int left = std::max(rect.x, hole.x);
+    const int right = std::min(rect.x + rect.width, hole.x + hole.width);
+    const int top = std::max(rect.y, hole.y);
+    const int bottom = std::min(rect.y + rect.height, hole.y + hole.height);
+
+    if (top > rect.y) out.push_back({rect.x, rect.y, rect.width, top - rect.y});
+    if (bottom < rect.y + rect.height) out.push_back({rect.x, bottom, rect.width, rect.y + rect.height - bottom});
+    if (left > rect.x) out.push_back({rect.x, top, left - rect.x, bottom - top});
+    if (right < rect.x + rect.width) out.push_back({right, top, rect.x + rect.width - right, bottom - top});
+}
+
+} // namespace
+
+bool OcclusionTracker::Rect::intersects(const Rect& other) const {
+    if (empty() || other.empty()) return false;
+    return x < other.x + other.width && other.x < x + width && y < other.y + other.height &&
+           other.y < y + height;
+}
+
+void OcclusionTracker::add(Id id) {
+    if (windows_.count(id)) return;
+    windows_[id] = Entry{};
+    stack_.push_back(id);
+}
+
+void OcclusionTracker::remove(Id id) {
+    auto it = windows_.find(id);
+    if (it == windows_.end()) return;
+
+    touch(id, it->second);
+    windows_.erase(it);
+    stack_.erase(std::find(stack_.begin(), stack_.end(), id));
+}
+
+bool OcclusionTracker::restack(Id id, Id sibling) {
+    auto it = windows_.find(id);
+    if (it == windows_.end() || id == sibling) return false;
+
+    auto pos = std::find(stack_.begin(), stack_.end(), id);
+    size_t old_index = static_cast<size_t>(pos - stack_.begin());
+    stack_.erase(pos);
+
+    size_t index;
+    if (sibling == 0) {
+        index = 0;
+    } else {
+        auto above = std::find(stack_.begin(), stack_.end(), sibling);
+        index = above == stack_.end() ? stack_.size() : static_cast<size_t>(above - stack_.begin()) + 1;
+    }
+    stack_.insert(stack_.begin() + static_cast<std::ptrdiff_t>(index), id);
+
+    if (index == old_index) return false;
+    touch(id, it->second);
+    return true;
+}
+
+void OcclusionTracker::set_geometry(Id id, const Rect& rect) {
+    auto it = windows_.find(id);
+    if (it == windows_.end()) return;
+
+    Entry& entry = it->second;
+    if (entry.rect.x == rect.x && entry.rect.y == rect.y && entry.rect.width == rect.width &&
+        entry.rect.height == rect.height) {
+        return;
+    }
+    touch(id, entry);
+    entry.rect = rect;
+    touch(id, entry);
+}
+
+void OcclusionTracker::set_mapped(Id id, bool mapped) {
+    auto it = windows_.find(id);
+    if (it == windows_.end() || it->second.mapped == mapped) return;
+
+    touch(id, it->second);
+    it->second.mapped = mapped;
+    touch(id, it->second);
+}
+
+void OcclusionTracker::set_tracked(Id id, bool tracked) {
+    auto it = windows_.find(id);
+    if (it == windows_.end() || it->second.tracked == tracked) return;
+
+    touch(id, it->second);
+    it->second.tracked = tracked;
+    touch(id, it->second);
+}
+
+void OcclusionTracker::set_opaque(Id id, bool opaque) {
+    auto it = windows_.find(id);
+    if (it == windows_.end() || it->second.opaque == opaque) return;
+
+    // Only what lies below changes; the window itself is no more visible
+    if (!opaque) touch(id, it->second);
+    it->second.opaque = opaque;
+    if (opaque) touch(id, it->second);
+}
+
+std::vector<OcclusionTracker::Change> OcclusionTracker::update() {
+    std::vector<Change> changes;
+    if (dirty_.empty() && changed_.empty()) return changes;
+
+    std::sort(changed_.begin(), changed_.end());
+    for (size_t i = 0; i < stack_.size(); ++i) {
+        Entry& entry = windows_[stack_[i]];
+        // Unmapped windows keep their last state until they come back
+        if (!entry.tracked || !entry.mapped) continue;
+
+        bool affected = std::binary_search(changed_.begin(), changed_.end(), stack_[i]);
+        for (size_t d = 0; !affected && d < dirty_.size(); ++d) {
+            affected = entry.rect.intersects(dirty_[d]);
+        }
+        if (!affected) continue;
+
+        bool now_visible = compute_visible(i);
+        if (now_visible != entry.visible) {
+            entry.visible = now_visible;
+            changes.push_back({stack_[i], now_visible});
+        }
+    }
+
+    dirty_.clear();
+    changed_.clear();
+    return changes;
+}
+
+bool OcclusionTracker::visible(Id id) const {
+    auto it = windows_.find(id);
+    return it == windows_.end() || it->second.visible;
+}
+
+void OcclusionTracker::touch(Id id, const Entry& entry) {
+    changed_.push_back(id);
+    if (occluder(entry)) dirty_.push_back(entry.rect);
+}
+
+bool OcclusionTracker::compute_visible(size_t index) const {
+    const Entry& self = windows_.at(stack_[index]);
+    if (self.rect.empty()) return false;
+
+    // Cut every occluder above out of the window; anything left is visible
+    std::vector<Rect> remaining{self.rect};
+    std::vector<Rect> next;
+    for (size_t i = index + 1; i < stack_.size(); ++i) {
+        const Entry& above = windows_.at(stack_[i]);
+        if (!occluder(above)) continue;
+
+        next.clear();
+        for (const Rect& piece : remaining) {
+            subtract(piece, above.rect, next);
+        }
+        remaining.swap(next);
+        if (remaining.empty()) return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef SRDWM_OCCLUSION_TRACKER_H
+#define SRDWM_OCCLUSION_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Which top-level windows can be seen, from stacking order and geometry.
+//
+// The tracker mirrors the stack of top-level windows (bottom to top).
+// Every window takes part in the stacking order, but only "tracked" ones
+// (the windows we manage) occlude others or get a visibility; the rest
+// (menus, tooltips, our own titlebars) only keep the order right. A
+// translucent window is seen through and occludes nothing.
+//
+// Changes are collected and applied by update(): only windows touching a
+// rectangle that changed since the last update are recomputed, and only
+// windows whose visibility actually flipped are reported.
+class OcclusionTracker {
+public:
+    using Id = uint64_t;
+
+    struct Rect {
+        int x = 0, y = 0, width = 0, height = 0;
+        bool empty() const { return width <= 0 || height <= 0; }
+        bool intersects(const Rect& other) const;
+    };
+
+    struct Change {
+        Id id;
+        bool visible;
+    };
+
+    // A window is added on top of the stack, unmapped and untracked; adding
+    // a known window does nothing
+    void add(Id id);
+    void remove(Id id);
+
+    // Place id directly above sibling, or at the bottom for 0. An unknown
+    // sibling puts it on top, where the server puts new windows. True if
+    // the stacking order changed.
+    bool restack(Id id, Id sibling);
+    bool raise(Id id) { return restack(id, top()); }
+    void set_geometry(Id id, const Rect& rect);
+    void set_mapped(Id id, bool mapped);
+    void set_tracked(Id id, bool tracked);
+    void set_opaque(Id id, bool opaque);
+
+    std::vector<Change> update();
+
+    bool contains(Id id) const { return windows_.count(id) != 0; }
+    bool visible(Id id) const; // As of the last update(); true if unknown
+    Id top() const { return stack_.empty() ? 0 : stack_.back(); }
+    const std::vector<Id>& stack() const { return stack_; } // Bottom to top
+
+private:
+    struct Entry {
+        Rect rect;
+        bool mapped = false;
+        bool tracked = false;
+        bool opaque = true;
+        bool visible = true; // Last reported
+    };
+
+    bool occluder(const Entry& entry) const {
+        return entry.tracked && entry.mapped && entry.opaque && !entry.rect.empty();
+    }
+    void touch(Id id, const Entry& entry);
+    bool compute_visible(size_t index) const;
+
+    std::map<Id, Entry> windows_;
+    std::vector<Id> stack_;   // Bottom to top
+    std::vector<Rect> dirty_; // Areas whose occlusion may have changed
+    std::vector<Id> changed_; // Windows whose own state changed
+};
+
+#endif // SRDWM_OCCLUSION_TRACKER_H
@@ -0,0 +1,263 @@
+#include "session_snapshot.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint32_t kSnapshotMagic = 0x53445253; // "SRDS"
+constexpr uint32_t kSnapshotVersion = 2;
+
+class SnapshotWriter {
+public:
+    void put_u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            data_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    void put_i32(int value) { put_u32(static_cast<uint32_t>(value)); }
+    void put_string(const std::string& value) {
+        put_u32(static_cast<uint32_t>(value.size()));
+        data_.insert(data_.end(), value.begin(), value.end());
+    }
+    void put_ids(const std::vector<int>& ids) {
+        put_u32(static_cast<uint32_t>(ids.size()));
+        for (int id : ids) put_i32(id);
+    }
+    std::vector<uint8_t>& data() { return data_; }
+
+private:
+    std::vector<uint8_t> data_;
+};
+
+// Every read is bounds-checked; a truncated or foreign blob just fails
+class SnapshotReader {
+public:
+    SnapshotReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    bool get_u32(uint32_t& value) {
+        if (size_ - pos_ < 4) return false;
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(data_[pos_++]) << (8 * i);
+        }
+        return true;
+    }
+    bool get_i32(int& value) {
+        uint32_t raw;
+        if (!get_u32(raw)) return false;
+        value = static_cast<int>(raw);
+        return true;
+    }
+    bool get_string(std::string& value) {
+        uint32_t length;
+        if (!get_u32(length) || size_ - pos_ < length) return false;
+        value.assign(reinterpret_cast<const char*>(data_ + pos_), length);
+        pos_ += length;
+        return true;
+    }
+    bool get_ids(std::vector<int>& ids) {
+        uint32_t count;
+        if (!get_u32(count) || (size_ - pos_) / 4 < count) return false;
+        ids.resize(count);
+        for (int& id : ids) {
+            if (!get_i32(id)) return false;
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+std::string cache_snapshot_path() {
+    const char* cache_home = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    std::string dir;
+    if (cache_home && *cache_home) {
+        dir = std::string(cache_home) + "/srdwm";
+    } else if (home && *home) {
+        dir = std::string(home) + "/.cache/srdwm";
+    } else {
+        return std::string();
+    }
+    return dir + "/restart.snapshot";
+}
+
+} // namespace
+
+std::vector<uint8_t> SessionSnapshot::serialize() const {
+    SnapshotWriter writer;
+    writer.put_u32(kSnapshotMagic);
+    writer.put_u32(kSnapshotVersion);
+    writer.put_i32(current_workspace);
+    writer.put_i32(focused_window);
+
+    writer.put_u32(static_cast<uint32_t>(workspaces.size()));
+    for (const WorkspaceState& workspace : workspaces) {
+        writer.put_i32(workspace.id);
+        writer.put_string(workspace.name);
+        writer.put_string(workspace.layout);
+        writer.put_ids(workspace.windows);
+    }
+
+    writer.put_ids(floating_windows);
+    writer.put_ids(focus_order);
+
+    writer.put_u32(static_cast<uint32_t>(monitor_layouts.size()));
+    for (const MonitorLayout& monitor : monitor_layouts) {
+        writer.put_i32(monitor.monitor_id);
+        writer.put_string(monitor.layout);
+    }
+
+    writer.put_u32(static_cast<uint32_t>(geometries.size()));
+    for (const WindowGeometry& geometry : geometries) {
+        writer.put_i32(geometry.id);
+        writer.put_i32(geometry.x);
+        writer.put_i32(geometry.y);
+        writer.put_i32(geometry.width);
+        writer.put_i32(geometry.height);
+    }
+
+    return std::move(writer.data());
+}
+
+bool SessionSnapshot::deserialize(const uint8_t* data, size_t size, SessionSnapshot& out) {
+    SnapshotReader reader(data, size);
+    SessionSnapshot snapshot;
+
+    uint32_t magic, version, count;
+    if (!reader.get_u32(magic) || magic != kSnapshotMagic) return false;
+    if (!reader.get_u32(version) || version != kSnapshotVersion) return false;
+    if (!reader.get_i32(snapshot.current_workspace) || !reader.get_i32(snapshot.focused_window)) return false;
+
+    if (!reader.get_u32(count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        WorkspaceState workspace;
+        if (!reader.get_i32(workspace.id) || !reader.get_string(workspace.name) ||
+            !reader.get_string(workspace.layout) || !reader.get_ids(workspace.windows)) {
+            return false;
+        }
+        snapshot.workspaces.push_back(std::move(workspace));
+    }
+
+    if (!reader.get_ids(snapshot.floating_windows) || !reader.get_ids(snapshot.focus_order)) return false;
+
+    if (!reader.get_u32(count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        MonitorLayout monitor;
+        if (!reader.get_i32(monitor.monitor_id) || !reader.get_string(monitor.layout)) return false;
+        snapshot.monitor_layouts.push_back(std::move(monitor));
+    }
+
+    if (!reader.get_u32(count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        WindowGeometry geometry;
+        if (!reader.get_i32(geometry.id) || !reader.get_i32(geometry.x) || !reader.get_i32(geometry.y) ||
+            !reader.get_i32(geometry.width) || !reader.get_i32(geometry.height)) {
+            return false;
+        }
+        snapshot.geometries.push_back(geometry);
+    }
+
+    out = std::move(snapshot);
+    return true;
+}
+
+std::string SessionSnapshot::write() const {
+#if defined(__unix__) || defined(__APPLE__)
+    std::vector<uint8_t> data = serialize();
+
+    int fd = -1;
+    std::string path;
+#ifdef __linux__
+    // Anonymous memory file; inherited across exec (no MFD_CLOEXEC) and
+    // reopened by the new process through /proc/self/fd
+    fd = memfd_create("srdwm-snapshot", 0);
+    if (fd >= 0) {
+        path = "/proc/self/fd/" + std::to_string(fd);
+    }
+#endif
+    if (fd < 0) {
+        path = cache_snapshot_path();
+        if (path.empty()) return std::string();
+        std::string dir = path.substr(0, path.rfind('/'));
+        mkdir(dir.substr(0, dir.rfind('/')).c_str(), 0700);
+        mkdir(dir.c_str(), 0700);
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            std::cerr << "SessionSnapshot: Cannot create " << path << ": " << std::strerror(errno) << std::endl;
+            return std::string();
+        }
+    }
+
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "SessionSnapshot: Write failed: " << std::strerror(errno) << std::endl;
+            close(fd);
+            return std::string();
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    // The memfd must stay open for the exec'd process; a real file need not
+    if (path.compare(0, 14, "/proc/self/fd/") != 0) {
+        close(fd);
+    }
+    return path;
+#else
+    return std::string();
+#endif
+}
+
+bool SessionSnapshot::read(const std::string& path, SessionSnapshot& out) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "SessionSnapshot: Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    bool ok = false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        size_t size = static_cast<size_t>(st.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            ok = deserialize(static_cast<const uint8_t*>(mapping), size, out);
+            munmap(mapping, size);
+        }
+    }
+    close(fd);
+
+    // The memfd we inherited is released with its last descriptor; the
+    // cache file fallback is single-use
+    if (path.compare(0, 14, "/proc/self/fd/") == 0) {
+        close(std::atoi(path.c_str() + 14));
+    } else {
+        unlink(path.c_str());
+    }
+
+    if (!ok) {
+        std::cerr << "SessionSnapshot: Ignoring invalid snapshot " << path << std::endl;
+    }
+    return ok;
+#else
+    (void)path;
+    (void)out;
+    return false;
+#endif
+}
@@ -0,0 +1,55 @@
+#ifndef SRDWM_SESSION_SNAPSHOT_H
+#define SRDWM_SESSION_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Window manager state carried across an in-place restart.
+//
+// Windows are referred to by id (the platform window id), which survives
+// the restart because the clients themselves keep running. The snapshot
+// is written to an anonymous memfd (or ~/.cache/srdwm/ where memfd is not
+// available), the path is passed to the new process on the command line,
+// and the new process maps it back in.
+struct SessionSnapshot {
+    struct WorkspaceState {
+        int id = 0;
+        std::string name;
+        std::string layout;
+        std::vector<int> windows;
+    };
+
+    struct MonitorLayout {
+        int monitor_id = 0;
+        std::string layout;
+    };
+
+    // Where the window (its frame, when decorated) was, since re-framing
+    // an adopted client cannot tell where the old frame stood
+    struct WindowGeometry {
+        int id = 0;
+        int x = 0, y = 0, width = 0, height = 0;
+    };
+
+    int current_workspace = 0;
+    int focused_window = -1;
+    std::vector<WorkspaceState> workspaces;
+    std::vector<int> floating_windows;
+    std::vector<int> focus_order; // Window cycling order
+    std::vector<MonitorLayout> monitor_layouts;
+    std::vector<WindowGeometry> geometries;
+
+    std::vector<uint8_t> serialize() const;
+    static bool deserialize(const uint8_t* data, size_t size, SessionSnapshot& out);
+
+    // Write the snapshot somewhere the exec'd process can open it; returns
+    // the path to hand over, or an empty string on failure
+    std::string write() const;
+
+    // Map and decode a snapshot written by write(). A snapshot file under
+    // the cache directory is removed once read.
+    static bool read(const std::string& path, SessionSnapshot& out);
+};
+
+#endif // SRDWM_SESSION_SNAPSHOT_H
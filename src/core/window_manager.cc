@@ -4,9 +4,16 @@
 #include "../layouts/layout_engine.h"
 #include "../platform/platform.h"
 #include "../config/lua_manager.h"
+#include "session_snapshot.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <cstdlib>
+#include <unordered_map>
+#include <iterator>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
 
 SRDWindowManager::SRDWindowManager() {
     std::cout << "SRDWindowManager: Initializing..." << std::endl;
@@ -29,6 +36,12 @@ void SRDWindowManager::run() {
     
     bool running = true;
     while (running) {
+        // Bindings changed by an action (e.g. from Lua) are compiled here,
+        // between dispatches, never under the action that changed them
+        if (key_bindings_.dirty()) {
+            compile_key_bindings();
+        }
+        
         // Poll for platform events
         std::vector<Event> events;
         if (platform_->poll_events(events)) {
@@ -44,13 +57,18 @@ void SRDWindowManager::run() {
             }
         }
         
+        // Drop a half-typed key sequence once it has gone stale
+        expire_key_sequence();
+        
         // Manage windows
         manage_windows();
         
         // Arrange windows if needed
-        if (layout_engine_) {
-            layout_engine_->arrange_all_monitors();
-        }
+        arrange_monitors();
+        
+        // Send everything the handlers and the layout pass queued up in
+        // one write
+        platform_->flush();
         
         // Small delay to prevent busy waiting
         // TODO: Use proper event-driven approach instead of polling
@@ -63,16 +81,228 @@ void SRDWindowManager::run() {
 // SRDWindow management
 void SRDWindowManager::add_window(std::unique_ptr<SRDWindow> window) {
     if (window) {
-        windows_.push_back(window.get());
-        window.release(); // Transfer ownership
+        SRDWindow* added = window.release(); // Transfer ownership
+        windows_.push_back(added);
+        
+        // New windows open on the current workspace
+        if (Workspace* workspace = get_workspace(current_workspace_)) {
+            workspace->windows.push_back(added);
+            if (platform_) {
+                platform_->set_window_workspace(added, static_cast<int>(workspace_index_[current_workspace_]));
+            }
+        }
         
         // Add to layout engine if available
         if (layout_engine_) {
-            layout_engine_->add_window(window.get());
+            layout_engine_->add_window(added);
         }
         
-        std::cout << "SRDWindowManager: Added window " << window->getId() << std::endl;
+        std::cout << "SRDWindowManager: Added window " << added->getId() << std::endl;
+    }
+}
+
+void SRDWindowManager::adopt_existing_windows() {
+    if (!platform_) return;
+    
+    std::vector<SRDWindow*> adopted = platform_->adopt_existing_windows();
+    
+    // Register the whole batch first, without arranging per window
+    Workspace* workspace = get_workspace(current_workspace_);
+    for (SRDWindow* window : adopted) {
+        windows_.push_back(window);
+        if (layout_engine_) {
+            layout_engine_->add_window(window);
+        }
+        if (workspace) {
+            workspace->windows.push_back(window);
+        }
+    }
+    
+    // Then one layout pass and one flush for all of them
+    arrange_windows();
+    platform_->flush();
+    
+    std::cout << "SRDWindowManager: Adopted " << adopted.size() << " existing windows" << std::endl;
+}
+
+SessionSnapshot SRDWindowManager::snapshot_session() const {
+    SessionSnapshot snapshot;
+    snapshot.current_workspace = current_workspace_;
+    snapshot.focused_window = focused_window_ ? focused_window_->getId() : -1;
+    
+    for (const Workspace& workspace : workspaces_) {
+        SessionSnapshot::WorkspaceState state;
+        state.id = workspace.id;
+        state.name = workspace.name;
+        state.layout = workspace.layout;
+        for (SRDWindow* window : workspace.windows) {
+            state.windows.push_back(window->getId());
+        }
+        snapshot.workspaces.push_back(std::move(state));
+    }
+    
+    for (SRDWindow* window : floating_windows_) {
+        snapshot.floating_windows.push_back(window->getId());
+    }
+    for (SRDWindow* window : windows_) {
+        snapshot.focus_order.push_back(window->getId());
+        snapshot.geometries.push_back(
+            {window->getId(), window->getX(), window->getY(), window->getWidth(), window->getHeight()});
+    }
+    
+    if (layout_engine_) {
+        for (const Monitor& monitor : layout_engine_->get_monitors()) {
+            snapshot.monitor_layouts.push_back({monitor.id, layout_engine_->get_layout_name(monitor.id)});
+        }
+    }
+    
+    return snapshot;
+}
+
+bool SRDWindowManager::restart(const std::string& executable) {
+#if defined(__unix__) || defined(__APPLE__)
+    std::string path = snapshot_session().write();
+    if (path.empty()) {
+        std::cerr << "SRDWindowManager: Could not write session snapshot, not restarting" << std::endl;
+        return false;
+    }
+    
+    std::cout << "SRDWindowManager: Restarting " << executable << " with snapshot " << path << std::endl;
+    
+    // Release the display (and our frames) so the new process can take over
+    if (platform_) {
+        platform_->flush();
+        platform_->shutdown();
+    }
+    
+    std::vector<char*> args;
+    std::string restore_flag = "--restore";
+    args.push_back(const_cast<char*>(executable.c_str()));
+    args.push_back(const_cast<char*>(restore_flag.c_str()));
+    args.push_back(const_cast<char*>(path.c_str()));
+    args.push_back(nullptr);
+    // Re-exec this very binary rather than whatever PATH now resolves
+    // argv[0] to; fall back to argv[0] where /proc is not mounted
+    execv("/proc/self/exe", args.data());
+    execvp(executable.c_str(), args.data());
+    
+    // The platform is gone at this point, there is nothing to go back to
+    std::cerr << "SRDWindowManager: exec of " << executable << " failed" << std::endl;
+    std::exit(EXIT_FAILURE);
+#else
+    (void)executable;
+    std::cerr << "SRDWindowManager: In-place restart is not supported on this platform" << std::endl;
+    return false;
+#endif
+}
+
+void SRDWindowManager::restore_session(const SessionSnapshot& snapshot) {
+    if (!platform_) return;
+    
+    // Reattach to the still-running clients by id
+    std::unordered_map<int, SRDWindow*> by_id;
+    for (SRDWindow* window : platform_->adopt_existing_windows()) {
+        by_id[window->getId()] = window;
+    }
+    auto lookup = [&by_id](int id) -> SRDWindow* {
+        auto it = by_id.find(id);
+        return it != by_id.end() ? it->second : nullptr;
+    };
+    
+    // Cycling order first, then anything the snapshot did not know about
+    for (int id : snapshot.focus_order) {
+        if (SRDWindow* window = lookup(id)) {
+            windows_.push_back(window);
+        }
+    }
+    for (const auto& pair : by_id) {
+        if (std::find(windows_.begin(), windows_.end(), pair.second) == windows_.end()) {
+            windows_.push_back(pair.second);
+        }
+    }
+    
+    // Adopting framed each client where the server left it, one frame
+    // offset away from where it was; put the frames back
+    for (const SessionSnapshot::WindowGeometry& geometry : snapshot.geometries) {
+        if (SRDWindow* window = lookup(geometry.id)) {
+            window->setGeometry(geometry.x, geometry.y, geometry.width, geometry.height);
+            platform_->apply_window_geometry(window);
+        }
+    }
+    
+    std::set<SRDWindow*> placed;
+    for (const SessionSnapshot::WorkspaceState& state : snapshot.workspaces) {
+        Workspace* workspace = get_workspace(state.id);
+        if (!workspace) {
+            workspaces_.emplace_back(state.id, state.name);
+            next_workspace_id_ = std::max(next_workspace_id_, state.id + 1);
+            index_workspaces();
+            workspace = &workspaces_.back();
+        }
+        workspace->name = state.name;
+        workspace->layout = state.layout;
+        workspace->windows.clear();
+        for (int id : state.windows) {
+            if (SRDWindow* window = lookup(id)) {
+                workspace->windows.push_back(window);
+                placed.insert(window);
+            }
+        }
+    }
+    
+    if (get_workspace(snapshot.current_workspace)) {
+        current_workspace_ = snapshot.current_workspace;
+    }
+    assign_workspaces();
+    
+    Workspace* current = get_workspace(current_workspace_);
+    for (SRDWindow* window : windows_) {
+        if (current && !placed.count(window)) {
+            current->windows.push_back(window);
+        }
+    }
+    sync_platform_workspaces(true);
+    
+    // Every client comes back mapped (the server maps save-set windows
+    // when we exit); put the other workspaces away again in one go
+    std::vector<SRDWindow*> hidden;
+    for (const Workspace& workspace : workspaces_) {
+        if (workspace.visible) {
+            for (SRDWindow* window : workspace.windows) {
+                if (layout_engine_) {
+                    layout_engine_->add_window(window);
+                }
+            }
+        } else {
+            hidden.insert(hidden.end(), workspace.windows.begin(), workspace.windows.end());
+        }
+    }
+    platform_->apply_workspace_switch(hidden, {});
+    
+    for (int id : snapshot.floating_windows) {
+        if (SRDWindow* window = lookup(id)) {
+            floating_windows_.insert(window);
+            platform_->set_window_floating(window, true);
+        }
+    }
+    
+    if (layout_engine_) {
+        for (const SessionSnapshot::MonitorLayout& monitor : snapshot.monitor_layouts) {
+            layout_engine_->set_layout(monitor.monitor_id, monitor.layout);
+        }
     }
+    
+    if (SRDWindow* focused = lookup(snapshot.focused_window)) {
+        focus_window(focused);
+        platform_->focus_window(focused);
+    }
+    
+    // Layout caches start out empty, so the next pass lays every monitor
+    // out again; the tiled windows come out where they already are and
+    // the platform sends nothing for them
+    platform_->flush();
+    
+    std::cout << "SRDWindowManager: Restored session with " << windows_.size() << " windows" << std::endl;
 }
 
 void SRDWindowManager::remove_window(SRDWindow* window) {
@@ -80,11 +310,26 @@ void SRDWindowManager::remove_window(SRDWindow* window) {
     if (it != windows_.end()) {
         windows_.erase(it);
         
+        // Its workspace, shown or not, re-tiles without it on the next pass
+        for (Workspace& workspace : workspaces_) {
+            workspace.windows.erase(std::remove(workspace.windows.begin(), workspace.windows.end(), window),
+                                    workspace.windows.end());
+        }
+        floating_windows_.erase(window);
+        for (auto fullscreen = fullscreen_monitors_.begin(); fullscreen != fullscreen_monitors_.end();) {
+            fullscreen = fullscreen->second == window->getId() ? fullscreen_monitors_.erase(fullscreen)
+                                                               : std::next(fullscreen);
+        }
+        
         // Remove from layout engine if available
         if (layout_engine_) {
             layout_engine_->remove_window(window);
         }
         
+        if (focused_window_ == window) focused_window_ = nullptr;
+        if (dragging_window_ == window) dragging_window_ = nullptr;
+        if (resizing_window_ == window) resizing_window_ = nullptr;
+        
         std::cout << "SRDWindowManager: Removed window " << window->getId() << std::endl;
     }
 }
@@ -212,6 +457,10 @@ void SRDWindowManager::toggle_window_floating(SRDWindow* window) {
         std::cout << "SRDWindowManager: Window " << window->getId() << " is now floating" << std::endl;
     }
     
+    if (platform_) {
+        platform_->set_window_floating(window, is_window_floating(window));
+    }
+    
     // Re-arrange windows to reflect the change
     arrange_windows();
 }
@@ -221,6 +470,21 @@ bool SRDWindowManager::is_window_floating(SRDWindow* window) const {
     return floating_windows_.find(window) != floating_windows_.end();
 }
 
+// The platform reports the outcome as a WindowFullscreen event, which is
+// what updates fullscreen_monitors_ (clients can go fullscreen on their own)
+void SRDWindowManager::toggle_window_fullscreen(SRDWindow* window) {
+    if (!window || !platform_) return;
+    platform_->set_window_fullscreen(window, !is_window_fullscreen(window));
+}
+
+bool SRDWindowManager::is_window_fullscreen(SRDWindow* window) const {
+    if (!window) return false;
+    for (const auto& pair : fullscreen_monitors_) {
+        if (pair.second == window->getId()) return true;
+    }
+    return false;
+}
+
 // Window dragging and resizing implementation
 void SRDWindowManager::start_window_drag(SRDWindow* window, int start_x, int start_y) {
     if (!window || dragging_window_) return;
@@ -256,10 +520,11 @@ void SRDWindowManager::update_window_drag(int x, int y) {
     int new_x = drag_start_window_x_ + delta_x;
     int new_y = drag_start_window_y_ + delta_y;
     
-    // Ensure window stays within monitor bounds
-    // TODO: Get actual monitor bounds
-    new_x = std::max(0, std::min(new_x, 1920 - dragging_window_->getWidth()));
-    new_y = std::max(0, std::min(new_y, 1080 - dragging_window_->getHeight()));
+    // Ensure window stays within the monitor under the pointer
+    if (const Monitor* monitor = monitor_index_.nearest(x, y)) {
+        new_x = std::max(monitor->x, std::min(new_x, monitor->x + monitor->width - dragging_window_->getWidth()));
+        new_y = std::max(monitor->y, std::min(new_y, monitor->y + monitor->height - dragging_window_->getHeight()));
+    }
     
     dragging_window_->setPosition(new_x, new_y);
     update_layout_for_window(dragging_window_);
@@ -298,9 +563,13 @@ void SRDWindowManager::update_window_resize(int x, int y) {
             break;
     }
     
-    // Ensure minimum size and bounds
-    new_width = std::max(100, std::min(new_width, 1920 - new_x));
-    new_height = std::max(100, std::min(new_height, 1080 - new_y));
+    // Ensure minimum size and the bounds of the window's monitor
+    if (const Monitor* monitor = monitor_index_.nearest(new_x, new_y)) {
+        new_width = std::min(new_width, monitor->x + monitor->width - new_x);
+        new_height = std::min(new_height, monitor->y + monitor->height - new_y);
+    }
+    new_width = std::max(100, new_width);
+    new_height = std::max(100, new_height);
     
     resizing_window_->setPosition(new_x, new_y);
     resizing_window_->setSize(new_width, new_height);
@@ -338,11 +607,61 @@ std::string SRDWindowManager::get_layout(int monitor_id) const {
 
 void SRDWindowManager::arrange_windows() {
     if (layout_engine_) {
-        layout_engine_->arrange_all_monitors();
+        arrange_monitors();
         std::cout << "SRDWindowManager: Arranged all windows" << std::endl;
     }
 }
 
+// Each monitor lays out the tiled windows of the workspace it shows.
+// Monitors whose windows, geometry and layout configuration are as the
+// workspace's cache recorded them are left alone. The others are laid out
+// again and, with commit, their windows sent to the platform, which
+// only configures the ones that actually moved.
+void SRDWindowManager::arrange_monitors(bool commit) {
+    if (!layout_engine_) return;
+    for (const Monitor& monitor : layout_engine_->get_monitors()) {
+        arrange_monitor(monitor, commit);
+    }
+}
+
+// Without commit the caller sends the geometry itself, so only call it
+// for monitors whose windows the caller is about to send
+void SRDWindowManager::arrange_monitor(const Monitor& monitor, bool commit) {
+    if (!layout_engine_) return;
+    
+    // A fullscreen window owns its monitor; the windows behind it are
+    // not re-tiled until it leaves, or its workspace is switched away
+    auto fullscreen = fullscreen_monitors_.find(monitor.id);
+    if (fullscreen != fullscreen_monitors_.end() && !is_on_hidden_workspace(fullscreen->second)) {
+        return;
+    }
+    
+    Workspace* workspace = get_monitor_workspace(monitor.id);
+    if (!workspace) return;
+    
+    std::vector<SRDWindow*> windows;
+    windows.reserve(workspace->windows.size());
+    for (SRDWindow* window : workspace->windows) {
+        if (!floating_windows_.count(window)) {
+            windows.push_back(window);
+        }
+    }
+    const uint64_t generation = layout_engine_->generation();
+    const Monitor* area = work_area(monitor.id);
+    if (!area) area = &monitor;
+    if (workspace->layout_cache.valid(monitor.id, LayoutCache::stamp(windows, *area, generation))) {
+        return;
+    }
+    
+    layout_engine_->arrange_on_monitor(*area, windows);
+    workspace->layout_cache.store(monitor.id, LayoutCache::stamp(windows, *area, generation));
+    if (commit && platform_) {
+        for (SRDWindow* window : windows) {
+            platform_->apply_window_geometry(window);
+        }
+    }
+}
+
 void SRDWindowManager::tile_windows() {
     set_layout(0, "tiling");
     arrange_windows();
@@ -354,36 +673,124 @@ void SRDWindowManager::arrange_windows_dynamic() {
 }
 
 // Key binding system
+// Bindings are only collected here; compile_key_bindings() builds the
+// lookup table and the grab list in one go once the config is loaded
 void SRDWindowManager::bind_key(const std::string& key_combination, std::function<void()> action) {
-    key_bindings_[key_combination] = action;
-    std::cout << "SRDWindowManager: Bound key '" << key_combination << "'" << std::endl;
+    if (key_bindings_.bind(key_combination, std::move(action))) {
+        std::cout << "SRDWindowManager: Bound key '" << key_combination << "'" << std::endl;
+    }
 }
 
 void SRDWindowManager::unbind_key(const std::string& key_combination) {
-    auto it = key_bindings_.find(key_combination);
-    if (it != key_bindings_.end()) {
-        key_bindings_.erase(it);
+    if (key_bindings_.unbind(key_combination)) {
         std::cout << "SRDWindowManager: Unbound key '" << key_combination << "'" << std::endl;
     }
 }
 
-void SRDWindowManager::handle_key_press(int key_code, int modifiers) {
-    std::string key_string = key_code_to_string(key_code, modifiers);
-    pressed_keys_[key_code] = modifiers;
+void SRDWindowManager::bind_mode_key(const std::string& mode, const std::string& key_combination,
+                                     std::function<void()> action) {
+    if (key_bindings_.bind(key_combination, std::move(action), mode)) {
+        std::cout << "SRDWindowManager: Bound key '" << key_combination << "' in mode '" << mode << "'" << std::endl;
+    }
+}
+
+void SRDWindowManager::enter_key_mode(const std::string& mode) {
+    // Usually called from a binding's action, while the table is
+    // dispatching. Bindings added since the last compile are not in it
+    // yet; the mode is entered once they are compiled.
+    if (key_bindings_.dirty()) {
+        pending_key_mode_ = mode;
+        return;
+    }
+    if (!key_bindings_.enter_mode(mode)) {
+        std::cerr << "SRDWindowManager: No bindings for key mode '" << mode << "'" << std::endl;
+        return;
+    }
+    std::cout << "SRDWindowManager: Entered key mode '" << mode << "'" << std::endl;
+    sync_keyboard_grab();
+}
+
+void SRDWindowManager::exit_key_mode() {
+    pending_key_mode_.clear();
+    key_bindings_.exit_mode();
+    sync_keyboard_grab();
+}
+
+void SRDWindowManager::set_key_sequence_timeout(int milliseconds) {
+    key_sequence_timeout_ = std::chrono::milliseconds(std::max(0, milliseconds));
+}
+
+void SRDWindowManager::compile_key_bindings() {
+    key_bindings_.compile();
+    if (platform_) {
+        platform_->grab_keys(key_bindings_.grabs());
+    }
+    sync_keyboard_grab(); // Compiling resets any pending sequence or mode
+    std::cout << "SRDWindowManager: Compiled key bindings (" << key_bindings_.grabs().size() << " grabs)" << std::endl;
     
-    std::cout << "SRDWindowManager: Key press " << key_code << " (modifiers: " << modifiers << ") -> '" << key_string << "'" << std::endl;
+    if (!pending_key_mode_.empty()) {
+        std::string mode;
+        mode.swap(pending_key_mode_);
+        enter_key_mode(mode);
+    }
+}
+
+// The keyboard is grabbed only between the first key of a sequence (or
+// entering a mode) and its end, so ordinary typing goes to the client
+void SRDWindowManager::sync_keyboard_grab() {
+    bool wanted = key_bindings_.wants_keyboard();
+    if (wanted == keyboard_grabbed_ || !platform_) return;
+
+    if (wanted) {
+        platform_->grab_keyboard();
+    } else {
+        platform_->ungrab_keyboard();
+    }
+    keyboard_grabbed_ = wanted;
+}
+
+void SRDWindowManager::expire_key_sequence() {
+    if (!key_bindings_.sequence_pending() || std::chrono::steady_clock::now() < key_sequence_deadline_) {
+        return;
+    }
+    key_bindings_.cancel_sequence();
+    sync_keyboard_grab();
+}
+
+void SRDWindowManager::handle_key_press(int key_code, int modifiers, bool modifier_key) {
+    // Bindings changed at runtime (e.g. from Lua) are picked up here
+    if (key_bindings_.dirty()) {
+        compile_key_bindings();
+    }
     
-    // Check for key bindings
-    auto it = key_bindings_.find(key_string);
-    if (it != key_bindings_.end()) {
-        std::cout << "SRDWindowManager: Executing key binding for '" << key_string << "'" << std::endl;
-        it->second();
+    if (key_code >= 0 && static_cast<size_t>(key_code) < pressed_keys_.size()) {
+        pressed_keys_.set(static_cast<size_t>(key_code));
+        pressed_modifiers_[static_cast<size_t>(key_code)] = static_cast<uint8_t>(modifiers & KeyMod::All);
+    }
+    
+    // Pressing Shift for the next step of a sequence must not abort it
+    if (modifier_key) return;
+    
+    // One probe on (sequence node, key code, raw modifier state); lock
+    // variants are in the table
+    const KeyBindingTable::Action* action = nullptr;
+    KeyBindingTable::PressResult result = key_bindings_.press(static_cast<uint32_t>(key_code),
+                                                              static_cast<uint32_t>(modifiers), action);
+    if (result == KeyBindingTable::PressResult::Pending) {
+        key_sequence_deadline_ = std::chrono::steady_clock::now() + key_sequence_timeout_;
+    }
+    sync_keyboard_grab();
+    
+    if (action) {
+        (*action)();
     }
 }
 
 void SRDWindowManager::handle_key_release(int key_code, int modifiers) {
-    pressed_keys_.erase(key_code);
-    std::cout << "SRDWindowManager: Key release " << key_code << std::endl;
+    (void)modifiers;
+    if (key_code >= 0 && static_cast<size_t>(key_code) < pressed_keys_.size()) {
+        pressed_keys_.reset(static_cast<size_t>(key_code));
+    }
 }
 
 // Integration
@@ -399,6 +806,19 @@ void SRDWindowManager::set_lua_manager(LuaManager* manager) {
 
 void SRDWindowManager::set_platform(Platform* platform) {
     platform_ = platform;
+    if (platform_) {
+        key_bindings_.set_resolver([platform](const std::string& key_name) {
+            return platform->key_codes_for(key_name);
+        });
+        std::vector<Monitor> monitors = platform_->get_monitors();
+        if (!monitors.empty()) {
+            store_work_areas(platform_->get_work_areas());
+            set_monitors(monitors);
+        }
+        sync_platform_workspaces(true);
+    } else {
+        key_bindings_.set_resolver(nullptr);
+    }
     std::cout << "SRDWindowManager: Platform connected" << std::endl;
 }
 
@@ -462,58 +882,227 @@ void SRDWindowManager::handle_mouse_motion(int x, int y) {
 }
 
 void SRDWindowManager::handle_event(const Event& event) {
+    switch (event.type) {
+        case EventType::KeyPress:
+        case EventType::KeyRelease:
+            if (event.data && event.data_size == sizeof(KeyboardEvent)) {
+                const auto* key = static_cast<const KeyboardEvent*>(event.data);
+                if (event.type == EventType::KeyPress) {
+                    handle_key_press(key->key_code, key->modifiers, key->modifier_key);
+                } else {
+                    handle_key_release(key->key_code, key->modifiers);
+                }
+            }
+            return;
+        case EventType::WindowCreated:
+            // Clients mapped at runtime join the current workspace like
+            // the adopted ones did at startup
+            if (event.data) {
+                add_window(std::unique_ptr<SRDWindow>(static_cast<SRDWindow*>(event.data)));
+            }
+            return;
+        case EventType::WindowDestroyed:
+            if (event.data) {
+                SRDWindow* window = static_cast<SRDWindow*>(event.data);
+                remove_window(window);
+                delete window;
+            }
+            return;
+        case EventType::KeymapChanged:
+            // Re-resolve key names against the new layout; the table and
+            // the grabs are only rebuilt if some binding actually moved
+            if (key_bindings_.refresh_key_codes()) {
+                compile_key_bindings();
+            }
+            return;
+        case EventType::WindowFullscreen:
+            if (event.data && event.data_size == sizeof(FullscreenEvent)) {
+                const auto* fullscreen = static_cast<const FullscreenEvent*>(event.data);
+                if (fullscreen->fullscreen) {
+                    fullscreen_monitors_[fullscreen->monitor_id] = fullscreen->window_id;
+                } else {
+                    // Only if no other window took the monitor over since;
+                    // the next layout pass picks the monitor up again
+                    auto it = fullscreen_monitors_.find(fullscreen->monitor_id);
+                    if (it != fullscreen_monitors_.end() && it->second == fullscreen->window_id) {
+                        fullscreen_monitors_.erase(it);
+                    }
+                }
+            }
+            return;
+        case EventType::MonitorsChanged:
+            if (platform_) {
+                store_work_areas(platform_->get_work_areas());
+                set_monitors(platform_->get_monitors());
+            }
+            return;
+        case EventType::WorkAreaChanged:
+            if (platform_) {
+                set_work_areas(platform_->get_work_areas());
+            }
+            return;
+        default:
+            break;
+    }
     std::cout << "SRDWindowManager: Handling event type " << static_cast<int>(event.type) << std::endl;
 }
 
 // Workspace management
 void SRDWindowManager::add_workspace(const std::string& name) {
-    Workspace workspace(next_workspace_id_++, name);
-    workspaces_.push_back(workspace);
+    int id = next_workspace_id_++;
+    workspaces_.emplace_back(id, name);
+    index_workspaces();
     
     // If this is the first workspace, make it current
     if (workspaces_.size() == 1) {
-        current_workspace_ = workspace.id;
-        workspace.visible = true;
+        current_workspace_ = id;
     }
+    // A monitor with nothing on it yet takes the new workspace
+    assign_workspaces();
+    sync_platform_workspaces(false);
     
-    std::cout << "SRDWindowManager: Added workspace " << workspace.id << " (" << name << ")" << std::endl;
+    std::cout << "SRDWindowManager: Added workspace " << id << " (" << name << ")" << std::endl;
 }
 
+// The removed workspace's windows go to the workspace that takes its
+// place: a neighbour when it was current, the current one otherwise.
+// Monitors left without a workspace pick another one, and everything that
+// came on or went off screen is shown or hidden in one pass.
 void SRDWindowManager::remove_workspace(int workspace_id) {
     auto it = std::find_if(workspaces_.begin(), workspaces_.end(),
                            [workspace_id](const Workspace& w) { return w.id == workspace_id; });
+    if (it == workspaces_.end()) return;
+    if (workspaces_.size() == 1) {
+        std::cerr << "SRDWindowManager: Cannot remove the last workspace" << std::endl;
+        return;
+    }
     
-    if (it != workspaces_.end()) {
-        // Move windows to current workspace if removing current
-        if (workspace_id == current_workspace_) {
-            for (auto* window : it->windows) {
-                move_window_to_workspace(window, current_workspace_);
-            }
+    const bool was_current = workspace_id == current_workspace_;
+    if (was_current) {
+        current_workspace_ = (it == workspaces_.begin() ? std::next(it) : std::prev(it))->id;
+    }
+    const std::vector<SRDWindow*> orphans = it->windows;
+    const bool orphans_visible = it->visible;
+    const int monitor_id = it->monitor_id;
+    
+    std::unordered_map<int, bool> was_visible;
+    for (const Workspace& workspace : workspaces_) {
+        was_visible[workspace.id] = workspace.visible;
+    }
+    
+    workspaces_.erase(it);
+    index_workspaces();
+    
+    // A hidden workspace becoming current takes over the removed one's
+    // monitor; assign_workspaces() drops the stale monitor assignment
+    Workspace* target = get_workspace(current_workspace_);
+    if (was_current && !target->visible) {
+        target->monitor_id = monitor_id;
+    }
+    assign_workspaces();
+    
+    std::vector<SRDWindow*> hide, show;
+    for (const Workspace& workspace : workspaces_) {
+        if (workspace.visible == was_visible[workspace.id]) continue;
+        std::vector<SRDWindow*>& list = workspace.visible ? show : hide;
+        list.insert(list.end(), workspace.windows.begin(), workspace.windows.end());
+    }
+    if (orphans_visible != target->visible) {
+        std::vector<SRDWindow*>& list = target->visible ? show : hide;
+        list.insert(list.end(), orphans.begin(), orphans.end());
+    }
+    target->windows.insert(target->windows.end(), orphans.begin(), orphans.end());
+    
+    if (layout_engine_) {
+        for (SRDWindow* window : hide) {
+            layout_engine_->remove_window(window);
         }
-        
-        workspaces_.erase(it);
-        std::cout << "SRDWindowManager: Removed workspace " << workspace_id << std::endl;
+        for (SRDWindow* window : show) {
+            layout_engine_->add_window(window);
+        }
+    }
+    sync_platform_workspaces(true); // Indices after it shifted down
+    arrange_monitors();
+    if (platform_ && (!hide.empty() || !show.empty())) {
+        platform_->apply_workspace_switch(hide, show);
     }
+    
+    // Focus stays on screen
+    if (focused_window_ && std::find(hide.begin(), hide.end(), focused_window_) != hide.end()) {
+        focus_window(target->windows.empty() ? nullptr : target->windows.front());
+        if (focused_window_ && platform_) {
+            platform_->focus_window(focused_window_);
+        }
+    }
+    
+    std::cout << "SRDWindowManager: Removed workspace " << workspace_id << std::endl;
 }
 
+// A switch is one transaction: the incoming windows are laid out first,
+// then the platform unmaps the old set and maps the new one at those
+// geometries together, sent with the main loop's flush. A workspace
+// already shown on another monitor only becomes current.
 void SRDWindowManager::switch_to_workspace(int workspace_id) {
     auto* workspace = get_workspace(workspace_id);
-    if (workspace) {
-        // Hide current workspace
+    if (!workspace || workspace_id == current_workspace_) return;
+    
+    std::vector<SRDWindow*> hide;
+    const bool incoming = !workspace->visible;
+    if (incoming) {
+        // It replaces whatever the current workspace's monitor shows
         auto* current = get_workspace(current_workspace_);
-        if (current) {
-            current->visible = false;
+        int monitor_id = current ? current->monitor_id : workspace->monitor_id;
+        auto shown = monitor_workspaces_.find(monitor_id);
+        if (shown != monitor_workspaces_.end()) {
+            if (Workspace* outgoing = get_workspace(shown->second)) {
+                outgoing->visible = false;
+                hide = outgoing->windows;
+            }
         }
-        
-        // Show new workspace
-        current_workspace_ = workspace_id;
+        workspace->monitor_id = monitor_id;
         workspace->visible = true;
+        monitor_workspaces_[monitor_id] = workspace_id;
+    }
+    current_workspace_ = workspace_id;
+    sync_platform_workspaces(false);
+    
+    if (incoming) {
+        // The layout engine only knows the windows on screen
+        if (layout_engine_) {
+            for (SRDWindow* window : hide) {
+                layout_engine_->remove_window(window);
+            }
+            for (SRDWindow* window : workspace->windows) {
+                layout_engine_->add_window(window);
+            }
+        }
+        // Incoming windows are laid out only if the workspace's cached
+        // layout went stale; the switch itself sends their geometry. Other
+        // monitors are untouched, so their stamps stay as they were.
+        if (layout_engine_) {
+            for (const Monitor& monitor : layout_engine_->get_monitors()) {
+                if (monitor.id == workspace->monitor_id) {
+                    arrange_monitor(monitor, false);
+                    break;
+                }
+            }
+        }
         
-        // Arrange windows on the new workspace
-        arrange_workspace_windows(workspace_id);
-        
-        std::cout << "SRDWindowManager: Switched to workspace " << workspace_id << std::endl;
+        if (platform_) {
+            platform_->apply_workspace_switch(hide, workspace->windows);
+        }
     }
+    
+    // Focus follows to the workspace
+    if (std::find(workspace->windows.begin(), workspace->windows.end(), focused_window_) ==
+        workspace->windows.end()) {
+        focus_window(workspace->windows.empty() ? nullptr : workspace->windows.front());
+        if (focused_window_ && platform_) {
+            platform_->focus_window(focused_window_);
+        }
+    }
+    
+    std::cout << "SRDWindowManager: Switched to workspace " << workspace_id << std::endl;
 }
 
 void SRDWindowManager::move_window_to_workspace(SRDWindow* window, int workspace_id) {
@@ -523,9 +1112,11 @@ void SRDWindowManager::move_window_to_workspace(SRDWindow* window, int workspace
     if (!target_workspace) return;
     
     // Remove from current workspace
+    bool was_visible = false;
     for (auto& workspace : workspaces_) {
         auto it = std::find(workspace.windows.begin(), workspace.windows.end(), window);
         if (it != workspace.windows.end()) {
+            was_visible = workspace.visible;
             workspace.windows.erase(it);
             break;
         }
@@ -533,6 +1124,35 @@ void SRDWindowManager::move_window_to_workspace(SRDWindow* window, int workspace
     
     // Add to target workspace
     target_workspace->windows.push_back(window);
+    if (platform_) {
+        platform_->set_window_workspace(window, static_cast<int>(workspace_index_[workspace_id]));
+    }
+    
+    // Crossing between the visible and a hidden workspace is a switch of
+    // one window
+    if (was_visible != target_workspace->visible) {
+        if (layout_engine_) {
+            if (target_workspace->visible) {
+                layout_engine_->add_window(window);
+            } else {
+                layout_engine_->remove_window(window);
+            }
+        }
+        if (target_workspace->visible) {
+            arrange_monitors();
+        }
+        if (platform_) {
+            std::vector<SRDWindow*> moved{window};
+            if (target_workspace->visible) {
+                platform_->apply_workspace_switch({}, moved);
+            } else {
+                platform_->apply_workspace_switch(moved, {});
+            }
+        }
+        if (!target_workspace->visible && focused_window_ == window) {
+            focus_window(nullptr);
+        }
+    }
     
     std::cout << "SRDWindowManager: Moved window " << window->getId() 
               << " to workspace " << workspace_id << std::endl;
@@ -547,40 +1167,131 @@ std::vector<Workspace> SRDWindowManager::get_workspaces() const {
 }
 
 Workspace* SRDWindowManager::get_workspace(int workspace_id) {
-    auto it = std::find_if(workspaces_.begin(), workspaces_.end(),
-                           [workspace_id](const Workspace& w) { return w.id == workspace_id; });
-    return it != workspaces_.end() ? &(*it) : nullptr;
+    auto it = workspace_index_.find(workspace_id);
+    return it != workspace_index_.end() ? &workspaces_[it->second] : nullptr;
 }
 
-// Helper methods
-std::string SRDWindowManager::key_code_to_string(int key_code, int modifiers) const {
-    std::string result;
-    
-    // Add modifiers
-    if (modifiers & 0x01) result += "Ctrl+";  // Control
-    if (modifiers & 0x02) result += "Shift+"; // Shift
-    if (modifiers & 0x04) result += "Alt+";   // Alt
-    if (modifiers & 0x08) result += "Mod4+";  // Super/SRDWindows
-    
-    // Add key
-    if (key_code >= 'A' && key_code <= 'Z') {
-        result += static_cast<char>(key_code);
-    } else if (key_code >= '0' && key_code <= '9') {
-        result += static_cast<char>(key_code);
-    } else {
-        result += "Key" + std::to_string(key_code);
+// Monitors. Also the hotplug path: workspaces of monitors that went away
+// move to the primary one, and everything that changed is laid out and
+// shown or hidden in one pass.
+void SRDWindowManager::set_monitors(const std::vector<Monitor>& monitors) {
+    monitor_index_.build(monitors);
+    for (auto it = fullscreen_monitors_.begin(); it != fullscreen_monitors_.end();) {
+        it = monitor_index_.find(it->first) ? std::next(it) : fullscreen_monitors_.erase(it);
+    }
+    
+    // The layout engine keeps per-monitor layouts, so monitors are
+    // updated in place rather than replaced. Ids are stable across
+    // reconnects, so a returning monitor gets its layout back.
+    if (layout_engine_) {
+        std::vector<Monitor> known = layout_engine_->get_monitors();
+        for (const Monitor& monitor : known) {
+            if (!monitor_index_.find(monitor.id)) {
+                layout_engine_->remove_monitor(monitor.id);
+            }
+        }
+        for (const Monitor& monitor : monitors) {
+            auto it = std::find_if(known.begin(), known.end(),
+                                   [&monitor](const Monitor& m) { return m.id == monitor.id; });
+            if (it == known.end()) {
+                layout_engine_->add_monitor(monitor);
+            } else if (it->x != monitor.x || it->y != monitor.y || it->width != monitor.width ||
+                       it->height != monitor.height || it->scale != monitor.scale) {
+                layout_engine_->update_monitor(monitor);
+            }
+        }
+    }
+    
+    // Show and hide whatever workspaces came on or went off screen
+    std::vector<bool> was_visible;
+    was_visible.reserve(workspaces_.size());
+    for (const Workspace& workspace : workspaces_) {
+        was_visible.push_back(workspace.visible);
     }
+    assign_workspaces();
     
-    return result;
+    std::vector<SRDWindow*> hide, show;
+    for (size_t i = 0; i < workspaces_.size(); ++i) {
+        const Workspace& workspace = workspaces_[i];
+        if (workspace.visible == was_visible[i]) continue;
+        std::vector<SRDWindow*>& list = workspace.visible ? show : hide;
+        list.insert(list.end(), workspace.windows.begin(), workspace.windows.end());
+    }
+    if (layout_engine_) {
+        for (SRDWindow* window : hide) {
+            layout_engine_->remove_window(window);
+        }
+        for (SRDWindow* window : show) {
+            layout_engine_->add_window(window);
+        }
+    }
+    
+    // Floating windows left outside every monitor come back onto their
+    // workspace's monitor
+    for (const Workspace& workspace : workspaces_) {
+        const Monitor* monitor = work_area(workspace.monitor_id);
+        if (!monitor) continue;
+        for (SRDWindow* window : workspace.windows) {
+            if (!floating_windows_.count(window) ||
+                monitor_index_.at(window->getX() + window->getWidth() / 2, window->getY() + window->getHeight() / 2)) {
+                continue;
+            }
+            window->setPosition(
+                std::max(monitor->x, std::min(window->getX(), monitor->x + monitor->width - window->getWidth())),
+                std::max(monitor->y, std::min(window->getY(), monitor->y + monitor->height - window->getHeight())));
+            if (platform_ && workspace.visible) {
+                platform_->apply_window_geometry(window);
+            }
+        }
+    }
+    
+    // Monitors whose geometry or workspace did not change keep their
+    // cached layout; windows staying on screen are sent here, incoming
+    // ones with the switch
+    arrange_monitors();
+    if (platform_ && (!hide.empty() || !show.empty())) {
+        platform_->apply_workspace_switch(hide, show);
+    }
+    
+    std::cout << "SRDWindowManager: " << monitors.size() << " monitors" << std::endl;
+}
+
+const Monitor* SRDWindowManager::monitor_at(int x, int y) const {
+    return monitor_index_.at(x, y);
 }
 
-void SRDWindowManager::execute_key_binding(const std::string& key_combination) {
-    auto it = key_bindings_.find(key_combination);
-    if (it != key_bindings_.end()) {
-        it->second();
+void SRDWindowManager::store_work_areas(const std::vector<Monitor>& areas) {
+    work_areas_.clear();
+    for (const Monitor& area : areas) {
+        work_areas_[area.id] = area;
     }
 }
 
+// The layout cache stamps the area each monitor was tiled in, so monitors
+// whose area is unchanged keep their layout
+void SRDWindowManager::set_work_areas(const std::vector<Monitor>& areas) {
+    store_work_areas(areas);
+    arrange_monitors();
+}
+
+const Monitor* SRDWindowManager::work_area(int monitor_id) const {
+    const Monitor* monitor = monitor_index_.find(monitor_id);
+    if (!monitor) return nullptr;
+    auto it = work_areas_.find(monitor_id);
+    return it != work_areas_.end() ? &it->second : monitor;
+}
+
+Workspace* SRDWindowManager::get_monitor_workspace(int monitor_id) {
+    auto it = monitor_workspaces_.find(monitor_id);
+    return it != monitor_workspaces_.end() ? get_workspace(it->second) : nullptr;
+}
+
+int SRDWindowManager::get_workspace_monitor(int workspace_id) {
+    Workspace* workspace = get_workspace(workspace_id);
+    return workspace && workspace->visible ? workspace->monitor_id : -1;
+}
+
+// Helper methods
 void SRDWindowManager::update_layout_for_window(SRDWindow* window) {
     if (layout_engine_) {
         layout_engine_->update_window(window);
@@ -591,17 +1302,110 @@ void SRDWindowManager::arrange_workspace_windows(int workspace_id) {
     auto* workspace = get_workspace(workspace_id);
     if (!workspace || !layout_engine_) return;
     
-    // Get monitor for current workspace (simplified - assuming single monitor for now)
-    if (!workspace->windows.empty() && !monitors_.empty()) {
-        // Arrange windows using the layout engine
-        // TODO: Get the actual monitor for this workspace
-        layout_engine_->arrange_on_monitor(monitors_[0]);
+    // The layout engine only holds the windows on screen; a hidden
+    // workspace is laid out when it is switched to
+    workspace->layout_cache.clear();
+    if (workspace->visible) {
+        arrange_monitors();
     }
 }
 
-void SRDWindowManager::update_workspace_visibility() {
-    for (auto& workspace : workspaces_) {
-        workspace.visible = (workspace.id == current_workspace_);
+bool SRDWindowManager::is_on_hidden_workspace(int window_id) const {
+    for (const Workspace& workspace : workspaces_) {
+        if (workspace.visible) continue;
+        for (SRDWindow* window : workspace.windows) {
+            if (window->getId() == window_id) return true;
+        }
+    }
+    return false;
+}
+
+void SRDWindowManager::sync_platform_workspaces(bool windows) {
+    if (!platform_) return;
+    
+    std::vector<std::string> names;
+    names.reserve(workspaces_.size());
+    for (const Workspace& workspace : workspaces_) {
+        names.push_back(workspace.name);
+    }
+    auto current = workspace_index_.find(current_workspace_);
+    platform_->set_workspaces(names, current != workspace_index_.end() ? static_cast<int>(current->second) : 0);
+    
+    if (!windows) return;
+    for (size_t i = 0; i < workspaces_.size(); ++i) {
+        for (SRDWindow* window : workspaces_[i].windows) {
+            platform_->set_window_workspace(window, static_cast<int>(i));
+        }
+    }
+}
+
+void SRDWindowManager::index_workspaces() {
+    workspace_index_.clear();
+    for (size_t i = 0; i < workspaces_.size(); ++i) {
+        workspace_index_[workspaces_[i].id] = i;
+    }
+}
+
+// Keeps every monitor showing a workspace and every workspace bound to a
+// monitor that exists. Bookkeeping only; callers hide and show windows.
+void SRDWindowManager::assign_workspaces() {
+    // Without platform monitors everything lives on one implicit monitor
+    const int primary = monitor_index_.empty() ? 0 : monitor_index_.monitors().front().id;
+    auto monitor_exists = [this, primary](int monitor_id) {
+        return monitor_index_.empty() ? monitor_id == primary : monitor_index_.find(monitor_id) != nullptr;
+    };
+    
+    for (Workspace& workspace : workspaces_) {
+        if (!monitor_exists(workspace.monitor_id)) {
+            workspace.monitor_id = primary;
+        }
+    }
+    for (auto it = monitor_workspaces_.begin(); it != monitor_workspaces_.end();) {
+        Workspace* workspace = get_workspace(it->second);
+        if (!monitor_exists(it->first) || !workspace || workspace->monitor_id != it->first) {
+            it = monitor_workspaces_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    auto shown = [this](const Workspace& workspace) {
+        auto it = monitor_workspaces_.find(workspace.monitor_id);
+        return it != monitor_workspaces_.end() && it->second == workspace.id;
+    };
+    
+    // The current workspace stays on screen
+    Workspace* current = get_workspace(current_workspace_);
+    if (current) {
+        monitor_workspaces_[current->monitor_id] = current->id;
+    }
+    
+    // Empty monitors take the first workspace not shown anywhere,
+    // preferring one that was last shown there
+    std::vector<int> monitor_ids;
+    for (const Monitor& monitor : monitor_index_.monitors()) {
+        monitor_ids.push_back(monitor.id);
+    }
+    if (monitor_ids.empty()) {
+        monitor_ids.push_back(primary);
+    }
+    for (int monitor_id : monitor_ids) {
+        if (monitor_workspaces_.count(monitor_id)) continue;
+        Workspace* pick = nullptr;
+        for (Workspace& workspace : workspaces_) {
+            if (shown(workspace)) continue;
+            if (workspace.monitor_id == monitor_id) {
+                pick = &workspace;
+                break;
+            }
+            if (!pick) pick = &workspace;
+        }
+        if (!pick) break;
+        pick->monitor_id = monitor_id;
+        monitor_workspaces_[monitor_id] = pick->id;
+    }
+    
+    for (Workspace& workspace : workspaces_) {
+        workspace.visible = shown(workspace);
     }
 }
 
@@ -622,9 +1426,14 @@ SRDWindow* SRDWindowManager::find_window_at_position(int x, int y) const {
 bool SRDWindowManager::is_in_titlebar_area(SRDWindow* window, int x, int y) const {
     if (!window) return false;
     
-    // Check if point is in the top area of the window (titlebar region)
-    // Titlebar is typically the top 20-30 pixels of the window
-    int titlebar_height = 30;
+    // Check if point is in the top area of the window (titlebar region),
+    // as tall as the titlebar at the scale of the window's monitor
+    int titlebar_height = Metrics().titlebar_height;
+    const Monitor* monitor = monitor_index_.nearest(window->getX() + window->getWidth() / 2,
+                                                    window->getY() + window->getHeight() / 2);
+    if (monitor && layout_engine_) {
+        titlebar_height = layout_engine_->metrics_for(*monitor).titlebar_height;
+    }
     
     return (x >= window->getX() && x < window->getX() + window->getWidth() &&
             y >= window->getY() && y < window->getY() + titlebar_height);
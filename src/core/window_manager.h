@@ -8,15 +8,23 @@
 #include <string>
 #include <functional>
 #include <set> // Required for std::set
+#include <bitset>
+#include <chrono>
+#include <array>
+#include <unordered_map>
 
 #include "../input/input_handler.h"
+#include "../input/key_binding_table.h"
 #include "../layouts/layout_engine.h"
 #include "../platform/platform.h" // For Event type
 #include "../layouts/layout.h" // For Monitor type
+#include "../layouts/layout_cache.h"
+#include "../layouts/monitor_index.h"
 
 class SRDWindow; // Forward declaration
 class InputHandler; // Forward declaration
 class LuaManager; // Forward declaration
+struct SessionSnapshot; // Forward declaration
 
 // Workspace structure
 struct Workspace {
@@ -25,6 +33,8 @@ struct Workspace {
     std::vector<SRDWindow*> windows;
     std::string layout;
     bool visible;
+    int monitor_id = -1; // Monitor it is shown on when visible
+    LayoutCache layout_cache; // Last layout per monitor, kept while hidden
     
     Workspace(int id, const std::string& name = "") 
         : id(id), name(name), layout("tiling"), visible(false) {}
@@ -44,6 +54,13 @@ public:
     SRDWindow* get_focused_window() const;
     std::vector<SRDWindow*> get_windows() const;
     void manage_windows(); // Added missing method
+    void adopt_existing_windows();
+    
+    // In-place restart: snapshot the session, shut the platform down and
+    // exec `executable`, which picks the snapshot up via restore_session()
+    bool restart(const std::string& executable);
+    SessionSnapshot snapshot_session() const;
+    void restore_session(const SessionSnapshot& snapshot);
     void focus_next_window();
     void focus_previous_window();
     
@@ -55,6 +72,8 @@ public:
     void resize_window(SRDWindow* window, int width, int height);
     void toggle_window_floating(SRDWindow* window);
     bool is_window_floating(SRDWindow* window) const;
+    void toggle_window_fullscreen(SRDWindow* window);
+    bool is_window_fullscreen(SRDWindow* window) const;
     
     // Window dragging and resizing
     void start_window_drag(SRDWindow* window, int start_x, int start_y);
@@ -75,6 +94,18 @@ public:
     std::vector<Workspace> get_workspaces() const;
     Workspace* get_workspace(int workspace_id);
     
+    // Monitors. Each one shows its own workspace; a hidden workspace
+    // switched to comes up on the monitor of the current one.
+    void set_monitors(const std::vector<Monitor>& monitors);
+    const Monitor* monitor_at(int x, int y) const;
+    Workspace* get_monitor_workspace(int monitor_id);
+    int get_workspace_monitor(int workspace_id);
+    
+    // What is left of each monitor next to docks and panels. Tiling and
+    // placement use it; only monitors whose area changed are re-tiled.
+    void set_work_areas(const std::vector<Monitor>& areas);
+    const Monitor* work_area(int monitor_id) const; // The monitor itself if no area is known
+    
     // Layout management
     void set_layout(int monitor_id, const std::string& layout_name);
     std::string get_layout(int monitor_id) const;
@@ -83,9 +114,16 @@ public:
     void arrange_windows_dynamic();
 
     // Key binding system
+    // A combination may be a space-separated sequence ("Mod4+w f")
     void bind_key(const std::string& key_combination, std::function<void()> action);
     void unbind_key(const std::string& key_combination);
-    void handle_key_press(int key_code, int modifiers);
+    // Bindings active only while the named mode is entered
+    void bind_mode_key(const std::string& mode, const std::string& key_combination, std::function<void()> action);
+    void enter_key_mode(const std::string& mode);
+    void exit_key_mode();
+    void set_key_sequence_timeout(int milliseconds);
+    void compile_key_bindings(); // Call once bindings are loaded
+    void handle_key_press(int key_code, int modifiers, bool modifier_key = false);
     void handle_key_release(int key_code, int modifiers);
     
     // Input event handling (called by InputHandler)
@@ -106,6 +144,7 @@ private:
     std::vector<SRDWindow*> windows_; // Added missing member variable
     SRDWindow* focused_window_ = nullptr;
     std::set<SRDWindow*> floating_windows_; // Track floating windows
+    std::map<int, int> fullscreen_monitors_; // Monitor id -> fullscreen window id; no layout there
     InputHandler* input_handler_ = nullptr;
     LayoutEngine* layout_engine_ = nullptr;
     LuaManager* lua_manager_ = nullptr;
@@ -115,6 +154,8 @@ private:
     std::vector<Workspace> workspaces_;
     int current_workspace_ = 0;
     int next_workspace_id_ = 1;
+    std::unordered_map<int, size_t> workspace_index_;  // Workspace id -> position in workspaces_
+    std::unordered_map<int, int> monitor_workspaces_;  // Monitor id -> workspace shown there
     
     // Window dragging and resizing state
     SRDWindow* dragging_window_ = nullptr;
@@ -130,21 +171,35 @@ private:
     int resize_edge_ = 0; // 0=none, 1=left, 2=right, 3=top, 4=bottom, 5=corner
 
     // Key binding system
-    std::map<std::string, std::function<void()>> key_bindings_;
-    std::map<int, int> pressed_keys_; // key_code -> modifiers
+    KeyBindingTable key_bindings_;
+    std::bitset<256> pressed_keys_;          // Indexed by key code
+    std::array<uint8_t, 256> pressed_modifiers_{}; // Modifiers at press time
+    std::chrono::milliseconds key_sequence_timeout_{1000};
+    std::chrono::steady_clock::time_point key_sequence_deadline_;
+    bool keyboard_grabbed_ = false; // Held only while a sequence or mode is active
+    std::string pending_key_mode_;  // Entered once the bindings are compiled
+    void sync_keyboard_grab();
+    void expire_key_sequence();
     
     // Platform-specific data (placeholder)
     void* platform_data_ = nullptr;
     
     // Monitor information
-    std::vector<Monitor> monitors_;
+    MonitorIndex monitor_index_;
+    std::unordered_map<int, Monitor> work_areas_; // By monitor id
+    void store_work_areas(const std::vector<Monitor>& areas);
     
     // Helper methods
-    std::string key_code_to_string(int key_code, int modifiers) const;
-    void execute_key_binding(const std::string& key_combination);
     void update_layout_for_window(SRDWindow* window);
+    void arrange_monitors(bool commit = true); // Every monitor not taken over by a fullscreen window
+    void arrange_monitor(const Monitor& monitor, bool commit);
     void arrange_workspace_windows(int workspace_id);
-    void update_workspace_visibility();
+    void index_workspaces();
+    void assign_workspaces();
+    // Workspace list and current workspace, and with windows every
+    // window's workspace, handed to the platform for pagers and bars
+    void sync_platform_workspaces(bool windows);
+    bool is_on_hidden_workspace(int window_id) const;
     
     // Window interaction helpers
     SRDWindow* find_window_at_position(int x, int y) const;
@@ -6,7 +6,9 @@
 // Define basic event structures (these will need more detail later)
 struct KeyboardEvent {
     int key_code;
-    // Add modifiers, state (press/release)
+    int modifiers = 0; // KeyMod bits (see key_binding_table.h)
+    bool modifier_key = false; // The key itself is Shift, Ctrl, ...
+    unsigned int keysym = 0; // Symbol in the active group and level, 0 if unknown
 };
 
 struct MouseEvent {
@@ -0,0 +1,327 @@
+#include "key_binding_table.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+namespace {
+
+struct ModifierName {
+    const char* name;
+    uint32_t bit;
+};
+
+constexpr ModifierName kModifierNames[] = {
+    {"Ctrl", KeyMod::Ctrl},
+    {"Control", KeyMod::Ctrl},
+    {"Shift", KeyMod::Shift},
+    {"Alt", KeyMod::Alt},
+    {"Mod1", KeyMod::Alt},
+    {"Mod4", KeyMod::Super},
+    {"Super", KeyMod::Super},
+};
+
+// Lock combinations a binding must also match
+constexpr uint32_t kLockVariants[] = {0, KeyMod::NumLock, KeyMod::CapsLock, KeyMod::NumLock | KeyMod::CapsLock};
+
+} // namespace
+
+KeyBindingTable::KeyBindingTable()
+    : resolver_(&KeyBindingTable::default_key_codes) {
+}
+
+bool KeyBindingTable::parse(const std::string& combination, uint32_t& modifiers, std::string& key_name) {
+    modifiers = 0;
+    key_name.clear();
+
+    size_t start = 0;
+    while (true) {
+        size_t plus = combination.find('+', start);
+        // A trailing "+" is the plus key itself ("Mod4++")
+        if (plus == std::string::npos || plus + 1 == combination.size()) {
+            key_name = combination.substr(start);
+            break;
+        }
+
+        std::string token = combination.substr(start, plus - start);
+        auto it = std::find_if(std::begin(kModifierNames), std::end(kModifierNames),
+                               [&token](const ModifierName& m) { return token == m.name; });
+        if (it == std::end(kModifierNames)) {
+            return false;
+        }
+        modifiers |= it->bit;
+        start = plus + 1;
+    }
+
+    return !key_name.empty();
+}
+
+std::string KeyBindingTable::normalize(uint32_t modifiers, const std::string& key_name) {
+    std::string result;
+    if (modifiers & KeyMod::Ctrl) result += "Ctrl+";
+    if (modifiers & KeyMod::Shift) result += "Shift+";
+    if (modifiers & KeyMod::Alt) result += "Alt+";
+    if (modifiers & KeyMod::Super) result += "Mod4+";
+    return result + key_name;
+}
+
+std::vector<uint32_t> KeyBindingTable::default_key_codes(const std::string& key_name) {
+    if (key_name.size() == 1) {
+        unsigned char c = static_cast<unsigned char>(key_name[0]);
+        return {static_cast<uint32_t>(std::toupper(c))};
+    }
+    if (key_name.size() > 3 && key_name.compare(0, 3, "Key") == 0 &&
+        std::all_of(key_name.begin() + 3, key_name.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+        return {static_cast<uint32_t>(std::stoul(key_name.substr(3)))};
+    }
+    return {};
+}
+
+void KeyBindingTable::set_resolver(KeyResolver resolver) {
+    resolver_ = resolver ? std::move(resolver) : KeyResolver(&KeyBindingTable::default_key_codes);
+    key_codes_.clear();
+    dirty_ = true;
+}
+
+bool KeyBindingTable::refresh_key_codes() {
+    bool changed = false;
+    for (auto& pair : key_codes_) {
+        std::vector<uint32_t> codes = resolver_(pair.first);
+        if (codes != pair.second) {
+            pair.second = std::move(codes);
+            changed = true;
+        }
+    }
+    if (changed) dirty_ = true;
+    return changed;
+}
+
+bool KeyBindingTable::parse_sequence(const std::string& sequence,
+                                     std::vector<std::pair<uint32_t, std::string>>& steps) {
+    steps.clear();
+    size_t pos = 0;
+    while (pos < sequence.size()) {
+        size_t begin = sequence.find_first_not_of(' ', pos);
+        if (begin == std::string::npos) break;
+        size_t end = sequence.find(' ', begin);
+        if (end == std::string::npos) end = sequence.size();
+
+        uint32_t modifiers;
+        std::string key_name;
+        if (!parse(sequence.substr(begin, end - begin), modifiers, key_name)) {
+            return false;
+        }
+        steps.emplace_back(modifiers, std::move(key_name));
+        pos = end;
+    }
+    return !steps.empty();
+}
+
+namespace {
+
+std::string binding_key(const std::string& mode, const std::vector<std::pair<uint32_t, std::string>>& steps) {
+    std::string result = mode.empty() ? std::string() : mode + ":";
+    for (size_t i = 0; i < steps.size(); ++i) {
+        if (i) result += ' ';
+        result += KeyBindingTable::normalize(steps[i].first, steps[i].second);
+    }
+    return result;
+}
+
+} // namespace
+
+bool KeyBindingTable::bind(const std::string& sequence, Action action, const std::string& mode) {
+    std::vector<std::pair<uint32_t, std::string>> steps;
+    if (!parse_sequence(sequence, steps)) {
+        std::cerr << "KeyBindingTable: Cannot parse key sequence '" << sequence << "'" << std::endl;
+        return false;
+    }
+
+    std::string key = binding_key(mode, steps);
+    bindings_[key] = Binding{mode, std::move(steps), std::move(action)};
+    dirty_ = true;
+    return true;
+}
+
+bool KeyBindingTable::unbind(const std::string& sequence, const std::string& mode) {
+    std::vector<std::pair<uint32_t, std::string>> steps;
+    if (!parse_sequence(sequence, steps)) return false;
+
+    if (bindings_.erase(binding_key(mode, steps)) == 0) return false;
+    dirty_ = true;
+    return true;
+}
+
+void KeyBindingTable::compile() {
+    actions_.clear();
+    grabs_.clear();
+    mode_nodes_.clear();
+    node_ = mode_node_ = 0;
+    mode_.clear();
+
+    // Key names repeat a lot across bindings ("Mod4+1", "Mod4+Shift+1");
+    // each is resolved once and kept until the keymap changes
+    auto codes_for = [this](const std::string& key_name) -> const std::vector<uint32_t>& {
+        auto it = key_codes_.find(key_name);
+        if (it == key_codes_.end()) {
+            it = key_codes_.emplace(key_name, resolver_(key_name)).first;
+        }
+        return it->second;
+    };
+
+    uint32_t next_node = 1;
+    for (const auto& pair : bindings_) {
+        const std::string& mode = pair.second.mode;
+        if (!mode.empty() && mode_nodes_.find(mode) == mode_nodes_.end()) {
+            mode_nodes_[mode] = next_node++;
+        }
+    }
+
+    // (node, key, modifiers) -> target, in insertion order; later entries
+    // win on conflict
+    std::vector<std::pair<uint64_t, uint32_t>> entries;
+    auto add_entries = [&](uint32_t node, uint32_t modifiers, const std::vector<uint32_t>& codes, uint32_t target) {
+        for (uint32_t code : codes) {
+            for (uint32_t locks : kLockVariants) {
+                entries.emplace_back(make_key(node, code, modifiers | locks), target);
+                if (node == 0) {
+                    grabs_.push_back(KeyGrab{code, modifiers | locks});
+                }
+            }
+        }
+    };
+
+    // Escape first so a mode can rebind it
+    const std::vector<uint32_t>& escape = codes_for("Escape");
+    for (const auto& mode : mode_nodes_) {
+        add_entries(mode.second, 0, escape, kExitMode);
+    }
+
+    // Interior trie nodes are shared between sequences with a common prefix
+    std::map<std::pair<uint32_t, std::string>, uint32_t> children;
+    for (const auto& pair : bindings_) {
+        const Binding& binding = pair.second;
+        bool resolved = true;
+        for (const auto& step : binding.steps) {
+            if (codes_for(step.second).empty()) {
+                std::cerr << "KeyBindingTable: No key code for '" << step.second << "' in '" << pair.first << "'"
+                          << std::endl;
+                resolved = false;
+                break;
+            }
+        }
+        if (!resolved) continue;
+
+        uint32_t node = binding.mode.empty() ? 0 : mode_nodes_[binding.mode];
+        for (size_t i = 0; i + 1 < binding.steps.size(); ++i) {
+            const auto& step = binding.steps[i];
+            auto child = children.emplace(std::make_pair(node, normalize(step.first, step.second)), next_node);
+            if (child.second) {
+                add_entries(node, step.first, codes_for(step.second), kNodeBit | next_node);
+                ++next_node;
+            }
+            node = child.first->second;
+        }
+
+        uint32_t index = static_cast<uint32_t>(actions_.size());
+        actions_.push_back(binding.action);
+        add_entries(node, binding.steps.back().first, codes_for(binding.steps.back().second), index);
+    }
+
+    // Load factor at most 1/2 keeps probe chains short
+    size_t capacity = 16;
+    while (capacity < entries.size() * 2) capacity <<= 1;
+    slots_.assign(capacity, Slot{kEmptyKey, 0});
+    slot_mask_ = capacity - 1;
+    for (const auto& entry : entries) {
+        insert(entry.first, entry.second);
+    }
+
+    std::sort(grabs_.begin(), grabs_.end());
+    grabs_.erase(std::unique(grabs_.begin(), grabs_.end()), grabs_.end());
+    dirty_ = false;
+}
+
+const KeyBindingTable::Action* KeyBindingTable::find(uint32_t key_code, uint32_t modifiers) const {
+    uint32_t target;
+    if (!lookup(make_key(0, key_code, modifiers), target) || (target & kNodeBit) || target == kExitMode) {
+        return nullptr;
+    }
+    return &actions_[target];
+}
+
+KeyBindingTable::PressResult KeyBindingTable::press(uint32_t key_code, uint32_t modifiers, const Action*& action) {
+    action = nullptr;
+
+    uint32_t target;
+    if (!lookup(make_key(node_, key_code, modifiers), target)) {
+        node_ = mode_node_;
+        return PressResult::Unbound;
+    }
+    if (target & kNodeBit) {
+        node_ = target & ~kNodeBit;
+        return PressResult::Pending;
+    }
+    if (target == kExitMode) {
+        exit_mode();
+        return PressResult::Handled;
+    }
+
+    // Reset before the action runs; it may enter or leave a mode
+    node_ = mode_node_;
+    action = &actions_[target];
+    return PressResult::Handled;
+}
+
+bool KeyBindingTable::enter_mode(const std::string& mode) {
+    if (mode.empty()) {
+        exit_mode();
+        return true;
+    }
+    auto it = mode_nodes_.find(mode);
+    if (it == mode_nodes_.end()) return false;
+
+    mode_ = mode;
+    node_ = mode_node_ = it->second;
+    return true;
+}
+
+void KeyBindingTable::exit_mode() {
+    mode_.clear();
+    node_ = mode_node_ = 0;
+}
+
+bool KeyBindingTable::lookup(uint64_t key, uint32_t& target) const {
+    if (slots_.empty()) return false;
+
+    for (size_t i = hash(key) & slot_mask_;; i = (i + 1) & slot_mask_) {
+        const Slot& slot = slots_[i];
+        if (slot.key == key) {
+            target = slot.target;
+            return true;
+        }
+        if (slot.key == kEmptyKey) return false;
+    }
+}
+
+size_t KeyBindingTable::hash(uint64_t key) {
+    // splitmix64 finalizer
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return static_cast<size_t>(key);
+}
+
+void KeyBindingTable::insert(uint64_t key, uint32_t target) {
+    for (size_t i = hash(key) & slot_mask_;; i = (i + 1) & slot_mask_) {
+        Slot& slot = slots_[i];
+        if (slot.key == kEmptyKey || slot.key == key) {
+            // Two names resolving to the same key, or a sequence prefix
+            // that is also a binding: the later entry wins
+            slot.key = key;
+            slot.target = target;
+            return;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#ifndef SRDWM_KEY_BINDING_TABLE_H
+#define SRDWM_KEY_BINDING_TABLE_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Platform-neutral modifier bits carried by key events and bindings.
+// Backends translate their native modifier state to and from these.
+namespace KeyMod {
+    constexpr uint32_t Ctrl = 0x01;
+    constexpr uint32_t Shift = 0x02;
+    constexpr uint32_t Alt = 0x04;
+    constexpr uint32_t Super = 0x08;
+    constexpr uint32_t NumLock = 0x10;
+    constexpr uint32_t CapsLock = 0x20;
+    constexpr uint32_t Locks = NumLock | CapsLock;
+    constexpr uint32_t All = 0x3f;
+}
+
+// One passive key grab the platform should register
+struct KeyGrab {
+    uint32_t key_code;
+    uint32_t modifiers;
+    bool operator<(const KeyGrab& other) const {
+        return key_code != other.key_code ? key_code < other.key_code : modifiers < other.modifiers;
+    }
+    bool operator==(const KeyGrab& other) const {
+        return key_code == other.key_code && modifiers == other.modifiers;
+    }
+};
+
+// Maps a key name from a binding ("q", "Return", "XF86AudioMute") to the
+// key codes that produce it
+using KeyResolver = std::function<std::vector<uint32_t>(const std::string& key_name)>;
+
+// Key bindings compiled into a flat open-addressing table.
+//
+// bind()/unbind() only edit the binding list; compile() resolves key names
+// to key codes and fills the table with one entry per (key code, modifier
+// mask), including every NumLock/CapsLock variant, so a key press is a
+// single hash probe on the raw modifier state with no allocation. The
+// passive grabs are generated from the same entries.
+//
+// A binding may be a sequence of combinations separated by spaces
+// ("Mod4+w f"), and may belong to a named mode. Sequences and modes are
+// compiled into a trie whose nodes are part of the table key, so each key
+// of a sequence is still one probe: (node, key code, modifiers) yields
+// either the next node or an action. Only keys leaving the root node are
+// grabbed passively; while press() reports a sequence in progress or a
+// mode is active the caller is expected to hold an active keyboard grab
+// (wants_keyboard()). Escape leaves a mode unless the mode binds it.
+class KeyBindingTable {
+public:
+    using Action = std::function<void()>;
+
+    enum class PressResult {
+        Unbound, // No binding; a pending sequence was abandoned
+        Pending, // Prefix of a longer sequence, waiting for the next key
+        Handled  // Completed a binding (action is set) or left a mode
+    };
+
+    KeyBindingTable();
+
+    // "Mod4+Shift+q" -> (Super|Shift, "q"); false if malformed
+    static bool parse(const std::string& combination, uint32_t& modifiers, std::string& key_name);
+    static std::string normalize(uint32_t modifiers, const std::string& key_name);
+
+    // Space-separated combinations, normalized as "Mod4+w f"
+    static bool parse_sequence(const std::string& sequence, std::vector<std::pair<uint32_t, std::string>>& steps);
+
+    // Key codes used when no platform resolver is set: ASCII letters (as
+    // upper case), digits and punctuation, and "KeyN" for raw code N
+    static std::vector<uint32_t> default_key_codes(const std::string& key_name);
+
+    void set_resolver(KeyResolver resolver);
+
+    // Re-run the resolver for every key name in use after a keymap change;
+    // returns true (and marks the table dirty) only if a name now maps to
+    // different key codes
+    bool refresh_key_codes();
+
+    // An empty mode is the default (root) mode
+    bool bind(const std::string& sequence, Action action, const std::string& mode = std::string());
+    bool unbind(const std::string& sequence, const std::string& mode = std::string());
+    bool dirty() const { return dirty_; }
+
+    // Rebuilds the trie; any pending sequence or active mode is reset
+    void compile();
+
+    // Single-step lookup from the root, ignoring sequence state
+    const Action* find(uint32_t key_code, uint32_t modifiers) const;
+    const std::vector<KeyGrab>& grabs() const { return grabs_; }
+
+    // Advance the sequence state machine by one key press
+    PressResult press(uint32_t key_code, uint32_t modifiers, const Action*& action);
+
+    bool enter_mode(const std::string& mode); // False if the mode has no bindings
+    void exit_mode();
+    void cancel_sequence() { node_ = mode_node_; } // Back to the mode's root
+    bool sequence_pending() const { return node_ != mode_node_; }
+    bool in_mode() const { return mode_node_ != 0; }
+    const std::string& mode() const { return mode_; }
+    bool wants_keyboard() const { return node_ != 0; }
+
+private:
+    struct Binding {
+        std::string mode;
+        std::vector<std::pair<uint32_t, std::string>> steps; // (modifiers, key name)
+        Action action;
+    };
+
+    // Slot::target is an index into actions_, a trie node with kNodeBit
+    // set, or kExitMode
+    struct Slot {
+        uint64_t key;
+        uint32_t target;
+    };
+
+    static constexpr uint64_t kEmptyKey = ~uint64_t{0};
+    static constexpr uint32_t kNodeBit = 0x80000000u;
+    static constexpr uint32_t kExitMode = 0x7fffffffu;
+
+    // Node in the top 24 bits, key code and modifiers below
+    static uint64_t make_key(uint32_t node, uint32_t key_code, uint32_t modifiers) {
+        return (static_cast<uint64_t>(node) << 40) | (static_cast<uint64_t>(key_code) << 8) |
+               (modifiers & KeyMod::All);
+    }
+    static size_t hash(uint64_t key);
+    void insert(uint64_t key, uint32_t target);
+    bool lookup(uint64_t key, uint32_t& target) const;
+
+    KeyResolver resolver_;
+    std::map<std::string, Binding> bindings_; // By mode and normalized sequence
+    std::map<std::string, std::vector<uint32_t>> key_codes_; // Resolved key names
+    bool dirty_ = false;
+
+    // Compiled state
+    std::vector<Action> actions_; // Indexed by Slot::target
+    std::vector<Slot> slots_;
+    size_t slot_mask_ = 0;
+    std::vector<KeyGrab> grabs_;
+    std::map<std::string, uint32_t> mode_nodes_; // Root node of each mode
+
+    // Sequence state; node 0 is the root of the default mode
+    uint32_t node_ = 0;
+    uint32_t mode_node_ = 0;
+    std::string mode_;
+};
+
+#endif // SRDWM_KEY_BINDING_TABLE_H
@@ -12,6 +12,7 @@ struct Monitor {
     int height;
     std::string name;
     int refresh_rate;
+    float scale = 1.0f; // Device pixels per logical pixel
     
     Monitor() : id(0), x(0), y(0), width(0), height(0), refresh_rate(60) {}
     Monitor(int id, int x, int y, int width, int height, const std::string& name = "", int refresh = 60)
@@ -0,0 +1,35 @@
+#include "layout_cache.h"
+#include "../core/window.h"
+
+bool LayoutCache::Stamp::operator==(const Stamp& other) const {
+    return generation == other.generation && monitor_x == other.monitor_x && monitor_y == other.monitor_y &&
+           monitor_width == other.monitor_width && monitor_height == other.monitor_height &&
+           monitor_scale == other.monitor_scale &&
+           windows == other.windows;
+}
+
+LayoutCache::Stamp LayoutCache::stamp(const std::vector<SRDWindow*>& windows, const Monitor& monitor,
+                                      uint64_t generation) {
+    Stamp stamp;
+    stamp.windows.reserve(windows.size());
+    for (const SRDWindow* window : windows) {
+        stamp.windows.push_back({window->getId(), window->getX(), window->getY(), window->getWidth(),
+                                 window->getHeight()});
+    }
+    stamp.monitor_x = monitor.x;
+    stamp.monitor_y = monitor.y;
+    stamp.monitor_width = monitor.width;
+    stamp.monitor_height = monitor.height;
+    stamp.monitor_scale = monitor.scale;
+    stamp.generation = generation;
+    return stamp;
+}
+
+bool LayoutCache::valid(int monitor_id, const Stamp& stamp) const {
+    auto it = stamps_.find(monitor_id);
+    return it != stamps_.end() && it->second == stamp;
+}
+
+void LayoutCache::store(int monitor_id, Stamp stamp) {
+    stamps_[monitor_id] = std::move(stamp);
+}
@@ -0,0 +1,53 @@
+#ifndef SRDWM_LAYOUT_CACHE_H
+#define SRDWM_LAYOUT_CACHE_H
+
+#include "layout.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class SRDWindow;
+
+// The last layout committed on each monitor of a workspace, stamped with
+// what it was computed from: the windows (in layout order) with the
+// geometry the layout gave them, the monitor's geometry and scale, and
+// the layout engine's configuration generation.
+//
+// A layout pass can be skipped for a monitor whose current stamp matches
+// the stored one. Nothing the layout depends on has changed since, and
+// the windows still sit where it put them, so running it again would
+// only reproduce the same geometry. A workspace keeps its cache while it
+// is hidden, so switching back to it costs nothing unless something
+// changed in between.
+class LayoutCache {
+public:
+    struct Stamp {
+        struct Entry {
+            int id;
+            int x, y, width, height;
+            bool operator==(const Entry& other) const {
+                return id == other.id && x == other.x && y == other.y && width == other.width &&
+                       height == other.height;
+            }
+        };
+        std::vector<Entry> windows;
+        int monitor_x = 0, monitor_y = 0, monitor_width = 0, monitor_height = 0;
+        float monitor_scale = 1.0f;
+        uint64_t generation = 0;
+
+        bool operator==(const Stamp& other) const;
+        bool operator!=(const Stamp& other) const { return !(*this == other); }
+    };
+
+    static Stamp stamp(const std::vector<SRDWindow*>& windows, const Monitor& monitor, uint64_t generation);
+
+    bool valid(int monitor_id, const Stamp& stamp) const;
+    void store(int monitor_id, Stamp stamp);
+    void invalidate(int monitor_id) { stamps_.erase(monitor_id); }
+    void clear() { stamps_.clear(); }
+
+private:
+    std::map<int, Stamp> stamps_; // By monitor id
+};
+
+#endif // SRDWM_LAYOUT_CACHE_H
@@ -13,6 +13,7 @@ LayoutEngine::~LayoutEngine() {
 // Layout management
 bool LayoutEngine::set_layout(int monitor_id, LayoutType layout_type) {
     active_layouts_[monitor_id] = layout_type;
+    generation_++;
     std::cout << "LayoutEngine: Set layout " << layout_type_to_string(layout_type) 
               << " for monitor " << monitor_id << std::endl;
     return true;
@@ -42,6 +43,7 @@ std::string LayoutEngine::get_layout_name(int monitor_id) const {
 // Layout configuration
 bool LayoutEngine::configure_layout(const std::string& layout_name, const std::map<std::string, std::string>& config) {
     layout_configs_[layout_name] = config;
+    generation_++;
     std::cout << "LayoutEngine: Configured layout '" << layout_name << "' with " 
               << config.size() << " parameters" << std::endl;
     return true;
@@ -49,6 +51,7 @@ bool LayoutEngine::configure_layout(const std::string& layout_name, const std::m
 
 bool LayoutEngine::register_custom_layout(const std::string& name, std::function<void(const std::vector<SRDWindow*>&, const Monitor&)> layout_func) {
     custom_layouts_[name] = layout_func;
+    generation_++;
     std::cout << "LayoutEngine: Registered custom layout '" << name << "'" << std::endl;
     return true;
 }
@@ -82,8 +85,9 @@ void LayoutEngine::add_monitor(const Monitor& monitor) {
                           [&](const Monitor& m) { return m.id == monitor.id; });
     if (it == monitors_.end()) {
         monitors_.push_back(monitor);
-        // Set default layout for new monitor
-        active_layouts_[monitor.id] = LayoutType::DYNAMIC;
+        // Set default layout for a new monitor; one that is reconnected
+        // keeps the layout it had
+        active_layouts_.emplace(monitor.id, LayoutType::DYNAMIC);
         std::cout << "LayoutEngine: Added monitor " << monitor.id << std::endl;
     }
 }
@@ -93,7 +97,6 @@ void LayoutEngine::remove_monitor(int monitor_id) {
                           [monitor_id](const Monitor& m) { return m.id == monitor_id; });
     if (it != monitors_.end()) {
         monitors_.erase(it);
-        active_layouts_.erase(monitor_id);
         std::cout << "LayoutEngine: Removed monitor " << monitor_id << std::endl;
     }
 }
@@ -107,23 +110,52 @@ void LayoutEngine::update_monitor(const Monitor& monitor) {
     }
 }
 
+void LayoutEngine::set_metrics(const Metrics& metrics) {
+    metrics_.set_base(metrics);
+    generation_++;
+}
+
 // Arrangement
 void LayoutEngine::arrange_on_monitor(const Monitor& monitor) {
+    arrange_on_monitor(monitor, get_windows_on_monitor(monitor.id));
+}
+
+// The windows of the workspace shown on the monitor, wherever they are now
+void LayoutEngine::arrange_on_monitor(const Monitor& monitor, const std::vector<SRDWindow*>& windows_on_monitor) {
     if (active_layouts_.count(monitor.id)) {
         LayoutType current_layout_type = active_layouts_[monitor.id];
-        std::vector<SRDWindow*> windows_on_monitor = get_windows_on_monitor(monitor.id);
         
         std::cout << "LayoutEngine: Arranging " << windows_on_monitor.size() 
                   << " windows on monitor " << monitor.id 
                   << " with layout " << layout_type_to_string(current_layout_type) << std::endl;
 
-        if (current_layout_type == LayoutType::TILING) {
-            tiling_layout_.arrange_windows(windows_on_monitor, monitor);
-        } else if (current_layout_type == LayoutType::DYNAMIC) {
-            dynamic_layout_.arrange_windows(windows_on_monitor, monitor);
-        } else if (current_layout_type == LayoutType::FLOATING) {
+        if (current_layout_type == LayoutType::FLOATING) {
             // Floating layout - windows keep their current positions
             std::cout << "LayoutEngine: Floating layout - no arrangement needed" << std::endl;
+            return;
+        }
+        
+        // Half the gap inside the monitor edge and half around each
+        // window leaves a full gap everywhere, at the monitor's scale
+        const int half_gap = metrics_for(monitor).gap / 2;
+        Monitor area = monitor;
+        area.x += half_gap;
+        area.y += half_gap;
+        area.width = std::max(1, area.width - 2 * half_gap);
+        area.height = std::max(1, area.height - 2 * half_gap);
+        
+        if (current_layout_type == LayoutType::TILING) {
+            tiling_layout_.arrange_windows(windows_on_monitor, area);
+        } else if (current_layout_type == LayoutType::DYNAMIC) {
+            dynamic_layout_.arrange_windows(windows_on_monitor, area);
+        }
+        
+        if (half_gap > 0) {
+            for (SRDWindow* window : windows_on_monitor) {
+                window->setGeometry(window->getX() + half_gap, window->getY() + half_gap,
+                                    std::max(1, window->getWidth() - 2 * half_gap),
+                                    std::max(1, window->getHeight() - 2 * half_gap));
+            }
         }
     }
 }
@@ -4,10 +4,12 @@
 #include "layout.h"
 #include "tiling_layout.h"
 #include "dynamic_layout.h"
+#include "scaled_metrics.h"
 #include <vector>
 #include <map>
 #include <string>
 #include <functional>
+#include <cstdint>
 
 class SRDWindow; // Forward declaration to avoid circular dependency
 
@@ -45,11 +47,24 @@ public:
     
     // Arrangement
     void arrange_on_monitor(const Monitor& monitor);
+    void arrange_on_monitor(const Monitor& monitor, const std::vector<SRDWindow*>& windows);
     void arrange_all_monitors();
     
     // Utility
     std::vector<std::string> get_available_layouts() const;
     std::vector<SRDWindow*> get_windows_on_monitor(int monitor_id) const;
+    const std::vector<Monitor>& get_monitors() const { return monitors_; }
+    
+    // Gaps and borders in logical pixels; layouts on a monitor use them
+    // at its scale
+    void set_metrics(const Metrics& metrics);
+    const Metrics& metrics_for(const Monitor& monitor) { return metrics_.at(monitor.scale); }
+    
+    // Bumped by every change to layouts or their configuration; cached
+    // arrangements from an older generation are stale. Monitor geometry
+    // is part of each cached arrangement, so monitor changes only
+    // invalidate the monitors they touch.
+    uint64_t generation() const { return generation_; }
 
 private:
     // Member variables for layout state
@@ -60,6 +75,8 @@ private:
     std::map<int, LayoutType> active_layouts_; // Map monitor ID to active layout type
     std::map<std::string, std::function<void(const std::vector<SRDWindow*>&, const Monitor&)>> custom_layouts_;
     std::map<std::string, std::map<std::string, std::string>> layout_configs_;
+    uint64_t generation_ = 0;
+    ScaledMetrics metrics_;
     
     // Helper methods
     LayoutType string_to_layout_type(const std::string& name) const;
@@ -0,0 +1,75 @@
+#include "monitor_index.h"
+#include <algorithm>
+#include <climits>
+
+void MonitorIndex::build(const std::vector<Monitor>& monitors) {
+    monitors_ = monitors;
+    by_id_.clear();
+    edges_.clear();
+    slabs_.clear();
+
+    for (size_t i = 0; i < monitors_.size(); ++i) {
+        by_id_[monitors_[i].id] = i;
+        if (monitors_[i].width <= 0 || monitors_[i].height <= 0) continue;
+        edges_.push_back(monitors_[i].x);
+        edges_.push_back(monitors_[i].x + monitors_[i].width);
+    }
+    std::sort(edges_.begin(), edges_.end());
+    edges_.erase(std::unique(edges_.begin(), edges_.end()), edges_.end());
+    if (edges_.size() < 2) return;
+
+    slabs_.resize(edges_.size() - 1);
+    for (size_t s = 0; s < slabs_.size(); ++s) {
+        for (size_t i = 0; i < monitors_.size(); ++i) {
+            const Monitor& m = monitors_[i];
+            if (m.width > 0 && m.height > 0 && m.x <= edges_[s] && edges_[s] < m.x + m.width) {
+                slabs_[s].push_back(i);
+            }
+        }
+        std::sort(slabs_[s].begin(), slabs_[s].end(),
+                  [this](size_t a, size_t b) { return monitors_[a].y < monitors_[b].y; });
+    }
+}
+
+const Monitor* MonitorIndex::find(int id) const {
+    auto it = by_id_.find(id);
+    return it != by_id_.end() ? &monitors_[it->second] : nullptr;
+}
+
+const Monitor* MonitorIndex::at(int x, int y) const {
+    if (edges_.size() < 2 || x < edges_.front() || x >= edges_.back()) return nullptr;
+
+    size_t s = static_cast<size_t>(std::upper_bound(edges_.begin(), edges_.end(), x) - edges_.begin()) - 1;
+    const std::vector<size_t>& slab = slabs_[s];
+
+    // Last monitor starting at or above y; overlapping (cloned) outputs
+    // fall back to a scan of the slab
+    auto it = std::upper_bound(slab.begin(), slab.end(), y,
+                               [this](int value, size_t i) { return value < monitors_[i].y; });
+    if (it != slab.begin()) {
+        const Monitor& m = monitors_[*(it - 1)];
+        if (y < m.y + m.height) return &m;
+    }
+    for (size_t i : slab) {
+        const Monitor& m = monitors_[i];
+        if (y >= m.y && y < m.y + m.height) return &m;
+    }
+    return nullptr;
+}
+
+const Monitor* MonitorIndex::nearest(int x, int y) const {
+    if (const Monitor* m = at(x, y)) return m;
+
+    const Monitor* best = nullptr;
+    long long best_distance = LLONG_MAX;
+    for (const Monitor& m : monitors_) {
+        long long dx = x < m.x ? m.x - x : (x >= m.x + m.width ? x - (m.x + m.width - 1) : 0);
+        long long dy = y < m.y ? m.y - y : (y >= m.y + m.height ? y - (m.y + m.height - 1) : 0);
+        long long distance = dx * dx + dy * dy;
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = &m;
+        }
+    }
+    return best;
+}
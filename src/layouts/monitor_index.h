@@ -0,0 +1,35 @@
+#ifndef SRDWM_MONITOR_INDEX_H
+#define SRDWM_MONITOR_INDEX_H
+
+#include "layout.h"
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// Monitor lookup by id and by point.
+//
+// The x edges of all monitors split the screen into vertical slabs; each
+// slab keeps the monitors crossing it sorted by y. A point is found with
+// one binary search over the edges and one within its slab, which stays
+// cheap however the outputs are arranged (side by side, stacked, or a mix
+// of resolutions with gaps in between). Rebuilt whenever the monitor set
+// changes.
+class MonitorIndex {
+public:
+    void build(const std::vector<Monitor>& monitors);
+
+    const Monitor* find(int id) const;
+    const Monitor* at(int x, int y) const;      // nullptr between or outside monitors
+    const Monitor* nearest(int x, int y) const; // The containing one, else the closest
+
+    const std::vector<Monitor>& monitors() const { return monitors_; }
+    bool empty() const { return monitors_.empty(); }
+
+private:
+    std::vector<Monitor> monitors_;
+    std::unordered_map<int, size_t> by_id_;
+    std::vector<int> edges_;                 // Sorted, unique
+    std::vector<std::vector<size_t>> slabs_; // slabs_[i] spans [edges_[i], edges_[i + 1])
+};
+
+#endif // SRDWM_MONITOR_INDEX_H
@@ -0,0 +1,31 @@
+#include "scaled_metrics.h"
+#include <algorithm>
+#include <cmath>
+
+int ScaledMetrics::bucket(float scale) {
+    if (!(scale > 0.0f)) return kBucketsPerUnit; // NaN or nonsense: 1x
+    int bucket = static_cast<int>(std::lround(scale * kBucketsPerUnit));
+    return std::max(kBucketsPerUnit / 2, std::min(bucket, 4 * kBucketsPerUnit));
+}
+
+void ScaledMetrics::set_base(const Metrics& base) {
+    base_ = base;
+    scaled_.clear();
+}
+
+const Metrics& ScaledMetrics::at_bucket(int bucket) {
+    auto it = scaled_.find(bucket);
+    if (it != scaled_.end()) return it->second;
+
+    // A size that is set never rounds away to nothing
+    auto scale = [bucket](int value) {
+        if (value <= 0) return value;
+        return std::max(1, static_cast<int>(std::lround(static_cast<double>(value) * bucket / kBucketsPerUnit)));
+    };
+    Metrics metrics;
+    metrics.titlebar_height = scale(base_.titlebar_height);
+    metrics.text_padding = scale(base_.text_padding);
+    metrics.border_width = scale(base_.border_width);
+    metrics.gap = scale(base_.gap);
+    return scaled_.emplace(bucket, metrics).first->second;
+}
@@ -0,0 +1,38 @@
+#ifndef SRDWM_SCALED_METRICS_H
+#define SRDWM_SCALED_METRICS_H
+
+#include <map>
+
+// Decoration and layout sizes, in logical pixels as configured or in
+// device pixels for one monitor scale
+struct Metrics {
+    int titlebar_height = 30;
+    int text_padding = 10;
+    int border_width = 2;
+    int gap = 0;
+};
+
+// Metrics per monitor scale. Scales are snapped to quarter steps
+// (buckets), so the handful of scales in use each compute their metrics
+// once, and everything keyed by bucket (fonts, rendered titlebars) is
+// shared by all monitors with that scale.
+class ScaledMetrics {
+public:
+    static constexpr int kBucketsPerUnit = 4;
+
+    static int bucket(float scale); // Clamped to 0.5x - 4x
+    static float bucket_scale(int bucket) { return static_cast<float>(bucket) / kBucketsPerUnit; }
+
+    // Changing the base drops every scaled copy
+    void set_base(const Metrics& base);
+    const Metrics& base() const { return base_; }
+
+    const Metrics& at(float scale) { return at_bucket(bucket(scale)); }
+    const Metrics& at_bucket(int bucket);
+
+private:
+    Metrics base_;
+    std::map<int, Metrics> scaled_; // By bucket
+};
+
+#endif // SRDWM_SCALED_METRICS_H
@@ -0,0 +1,204 @@
+#include "work_area.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Range of a _NET_WM_STRUT, which covers its edge from end to end
+constexpr int kWholeEdge = std::numeric_limits<int>::max() / 2;
+
+int clamp_value(uint32_t value) {
+    return static_cast<int>(std::min<uint32_t>(value, kWholeEdge));
+}
+
+} // namespace
+
+bool WorkAreaTracker::Strut::operator==(const Strut& other) const {
+    return left == other.left && right == other.right && top == other.top && bottom == other.bottom &&
+           left_start_y == other.left_start_y && left_end_y == other.left_end_y &&
+           right_start_y == other.right_start_y && right_end_y == other.right_end_y &&
+           top_start_x == other.top_start_x && top_end_x == other.top_end_x &&
+           bottom_start_x == other.bottom_start_x && bottom_end_x == other.bottom_end_x;
+}
+
+WorkAreaTracker::Strut WorkAreaTracker::Strut::from_properties(const std::vector<uint32_t>& partial,
+                                                               const std::vector<uint32_t>& full) {
+    Strut strut;
+    if (partial.size() >= 12) {
+        strut.left = clamp_value(partial[0]);
+        strut.right = clamp_value(partial[1]);
+        strut.top = clamp_value(partial[2]);
+        strut.bottom = clamp_value(partial[3]);
+        strut.left_start_y = clamp_value(partial[4]);
+        strut.left_end_y = clamp_value(partial[5]);
+        strut.right_start_y = clamp_value(partial[6]);
+        strut.right_end_y = clamp_value(partial[7]);
+        strut.top_start_x = clamp_value(partial[8]);
+        strut.top_end_x = clamp_value(partial[9]);
+        strut.bottom_start_x = clamp_value(partial[10]);
+        strut.bottom_end_x = clamp_value(partial[11]);
+    } else if (full.size() >= 4) {
+        strut.left = clamp_value(full[0]);
+        strut.right = clamp_value(full[1]);
+        strut.top = clamp_value(full[2]);
+        strut.bottom = clamp_value(full[3]);
+        strut.left_end_y = strut.right_end_y = kWholeEdge;
+        strut.top_end_x = strut.bottom_end_x = kWholeEdge;
+    }
+    return strut;
+}
+
+bool WorkAreaTracker::Rect::intersects(const Monitor& monitor) const {
+    return !empty() && x < monitor.x + monitor.width && monitor.x < x + width &&
+           y < monitor.y + monitor.height && monitor.y < y + height;
+}
+
+void WorkAreaTracker::set_monitors(const std::vector<Monitor>& monitors) {
+    monitors_ = monitors;
+    areas_ = monitors;
+    screen_width_ = screen_height_ = 0;
+    for (const Monitor& m : monitors_) {
+        screen_width_ = std::max(screen_width_, m.x + m.width);
+        screen_height_ = std::max(screen_height_, m.y + m.height);
+    }
+
+    dirty_.clear();
+    for (size_t i = 0; i < monitors_.size(); ++i) dirty_.insert(i);
+    reset_ = true;
+}
+
+void WorkAreaTracker::set_strut(Id dock, const Strut& strut) {
+    if (strut.empty()) {
+        remove(dock);
+        return;
+    }
+    auto it = struts_.find(dock);
+    if (it != struts_.end()) {
+        if (it->second == strut) return;
+        mark(it->second);
+        it->second = strut;
+    } else {
+        struts_.emplace(dock, strut);
+    }
+    mark(strut);
+}
+
+void WorkAreaTracker::remove(Id dock) {
+    auto it = struts_.find(dock);
+    if (it == struts_.end()) return;
+    mark(it->second);
+    struts_.erase(it);
+}
+
+std::vector<int> WorkAreaTracker::update() {
+    std::vector<int> changed;
+    for (size_t i : dirty_) {
+        Monitor area = compute(monitors_[i]);
+        Monitor& current = areas_[i];
+        if (reset_ || area.x != current.x || area.y != current.y || area.width != current.width ||
+            area.height != current.height) {
+            changed.push_back(area.id);
+        }
+        current = area;
+    }
+    dirty_.clear();
+    reset_ = false;
+    return changed;
+}
+
+const Monitor* WorkAreaTracker::area(int monitor_id) const {
+    for (const Monitor& m : areas_) {
+        if (m.id == monitor_id) return &m;
+    }
+    return nullptr;
+}
+
+std::vector<uint32_t> WorkAreaTracker::net_workarea(size_t desktops) const {
+    std::vector<uint32_t> values;
+    if (areas_.empty()) return values;
+
+    int left = areas_.front().x, top = areas_.front().y;
+    int right = left + areas_.front().width, bottom = top + areas_.front().height;
+    for (const Monitor& area : areas_) {
+        left = std::min(left, area.x);
+        top = std::min(top, area.y);
+        right = std::max(right, area.x + area.width);
+        bottom = std::max(bottom, area.y + area.height);
+    }
+
+    desktops = std::max<size_t>(1, desktops);
+    values.reserve(desktops * 4);
+    for (size_t i = 0; i < desktops; ++i) {
+        values.push_back(static_cast<uint32_t>(left));
+        values.push_back(static_cast<uint32_t>(top));
+        values.push_back(static_cast<uint32_t>(right - left));
+        values.push_back(static_cast<uint32_t>(bottom - top));
+    }
+    return values;
+}
+
+std::vector<std::pair<WorkAreaTracker::Edge, WorkAreaTracker::Rect>> WorkAreaTracker::reserved(
+    const Strut& strut) const {
+    // Partial ranges are inclusive; an inverted range reserves nothing
+    auto span = [](int start, int end) { return end >= start ? end - start + 1 : 0; };
+
+    std::vector<std::pair<Edge, Rect>> rects;
+    if (strut.left > 0) {
+        rects.push_back({Left, {0, strut.left_start_y, strut.left, span(strut.left_start_y, strut.left_end_y)}});
+    }
+    if (strut.right > 0) {
+        rects.push_back({Right, {screen_width_ - strut.right, strut.right_start_y, strut.right,
+                                 span(strut.right_start_y, strut.right_end_y)}});
+    }
+    if (strut.top > 0) {
+        rects.push_back({Top, {strut.top_start_x, 0, span(strut.top_start_x, strut.top_end_x), strut.top}});
+    }
+    if (strut.bottom > 0) {
+        rects.push_back({Bottom, {strut.bottom_start_x, screen_height_ - strut.bottom,
+                                  span(strut.bottom_start_x, strut.bottom_end_x), strut.bottom}});
+    }
+    return rects;
+}
+
+void WorkAreaTracker::mark(const Strut& strut) {
+    for (const auto& entry : reserved(strut)) {
+        for (size_t i = 0; i < monitors_.size(); ++i) {
+            if (entry.second.intersects(monitors_[i])) dirty_.insert(i);
+        }
+    }
+}
+
+Monitor WorkAreaTracker::compute(const Monitor& monitor) const {
+    int left = monitor.x, top = monitor.y;
+    int right = monitor.x + monitor.width, bottom = monitor.y + monitor.height;
+
+    for (const auto& pair : struts_) {
+        for (const auto& entry : reserved(pair.second)) {
+            const Rect& rect = entry.second;
+            if (!rect.intersects(monitor)) continue;
+            switch (entry.first) {
+                case Left: left = std::max(left, rect.x + rect.width); break;
+                case Right: right = std::min(right, rect.x); break;
+                case Top: top = std::max(top, rect.y + rect.height); break;
+                case Bottom: bottom = std::min(bottom, rect.y); break;
+            }
+        }
+    }
+
+    // Struts that would swallow the monitor whole are ignored on that axis
+    if (right <= left) {
+        left = monitor.x;
+        right = monitor.x + monitor.width;
+    }
+    if (bottom <= top) {
+        top = monitor.y;
+        bottom = monitor.y + monitor.height;
+    }
+
+    Monitor area = monitor;
+    area.x = left;
+    area.y = top;
+    area.width = right - left;
+    area.height = bottom - top;
+    return area;
+}
@@ -0,0 +1,87 @@
+#ifndef SRDWM_WORK_AREA_H
+#define SRDWM_WORK_AREA_H
+
+#include "layout.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// The usable area of each monitor: the monitor minus what docks reserve
+// along the screen edges with _NET_WM_STRUT(_PARTIAL).
+//
+// Struts are measured from the edges of the whole screen (the bounding
+// box of all monitors, anchored at the root origin), and a partial strut
+// only covers its start..end range along that edge. A panel at the top of
+// the lower of two stacked monitors therefore reserves nothing on the
+// upper one, and a bar on one of two side-by-side monitors leaves the
+// other alone.
+//
+// Docks come and go one at a time. Each change marks only the monitors
+// its old and new reservations touch; update() recomputes those and
+// reports the ones whose area actually changed.
+class WorkAreaTracker {
+public:
+    using Id = uint64_t;
+
+    // Widths along each edge plus the range of the edge they cover
+    // (inclusive, in root coordinates), as in _NET_WM_STRUT_PARTIAL
+    struct Strut {
+        int left = 0, right = 0, top = 0, bottom = 0;
+        int left_start_y = 0, left_end_y = 0;
+        int right_start_y = 0, right_end_y = 0;
+        int top_start_x = 0, top_end_x = 0;
+        int bottom_start_x = 0, bottom_end_x = 0;
+
+        bool empty() const { return left <= 0 && right <= 0 && top <= 0 && bottom <= 0; }
+        bool operator==(const Strut& other) const;
+        bool operator!=(const Strut& other) const { return !(*this == other); }
+
+        // From a _NET_WM_STRUT_PARTIAL value, else a _NET_WM_STRUT one
+        // (which spans its whole edge); empty if neither is well formed
+        static Strut from_properties(const std::vector<uint32_t>& partial, const std::vector<uint32_t>& full);
+    };
+
+    // Resets the areas to the monitors themselves, minus the struts
+    // already known; every monitor counts as changed
+    void set_monitors(const std::vector<Monitor>& monitors);
+
+    // An empty strut is the same as remove()
+    void set_strut(Id dock, const Strut& strut);
+    void remove(Id dock);
+
+    // Ids of the monitors whose area changed since the last update()
+    std::vector<int> update();
+
+    const Monitor* area(int monitor_id) const; // nullptr for an unknown monitor
+    const std::vector<Monitor>& areas() const { return areas_; } // In monitor order
+    bool empty() const { return areas_.empty(); }
+    
+    // The _NET_WORKAREA value: x, y, width, height for each of desktops
+    // (at least one), all the bounding box of the monitor areas since the
+    // property has no notion of monitors. Empty without monitors.
+    std::vector<uint32_t> net_workarea(size_t desktops) const;
+
+private:
+    struct Rect {
+        int x = 0, y = 0, width = 0, height = 0;
+        bool empty() const { return width <= 0 || height <= 0; }
+        bool intersects(const Monitor& monitor) const;
+    };
+    enum Edge { Left, Right, Top, Bottom };
+
+    std::vector<std::pair<Edge, Rect>> reserved(const Strut& strut) const;
+    void mark(const Strut& strut);
+    Monitor compute(const Monitor& monitor) const;
+
+    std::vector<Monitor> monitors_;
+    std::vector<Monitor> areas_;
+    std::map<Id, Strut> struts_;
+    std::set<size_t> dirty_; // Indices into monitors_
+    bool reset_ = false;     // Monitors replaced: report them all
+    int screen_width_ = 0, screen_height_ = 0;
+};
+
+#endif // SRDWM_WORK_AREA_H
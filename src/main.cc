@@ -14,8 +14,20 @@
 // Include platform factory
 #include "platform/platform_factory.h"
 
+// Session snapshot handed over by an in-place restart
+#include "core/session_snapshot.h"
+
 int main(int argc, char* argv[]) {
     std::cout << "SRDWM starting up..." << std::endl;
+    
+    // "--restore <path>" is passed by an in-place restart
+    std::string restore_path;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--restore") {
+            restore_path = argv[i + 1];
+        }
+    }
+    std::string executable = argc > 0 ? argv[0] : "srdwm";
 
     // Print platform information
     PlatformFactory::print_platform_info();
@@ -47,6 +59,7 @@ int main(int argc, char* argv[]) {
     // Connect components
     window_manager->set_layout_engine(layout_engine.get());
     window_manager->set_lua_manager(g_lua_manager.get());
+    g_lua_manager->set_window_manager(window_manager.get());
     std::cout << "Components connected to window manager" << std::endl;
 
     // Initialize default workspaces
@@ -78,6 +91,12 @@ int main(int argc, char* argv[]) {
     std::cout << "Animations: " << (g_lua_manager->get_bool("general.animations", true) ? "enabled" : "disabled") << std::endl;
     std::cout << "Animation Duration: " << g_lua_manager->get_int("general.animation_duration", 200) << " ms" << std::endl;
 
+    // Gaps and borders in logical pixels, scaled per monitor
+    Metrics metrics;
+    metrics.gap = g_lua_manager->get_int("general.window_gap", 8);
+    metrics.border_width = g_lua_manager->get_int("general.border_width", 2);
+    layout_engine->set_metrics(metrics);
+
     // Platform initialization
     std::cout << "\nInitializing platform..." << std::endl;
     
@@ -98,6 +117,13 @@ int main(int argc, char* argv[]) {
     
     std::cout << "Platform initialized successfully" << std::endl;
     
+    // Requests are flushed once per main loop iteration unless debugging
+    platform->set_immediate_flush(g_lua_manager->get_bool("debug.immediate_flush", false));
+    platform->set_window_cache_size(g_lua_manager->get_int("performance.window_cache_size", 100));
+    platform->set_frameless_decorations(g_lua_manager->get_string("general.decoration_mode", "frame") == "frameless");
+    platform->enable_compositor(g_lua_manager->get_bool("general.compositor", false));
+    platform->set_auto_scale(g_lua_manager->get_bool("monitor.auto_scale", false));
+    
     // Connect platform to window manager
     window_manager->set_platform(platform.get());
     
@@ -168,6 +194,13 @@ int main(int argc, char* argv[]) {
         }
     });
     
+    window_manager->bind_key("Mod4+Shift+f", [&]() {
+        auto* focused = window_manager->get_focused_window();
+        if (focused) {
+            window_manager->toggle_window_fullscreen(focused);
+        }
+    });
+    
     // Window movement with arrow keys
     window_manager->bind_key("Mod4+Shift+Left", [&]() { 
         auto* focused = window_manager->get_focused_window();
@@ -262,20 +295,79 @@ int main(int argc, char* argv[]) {
         window_manager->arrange_windows();
     });
     
+    // Resize mode: Mod4+r, then h/j/k/l repeatedly, Escape or Return to leave
+    window_manager->bind_key("Mod4+r", [&]() {
+        window_manager->enter_key_mode("resize");
+    });
+    window_manager->bind_mode_key("resize", "h", [&]() {
+        auto* focused = window_manager->get_focused_window();
+        if (focused && focused->getWidth() - 50 >= 100) {
+            window_manager->resize_window(focused, focused->getWidth() - 50, focused->getHeight());
+        }
+    });
+    window_manager->bind_mode_key("resize", "l", [&]() {
+        auto* focused = window_manager->get_focused_window();
+        if (focused) window_manager->resize_window(focused, focused->getWidth() + 50, focused->getHeight());
+    });
+    window_manager->bind_mode_key("resize", "k", [&]() {
+        auto* focused = window_manager->get_focused_window();
+        if (focused && focused->getHeight() - 50 >= 100) {
+            window_manager->resize_window(focused, focused->getWidth(), focused->getHeight() - 50);
+        }
+    });
+    window_manager->bind_mode_key("resize", "j", [&]() {
+        auto* focused = window_manager->get_focused_window();
+        if (focused) window_manager->resize_window(focused, focused->getWidth(), focused->getHeight() + 50);
+    });
+    window_manager->bind_mode_key("resize", "Escape", [&]() {
+        window_manager->exit_key_mode();
+    });
+    window_manager->bind_mode_key("resize", "Return", [&]() {
+        window_manager->exit_key_mode();
+    });
+    
+    // Chord: Mod4+w followed by a layout key
+    window_manager->bind_key("Mod4+w t", [&]() {
+        layout_engine->set_layout(0, "tiling");
+        window_manager->arrange_windows();
+    });
+    window_manager->bind_key("Mod4+w d", [&]() {
+        layout_engine->set_layout(0, "dynamic");
+        window_manager->arrange_windows();
+    });
+    
     // Exit
+    // Restart in place, keeping workspaces, floating state and focus
+    window_manager->bind_key("Mod4+Shift+r", [&]() {
+        window_manager->restart(executable);
+    });
+    
     window_manager->bind_key("Mod4+Shift+q", [&]() { 
         std::cout << "Exit key combination pressed" << std::endl;
         // TODO: Implement proper cleanup and exit
     });
     
+    // Bindings from the config replace the defaults above
+    g_lua_manager->apply_key_bindings();
+    
+    // Build the binding table and register the passive grabs in one go
+    window_manager->set_key_sequence_timeout(g_lua_manager->get_int("general.key_sequence_timeout", 1000));
+    window_manager->compile_key_bindings();
     std::cout << "Key bindings configured" << std::endl;
     
     // Set initial layout
     std::string default_layout = g_lua_manager->get_string("general.default_layout", "tiling");
     layout_engine->set_layout(0, default_layout);
     
-    // Arrange initial windows
-    window_manager->arrange_windows();
+    // Manage windows left over from a previous session. After an in-place
+    // restart the snapshot says where they belong; otherwise adopt them and
+    // arrange everything in a single pass.
+    SessionSnapshot snapshot;
+    if (!restore_path.empty() && SessionSnapshot::read(restore_path, snapshot)) {
+        window_manager->restore_session(snapshot);
+    } else {
+        window_manager->adopt_existing_windows();
+    }
     
     std::cout << "\nSRDWM initialization complete!" << std::endl;
     std::cout << "\nAvailable Key Bindings:" << std::endl;
@@ -286,13 +378,17 @@ int main(int argc, char* argv[]) {
     std::cout << "  Mod4+Tab          - Focus next window" << std::endl;
     std::cout << "  Mod4+Shift+Tab    - Focus previous window" << std::endl;
     std::cout << "  Mod4+f            - Toggle window floating" << std::endl;
+    std::cout << "  Mod4+Shift+f      - Toggle fullscreen" << std::endl;
     std::cout << "  Mod4+q            - Close focused window" << std::endl;
     std::cout << "  Mod4+m            - Maximize focused window" << std::endl;
     std::cout << "  Mod4+space        - Minimize focused window" << std::endl;
     std::cout << "  Mod4+Shift+Arrows - Move focused window" << std::endl;
     std::cout << "  Mod4+Ctrl+Arrows  - Resize focused window" << std::endl;
+    std::cout << "  Mod4+r, h/j/k/l   - Resize mode (Escape/Return to leave)" << std::endl;
+    std::cout << "  Mod4+w, t/d       - Tiling/dynamic layout" << std::endl;
     std::cout << "  Mod4+Return       - Launch terminal" << std::endl;
     std::cout << "  Mod4+d            - Launch application launcher" << std::endl;
+    std::cout << "  Mod4+Shift+r      - Restart SRDWM in place" << std::endl;
     std::cout << "  Mod4+Shift+q      - Exit SRDWM" << std::endl;
     std::cout << "\nMouse Controls:" << std::endl;
     std::cout << "  Left click + drag on titlebar - Move window" << std::endl;
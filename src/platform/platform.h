@@ -12,10 +12,13 @@ class SRDWindow;
 // Include Monitor struct definition from layouts
 #include "../layouts/layout.h"
 
+// Key grabs and platform-neutral modifier bits
+#include "../input/key_binding_table.h"
+
 // Platform-independent event types
 enum class EventType {
-    WindowCreated,
-    WindowDestroyed,
+    WindowCreated,   // data is the new SRDWindow; the window manager takes it over
+    WindowDestroyed, // data is the SRDWindow, which the window manager then deletes
     WindowMoved,
     WindowResized,
     WindowFocused,
@@ -26,7 +29,11 @@ enum class EventType {
     MouseButtonRelease,
     MouseMotion,
     MonitorAdded,
-    MonitorRemoved
+    MonitorRemoved,
+    KeymapChanged, // Key names may resolve to different key codes now
+    WindowFullscreen, // A window entered or left fullscreen (FullscreenEvent)
+    MonitorsChanged, // Monitors were added, removed or resized; get_monitors() has the new set
+    WorkAreaChanged // Dock struts changed; get_work_areas() has the new areas
 };
 
 // Event structure
@@ -36,6 +43,14 @@ struct Event {
     size_t data_size;
 };
 
+// Payload of EventType::WindowFullscreen. While a monitor has a
+// fullscreen window the window manager leaves its layout alone.
+struct FullscreenEvent {
+    int window_id;
+    int monitor_id;
+    bool fullscreen;
+};
+
 // Platform abstraction interface
 class Platform {
 public:
@@ -49,6 +64,19 @@ public:
     virtual bool poll_events(std::vector<Event>& events) = 0;
     virtual void process_event(const Event& event) = 0;
     
+    // Request batching. Backends may buffer requests until flush(), which
+    // the main loop calls once at the end of every iteration. Immediate
+    // mode flushes after each request instead (useful when debugging).
+    virtual void flush() {}
+    virtual void set_immediate_flush(bool enabled) { (void)enabled; }
+    
+    // Upper bound on entries kept by per-window caches (rendered text, etc.)
+    virtual void set_window_cache_size(int entries) { (void)entries; }
+    
+    // Take over windows that already exist (WM started or restarted on a
+    // running session). Returns the newly managed windows.
+    virtual std::vector<SRDWindow*> adopt_existing_windows() { return {}; }
+    
     // Window management
     virtual std::unique_ptr<SRDWindow> create_window(const std::string& title, int x, int y, int width, int height) = 0;
     virtual void destroy_window(SRDWindow* window) = 0;
@@ -66,9 +94,57 @@ public:
     virtual void set_window_border_width(SRDWindow* window, int width) = 0;
     virtual bool get_window_decorations(SRDWindow* window) const = 0;
     
+    // Frameless mode decorates windows in place (native borders, optional
+    // titlebar) instead of reparenting them into frames. Backends that
+    // always draw decorations themselves can ignore both hooks.
+    virtual void set_frameless_decorations(bool enabled) { (void)enabled; }
+    virtual void set_window_floating(SRDWindow* window, bool floating) { (void)window; (void)floating; }
+    
+    // Cover the window's monitor with it, or put it back. Clients can also
+    // ask for this themselves; either way a WindowFullscreen event follows.
+    virtual void set_window_fullscreen(SRDWindow* window, bool fullscreen) { (void)window; (void)fullscreen; }
+    
+    // Switch workspaces as one transaction: hide and show take effect
+    // together, each shown window at its current geometry, with nothing
+    // drawn in between. Sent by the next flush().
+    virtual void apply_workspace_switch(const std::vector<SRDWindow*>& hide, const std::vector<SRDWindow*>& show) {
+        (void)hide;
+        (void)show;
+    }
+    
+    // Workspaces as pagers and bars see them: names in order and the
+    // index of the current one. A window's workspace is an index into
+    // the same list. Backends publish these; nothing else depends on it.
+    virtual void set_workspaces(const std::vector<std::string>& names, int current) {
+        (void)names;
+        (void)current;
+    }
+    virtual void set_window_workspace(SRDWindow* window, int index) {
+        (void)window;
+        (void)index;
+    }
+    
+    // Move and resize the window to its current geometry. Backends may
+    // skip windows whose geometry did not change since the last call.
+    virtual void apply_window_geometry(SRDWindow* window) {
+        set_window_position(window, window->getX(), window->getY());
+        set_window_size(window, window->getWidth(), window->getHeight());
+    }
+    
+    // Built-in compositing for backends that can do it themselves; a
+    // no-op where the display server always composites
+    virtual void enable_compositor(bool enabled) { (void)enabled; }
+    
+    // Guess a 2x scale for high-density monitors that have no scale set
+    // explicitly. Off unless the config asks for it.
+    virtual void set_auto_scale(bool enabled) { (void)enabled; }
+    
     // Monitor management
     virtual std::vector<Monitor> get_monitors() = 0;
     virtual Monitor get_primary_monitor() = 0;
+    // Each monitor minus the space reserved by docks and panels, in the
+    // same order as get_monitors()
+    virtual std::vector<Monitor> get_work_areas() { return get_monitors(); }
     
     // Input handling
     virtual void grab_keyboard() = 0;
@@ -76,6 +152,14 @@ public:
     virtual void grab_pointer() = 0;
     virtual void ungrab_pointer() = 0;
     
+    // Key bindings. Key events carry backend key codes; key_codes_for()
+    // maps a binding's key name ("q", "Return") onto them, and grab_keys()
+    // replaces the set of passive grabs with the compiled one.
+    virtual std::vector<uint32_t> key_codes_for(const std::string& key_name) {
+        return KeyBindingTable::default_key_codes(key_name);
+    }
+    virtual void grab_keys(const std::vector<KeyGrab>& grabs) { (void)grabs; }
+    
     // Utility
     virtual std::string get_platform_name() const = 0;
     virtual bool is_wayland() const = 0;
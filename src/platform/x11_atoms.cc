@@ -0,0 +1,32 @@
+#include "x11_atoms.h"
+#include "x11_xcb.h"
+#include <cstring>
+
+namespace {
+
+const char* const kAtomNames[X11AtomTable::kCount] = {
+#define SRDWM_X11_ATOM_NAME(id, name) name,
+    SRDWM_X11_ATOM_LIST(SRDWM_X11_ATOM_NAME)
+#undef SRDWM_X11_ATOM_NAME
+};
+
+} // namespace
+
+bool X11AtomTable::intern_all(xcb_connection_t* conn) {
+    std::array<xcb_intern_atom_cookie_t, kCount> cookies;
+    for (size_t i = 0; i < kCount; ++i) {
+        cookies[i] = xcb_intern_atom(conn, 0, static_cast<uint16_t>(std::strlen(kAtomNames[i])), kAtomNames[i]);
+    }
+
+    bool complete = true;
+    for (size_t i = 0; i < kCount; ++i) {
+        auto reply = xcb_take(xcb_intern_atom_reply(conn, cookies[i], nullptr));
+        atoms_[i] = reply ? reply->atom : xcb_atom_t{XCB_ATOM_NONE};
+        complete = complete && reply;
+    }
+    return complete;
+}
+
+const char* X11AtomTable::name(X11Atom atom) {
+    return kAtomNames[static_cast<size_t>(atom)];
+}
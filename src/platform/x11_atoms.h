@@ -0,0 +1,86 @@
+#ifndef SRDWM_X11_ATOMS_H
+#define SRDWM_X11_ATOMS_H
+
+#include <array>
+#include <cstddef>
+
+#include <xcb/xcb.h>
+
+// Every atom the X11 backend uses: ICCCM, EWMH and our private hints.
+// Adding an atom here is all it takes to have it interned at startup.
+#define SRDWM_X11_ATOM_LIST(X)                                              \
+    /* ICCCM */                                                             \
+    X(WM_PROTOCOLS, "WM_PROTOCOLS")                                         \
+    X(WM_DELETE_WINDOW, "WM_DELETE_WINDOW")                                 \
+    X(WM_TAKE_FOCUS, "WM_TAKE_FOCUS")                                       \
+    X(WM_STATE, "WM_STATE")                                                 \
+    X(WM_CHANGE_STATE, "WM_CHANGE_STATE")                                   \
+    X(UTF8_STRING, "UTF8_STRING")                                           \
+    /* EWMH root properties */                                              \
+    X(NET_SUPPORTED, "_NET_SUPPORTED")                                      \
+    X(NET_SUPPORTING_WM_CHECK, "_NET_SUPPORTING_WM_CHECK")                  \
+    X(NET_CLIENT_LIST, "_NET_CLIENT_LIST")                                  \
+    X(NET_CLIENT_LIST_STACKING, "_NET_CLIENT_LIST_STACKING")                \
+    X(NET_ACTIVE_WINDOW, "_NET_ACTIVE_WINDOW")                              \
+    X(NET_NUMBER_OF_DESKTOPS, "_NET_NUMBER_OF_DESKTOPS")                    \
+    X(NET_CURRENT_DESKTOP, "_NET_CURRENT_DESKTOP")                          \
+    X(NET_DESKTOP_NAMES, "_NET_DESKTOP_NAMES")                              \
+    X(NET_WORKAREA, "_NET_WORKAREA")                                        \
+    X(NET_CLOSE_WINDOW, "_NET_CLOSE_WINDOW")                                \
+    /* EWMH client properties */                                            \
+    X(NET_WM_NAME, "_NET_WM_NAME")                                          \
+    X(NET_WM_DESKTOP, "_NET_WM_DESKTOP")                                    \
+    X(NET_WM_PID, "_NET_WM_PID")                                            \
+    X(NET_WM_STRUT, "_NET_WM_STRUT")                                        \
+    X(NET_WM_STRUT_PARTIAL, "_NET_WM_STRUT_PARTIAL")                        \
+    X(NET_WM_WINDOW_OPACITY, "_NET_WM_WINDOW_OPACITY")                      \
+    X(NET_WM_STATE, "_NET_WM_STATE")                                        \
+    X(NET_WM_STATE_MAXIMIZED_VERT, "_NET_WM_STATE_MAXIMIZED_VERT")          \
+    X(NET_WM_STATE_MAXIMIZED_HORZ, "_NET_WM_STATE_MAXIMIZED_HORZ")          \
+    X(NET_WM_STATE_FULLSCREEN, "_NET_WM_STATE_FULLSCREEN")                  \
+    X(NET_WM_STATE_ABOVE, "_NET_WM_STATE_ABOVE")                            \
+    X(NET_WM_STATE_BELOW, "_NET_WM_STATE_BELOW")                            \
+    X(NET_WM_STATE_HIDDEN, "_NET_WM_STATE_HIDDEN")                          \
+    X(NET_WM_WINDOW_TYPE, "_NET_WM_WINDOW_TYPE")                            \
+    X(NET_WM_WINDOW_TYPE_DESKTOP, "_NET_WM_WINDOW_TYPE_DESKTOP")            \
+    X(NET_WM_WINDOW_TYPE_DOCK, "_NET_WM_WINDOW_TYPE_DOCK")                  \
+    X(NET_WM_WINDOW_TYPE_TOOLBAR, "_NET_WM_WINDOW_TYPE_TOOLBAR")            \
+    X(NET_WM_WINDOW_TYPE_MENU, "_NET_WM_WINDOW_TYPE_MENU")                  \
+    X(NET_WM_WINDOW_TYPE_UTILITY, "_NET_WM_WINDOW_TYPE_UTILITY")            \
+    X(NET_WM_WINDOW_TYPE_SPLASH, "_NET_WM_WINDOW_TYPE_SPLASH")              \
+    X(NET_WM_WINDOW_TYPE_DIALOG, "_NET_WM_WINDOW_TYPE_DIALOG")              \
+    X(NET_WM_WINDOW_TYPE_DROPDOWN_MENU, "_NET_WM_WINDOW_TYPE_DROPDOWN_MENU")\
+    X(NET_WM_WINDOW_TYPE_POPUP_MENU, "_NET_WM_WINDOW_TYPE_POPUP_MENU")      \
+    X(NET_WM_WINDOW_TYPE_TOOLTIP, "_NET_WM_WINDOW_TYPE_TOOLTIP")            \
+    X(NET_WM_WINDOW_TYPE_NOTIFICATION, "_NET_WM_WINDOW_TYPE_NOTIFICATION")  \
+    X(NET_WM_WINDOW_TYPE_COMBO, "_NET_WM_WINDOW_TYPE_COMBO")                \
+    X(NET_WM_WINDOW_TYPE_DND, "_NET_WM_WINDOW_TYPE_DND")                    \
+    X(NET_WM_WINDOW_TYPE_NORMAL, "_NET_WM_WINDOW_TYPE_NORMAL")              \
+    /* Compositor hints we publish ourselves */                             \
+    X(NET_WM_WINDOW_BLUR, "_NET_WM_WINDOW_BLUR")                            \
+    X(NET_WM_WINDOW_SHADOW, "_NET_WM_WINDOW_SHADOW")
+
+enum class X11Atom {
+#define SRDWM_X11_ATOM_ENUM(id, name) id,
+    SRDWM_X11_ATOM_LIST(SRDWM_X11_ATOM_ENUM)
+#undef SRDWM_X11_ATOM_ENUM
+    Count
+};
+
+// Atom values resolved once at startup, indexed by X11Atom afterwards
+class X11AtomTable {
+public:
+    static constexpr size_t kCount = static_cast<size_t>(X11Atom::Count);
+
+    // Sends every InternAtom request before waiting on the first reply.
+    // Returns false if any atom could not be resolved.
+    bool intern_all(xcb_connection_t* conn);
+
+    xcb_atom_t operator[](X11Atom atom) const { return atoms_[static_cast<size_t>(atom)]; }
+    static const char* name(X11Atom atom);
+
+private:
+    std::array<xcb_atom_t, kCount> atoms_{};
+};
+
+#endif // SRDWM_X11_ATOMS_H
@@ -0,0 +1,636 @@
+#include "x11_compositor.h"
+#include "x11_xcb.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <X11/Xlib-xcb.h>
+#include <X11/extensions/shape.h>
+
+namespace {
+
+Picture create_solid(Display* display, Window root, int depth, XRenderPictFormat* format,
+                     unsigned short red, unsigned short green, unsigned short blue, unsigned short alpha) {
+    Pixmap pixmap = XCreatePixmap(display, root, 1, 1, static_cast<unsigned int>(depth));
+    XRenderPictureAttributes attributes;
+    attributes.repeat = True;
+    Picture picture = XRenderCreatePicture(display, pixmap, format, CPRepeat, &attributes);
+    XRenderColor color{red, green, blue, alpha};
+    XRenderFillRectangle(display, PictOpSrc, picture, &color, 0, 0, 1, 1);
+    XFreePixmap(display, pixmap); // The picture keeps it alive
+    return picture;
+}
+
+} // namespace
+
+X11Compositor::~X11Compositor() {
+    shutdown();
+}
+
+bool X11Compositor::initialize(Display* display, Window root) {
+    if (display_) return true;
+
+    int event_base, error_base;
+    int major = 0, minor = 4;
+    if (!XCompositeQueryExtension(display, &event_base, &error_base) ||
+        !XCompositeQueryVersion(display, &major, &minor) || (major == 0 && minor < 3)) {
+        std::cerr << "X11Compositor: Composite 0.3 not available" << std::endl;
+        return false;
+    }
+    int damage_event_base;
+    if (!XDamageQueryExtension(display, &damage_event_base, &error_base)) {
+        std::cerr << "X11Compositor: Damage extension not available" << std::endl;
+        return false;
+    }
+    if (!XFixesQueryExtension(display, &event_base, &error_base) ||
+        !XRenderQueryExtension(display, &event_base, &error_base)) {
+        std::cerr << "X11Compositor: XFixes or Render extension not available" << std::endl;
+        return false;
+    }
+
+    int screen = DefaultScreen(display);
+    std::string selection_name = "_NET_WM_CM_S" + std::to_string(screen);
+    Atom selection = XInternAtom(display, selection_name.c_str(), False);
+    if (XGetSelectionOwner(display, selection) != None) {
+        std::cerr << "X11Compositor: Another compositing manager is running" << std::endl;
+        return false;
+    }
+
+    display_ = display;
+    conn_ = XGetXCBConnection(display);
+    root_ = root;
+    screen_ = screen;
+    damage_event_base_ = damage_event_base;
+    screen_width_ = DisplayWidth(display_, screen_);
+    screen_height_ = DisplayHeight(display_, screen_);
+
+    selection_window_ = XCreateSimpleWindow(display_, root_, -1, -1, 1, 1, 0, 0, 0);
+    XSetSelectionOwner(display_, selection, selection_window_, CurrentTime);
+
+    // Everything is painted into the overlay, which must not take input
+    overlay_ = XCompositeGetOverlayWindow(display_, root_);
+    XserverRegion empty = XFixesCreateRegion(display_, nullptr, 0);
+    XFixesSetWindowShapeRegion(display_, overlay_, ShapeInput, 0, 0, empty);
+    XFixesDestroyRegion(display_, empty);
+
+    XRenderPictFormat* screen_format = XRenderFindVisualFormat(display_, DefaultVisual(display_, screen_));
+    XRenderPictureAttributes attributes;
+    attributes.subwindow_mode = IncludeInferiors;
+    overlay_picture_ = XRenderCreatePicture(display_, overlay_, screen_format, CPSubwindowMode, &attributes);
+
+    XRenderPictFormat* argb = XRenderFindStandardFormat(display_, PictStandardARGB32);
+    background_ = create_solid(display_, root_, 32, argb, 0x2e2e, 0x3434, 0x4040, 0xffff);
+    black_ = create_solid(display_, root_, 32, argb, 0, 0, 0, 0xffff);
+    shadows_.initialize(display_, root_);
+    shadow_extent_ = X11ShadowCache::extent(kShadowRadius);
+
+    // Redirect and take the initial window list atomically, so nothing
+    // is created or restacked in between
+    XGrabServer(display_);
+    XCompositeRedirectSubwindows(display_, root_, CompositeRedirectManual);
+
+    XcbReply<xcb_query_tree_reply_t> tree =
+        xcb_take(xcb_query_tree_reply(conn_, xcb_query_tree(conn_, root_), nullptr));
+    if (tree) {
+        const xcb_window_t* children = xcb_query_tree_children(tree.get());
+        int count = xcb_query_tree_children_length(tree.get());
+
+        // One round trip for all geometries; the attribute requests
+        // add_window() issues are collected in the next one
+        std::vector<xcb_get_geometry_cookie_t> geometry(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            geometry[static_cast<size_t>(i)] = xcb_get_geometry(conn_, children[i]);
+        }
+        for (int i = 0; i < count; ++i) {
+            XcbReply<xcb_get_geometry_reply_t> g =
+                xcb_take(xcb_get_geometry_reply(conn_, geometry[static_cast<size_t>(i)], nullptr));
+            if (!g) continue;
+            add_window(children[i], g->x, g->y, g->width, g->height, g->border_width, false,
+                       stack_.empty() ? None : stack_.back());
+        }
+    }
+    XUngrabServer(display_);
+
+    // Map state comes with the attributes
+    resolve_attributes();
+    damage_screen();
+
+    std::cout << "X11Compositor: Compositing " << clients_.size() << " windows" << std::endl;
+    return true;
+}
+
+void X11Compositor::shutdown() {
+    if (!display_) return;
+
+    for (const PendingWindow& pending : pending_) {
+        xcb_discard_reply(conn_, pending.attributes.sequence);
+        if (pending.need_geometry) {
+            xcb_discard_reply(conn_, pending.geometry.sequence);
+        }
+    }
+    pending_.clear();
+
+    for (auto& pair : clients_) {
+        release_picture(pair.second);
+        if (pair.second.damage) {
+            XDamageDestroy(display_, pair.second.damage);
+        }
+    }
+    clients_.clear();
+    stack_.clear();
+    fullscreen_.clear();
+
+    for (auto& pair : opacity_masks_) {
+        XRenderFreePicture(display_, pair.second);
+    }
+    opacity_masks_.clear();
+
+    if (damage_) XFixesDestroyRegion(display_, damage_);
+    if (back_picture_) XRenderFreePicture(display_, back_picture_);
+    if (back_pixmap_) XFreePixmap(display_, back_pixmap_);
+    shadows_.clear();
+    XRenderFreePicture(display_, background_);
+    XRenderFreePicture(display_, black_);
+    XRenderFreePicture(display_, overlay_picture_);
+    damage_ = 0;
+    back_picture_ = 0;
+    back_pixmap_ = 0;
+
+    if (!bypassed_) {
+        XCompositeUnredirectSubwindows(display_, root_, CompositeRedirectManual);
+    }
+    bypassed_ = false;
+    XCompositeReleaseOverlayWindow(display_, root_);
+    XDestroyWindow(display_, selection_window_);
+
+    display_ = nullptr;
+    conn_ = nullptr;
+    std::cout << "X11Compositor: Stopped" << std::endl;
+}
+
+bool X11Compositor::handle_event(const XEvent& event) {
+    if (!display_) return false;
+
+    switch (event.type) {
+        case CreateNotify:
+            if (event.xcreatewindow.parent == root_) {
+                const XCreateWindowEvent& e = event.xcreatewindow;
+                add_window(e.window, e.x, e.y, e.width, e.height, e.border_width, false,
+                           stack_.empty() ? None : stack_.back());
+            }
+            return false;
+        case DestroyNotify:
+            remove_window(event.xdestroywindow.window, true);
+            fullscreen_.erase(event.xdestroywindow.window);
+            return false;
+        case ReparentNotify:
+            if (event.xreparent.parent == root_) {
+                if (add_window(event.xreparent.window, event.xreparent.x, event.xreparent.y, 0, 0, 0, false,
+                               stack_.empty() ? None : stack_.back())) {
+                    pending_.back().geometry = xcb_get_geometry(conn_, event.xreparent.window);
+                    pending_.back().need_geometry = true;
+                }
+            } else {
+                remove_window(event.xreparent.window, false);
+            }
+            return false;
+        case MapNotify:
+            map_window(event.xmap.window);
+            return false;
+        case UnmapNotify:
+            unmap_window(event.xunmap.window);
+            return false;
+        case ConfigureNotify:
+            if (event.xconfigure.window == root_) {
+                screen_width_ = event.xconfigure.width;
+                screen_height_ = event.xconfigure.height;
+                if (back_picture_) {
+                    XRenderFreePicture(display_, back_picture_);
+                    XFreePixmap(display_, back_pixmap_);
+                    back_picture_ = 0;
+                    back_pixmap_ = 0;
+                }
+                damage_screen();
+            } else {
+                configure_window(event.xconfigure);
+            }
+            return false;
+        case CirculateNotify:
+            if (clients_.count(event.xcirculate.window)) {
+                restack(event.xcirculate.window, event.xcirculate.place == PlaceOnTop ? stack_.back() : None);
+            }
+            return false;
+        case Expose:
+            if (event.xexpose.window == root_ || event.xexpose.window == overlay_) {
+                XRectangle rect;
+                rect.x = static_cast<short>(event.xexpose.x);
+                rect.y = static_cast<short>(event.xexpose.y);
+                rect.width = static_cast<unsigned short>(event.xexpose.width);
+                rect.height = static_cast<unsigned short>(event.xexpose.height);
+                add_damage(rect);
+            }
+            return false;
+        default:
+            if (event.type == damage_event_base_ + XDamageNotify) {
+                damage_window(reinterpret_cast<const XDamageNotifyEvent&>(event));
+                return true;
+            }
+            return false;
+    }
+}
+
+void X11Compositor::set_opacity(Window window, unsigned char opacity) {
+    auto it = clients_.find(window);
+    if (it == clients_.end() || it->second.opacity == opacity) return;
+
+    it->second.opacity = opacity;
+    if (it->second.mapped) add_damage(bounds(it->second));
+}
+
+void X11Compositor::set_shadow(Window window, bool enabled) {
+    auto it = clients_.find(window);
+    if (it == clients_.end() || it->second.shadow == enabled) return;
+
+    Client& client = it->second;
+    if (client.mapped && !enabled) add_damage(extents(client));
+    client.shadow = enabled;
+    if (client.mapped && enabled) add_damage(extents(client));
+}
+
+void X11Compositor::set_fullscreen(Window window, bool fullscreen) {
+    if (fullscreen) {
+        fullscreen_.insert(window);
+    } else {
+        fullscreen_.erase(window);
+    }
+}
+
+void X11Compositor::paint() {
+    if (!display_) return;
+
+    resolve_attributes();
+
+    // Stacking, geometry and the fullscreen flags are all current here,
+    // so this is the one place that decides whether to bypass
+    bool bypass = can_bypass();
+    if (bypass != bypassed_) set_bypassed(bypass);
+    if (bypassed_) {
+        if (damage_) XFixesDestroyRegion(display_, damage_);
+        damage_ = 0;
+        return;
+    }
+
+    if (!damage_) return;
+    if (!back_picture_) create_back_buffer();
+
+    // Top-down: opaque windows paint directly and shrink the clip; each
+    // window remembers what was still visible above it
+    XserverRegion region = XFixesCreateRegion(display_, nullptr, 0);
+    XFixesCopyRegion(display_, region, damage_);
+    std::vector<std::pair<Client*, XserverRegion>> visible;
+    for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+        Client& client = clients_[*it];
+        if (!client.mapped || client.input_only || client.attributes_pending) continue;
+        if (!ensure_picture(client)) continue;
+
+        XRectangle r = bounds(client);
+        if (opaque(client)) {
+            XFixesSetPictureClipRegion(display_, back_picture_, 0, 0, region);
+            XRenderComposite(display_, PictOpSrc, client.picture, None, back_picture_, 0, 0, 0, 0, r.x, r.y,
+                             r.width, r.height);
+            XserverRegion area = XFixesCreateRegion(display_, &r, 1);
+            XFixesSubtractRegion(display_, region, region, area);
+            XFixesDestroyRegion(display_, area);
+        }
+
+        XserverRegion clip = XFixesCreateRegion(display_, nullptr, 0);
+        XFixesCopyRegion(display_, clip, region);
+        visible.emplace_back(&client, clip);
+    }
+
+    // Whatever no opaque window covers
+    XFixesSetPictureClipRegion(display_, back_picture_, 0, 0, region);
+    XRenderComposite(display_, PictOpSrc, background_, None, back_picture_, 0, 0, 0, 0, 0, 0,
+                     static_cast<unsigned int>(screen_width_), static_cast<unsigned int>(screen_height_));
+    XFixesDestroyRegion(display_, region);
+
+    // Bottom-up: shadows and translucent windows blend over what is below
+    for (auto it = visible.rbegin(); it != visible.rend(); ++it) {
+        Client& client = *it->first;
+        XFixesSetPictureClipRegion(display_, back_picture_, 0, 0, it->second);
+
+        if (client.shadow) {
+            // Translucent windows cast lighter shadows
+            XRectangle r = bounds(client);
+            XRectangle e = extents(client);
+            unsigned char alpha = static_cast<unsigned char>(kShadowOpacity * client.opacity + 0.5);
+            shadows_.paint(black_, back_picture_, e.x, e.y, r.width, r.height, kShadowRadius, alpha);
+        }
+        if (!opaque(client)) {
+            XRectangle r = bounds(client);
+            Picture alpha = client.opacity == 255 ? None : opacity_mask(client.opacity);
+            XRenderComposite(display_, PictOpOver, client.picture, alpha, back_picture_, 0, 0, 0, 0, r.x, r.y,
+                             r.width, r.height);
+        }
+        XFixesDestroyRegion(display_, it->second);
+    }
+
+    // Only the damaged area is copied to the screen
+    XFixesSetPictureClipRegion(display_, back_picture_, 0, 0, None);
+    XFixesSetPictureClipRegion(display_, overlay_picture_, 0, 0, damage_);
+    XRenderComposite(display_, PictOpSrc, back_picture_, None, overlay_picture_, 0, 0, 0, 0, 0, 0,
+                     static_cast<unsigned int>(screen_width_), static_cast<unsigned int>(screen_height_));
+
+    XFixesDestroyRegion(display_, damage_);
+    damage_ = 0;
+}
+
+bool X11Compositor::add_window(Window id, int x, int y, int width, int height, int border, bool mapped,
+                               Window above) {
+    if (id == overlay_ || id == selection_window_ || clients_.count(id)) return false;
+
+    Client& client = clients_[id];
+    client.id = id;
+    client.x = x;
+    client.y = y;
+    client.width = width;
+    client.height = height;
+    client.border = border;
+    client.mapped = mapped;
+
+    stack_.push_back(id);
+    restack(id, above);
+
+    PendingWindow pending;
+    pending.id = id;
+    pending.attributes = xcb_get_window_attributes(conn_, static_cast<xcb_window_t>(id));
+    pending.geometry.sequence = 0;
+    pending.need_geometry = false;
+    pending_.push_back(pending);
+    return true;
+}
+
+void X11Compositor::remove_window(Window id, bool destroyed) {
+    auto it = clients_.find(id);
+    if (it == clients_.end()) return;
+
+    Client& client = it->second;
+    if (client.mapped && !client.attributes_pending) add_damage(extents(client));
+    release_picture(client);
+    // A destroyed window's Damage went with it
+    if (client.damage && !destroyed) {
+        XDamageDestroy(display_, client.damage);
+    }
+
+    stack_.erase(std::remove(stack_.begin(), stack_.end(), id), stack_.end());
+    clients_.erase(it);
+}
+
+void X11Compositor::restack(Window id, Window above) {
+    auto current = std::find(stack_.begin(), stack_.end(), id);
+    if (current == stack_.end()) return;
+    stack_.erase(current);
+
+    // `above` is the sibling directly below; None means the bottom, and
+    // an unknown sibling puts the window on top
+    auto position = stack_.begin();
+    if (above != None) {
+        auto sibling = std::find(stack_.begin(), stack_.end(), above);
+        position = sibling == stack_.end() ? stack_.end() : sibling + 1;
+    }
+    stack_.insert(position, id);
+}
+
+void X11Compositor::map_window(Window id) {
+    auto it = clients_.find(id);
+    if (it == clients_.end()) return;
+
+    it->second.mapped = true;
+    if (!it->second.attributes_pending) add_damage(extents(it->second));
+}
+
+void X11Compositor::unmap_window(Window id) {
+    auto it = clients_.find(id);
+    if (it == clients_.end() || !it->second.mapped) return;
+
+    Client& client = it->second;
+    if (!client.attributes_pending) add_damage(extents(client));
+    client.mapped = false;
+    release_picture(client); // A new pixmap is named on the next map
+}
+
+void X11Compositor::configure_window(const XConfigureEvent& event) {
+    auto it = clients_.find(event.window);
+    if (it == clients_.end()) return;
+
+    Client& client = it->second;
+    bool visible = client.mapped && !client.attributes_pending;
+    if (visible) add_damage(extents(client));
+
+    bool resized = client.width != event.width || client.height != event.height ||
+                   client.border != event.border_width;
+    client.x = event.x;
+    client.y = event.y;
+    client.width = event.width;
+    client.height = event.height;
+    client.border = event.border_width;
+    if (resized) release_picture(client);
+    restack(event.window, event.above);
+
+    if (visible) add_damage(extents(client));
+}
+
+void X11Compositor::damage_window(const XDamageNotifyEvent& event) {
+    auto it = clients_.find(event.drawable);
+    if (it == clients_.end()) return;
+
+    // Damage is relative to the window's inside origin
+    const Client& client = it->second;
+    if (bypassed_) {
+        // Nothing is painted; just re-arm the report
+        XDamageSubtract(display_, client.damage, None, None);
+        return;
+    }
+    XserverRegion parts = XFixesCreateRegion(display_, nullptr, 0);
+    XDamageSubtract(display_, client.damage, None, parts);
+    if (!client.mapped) {
+        XFixesDestroyRegion(display_, parts);
+        return;
+    }
+    XFixesTranslateRegion(display_, parts, client.x + client.border, client.y + client.border);
+    add_damage(parts);
+}
+
+void X11Compositor::resolve_attributes() {
+    if (pending_.empty()) return;
+
+    std::vector<PendingWindow> pending;
+    pending.swap(pending_);
+    for (const PendingWindow& p : pending) {
+        XcbReply<xcb_get_window_attributes_reply_t> reply =
+            xcb_take(xcb_get_window_attributes_reply(conn_, p.attributes, nullptr));
+        XcbReply<xcb_get_geometry_reply_t> geometry;
+        if (p.need_geometry) {
+            geometry = xcb_take(xcb_get_geometry_reply(conn_, p.geometry, nullptr));
+        }
+
+        auto it = clients_.find(p.id);
+        if (it == clients_.end()) continue; // Gone before the reply came in
+        if (!reply || (p.need_geometry && !geometry)) {
+            remove_window(p.id, true);
+            continue;
+        }
+
+        Client& client = it->second;
+        if (geometry) {
+            client.width = geometry->width;
+            client.height = geometry->height;
+            client.border = geometry->border_width;
+        }
+        client.attributes_pending = false;
+        client.input_only = reply->_class == XCB_WINDOW_CLASS_INPUT_ONLY;
+        client.mapped = client.mapped || reply->map_state == XCB_MAP_STATE_VIEWABLE;
+        if (client.input_only) continue;
+
+        client.visual = find_visual(reply->visual);
+        XRenderPictFormat* format = client.visual ? XRenderFindVisualFormat(display_, client.visual) : nullptr;
+        client.argb = format && format->type == PictTypeDirect && format->direct.alphaMask;
+        client.damage = XDamageCreate(display_, p.id, XDamageReportNonEmpty);
+        if (client.mapped) add_damage(extents(client));
+    }
+}
+
+Visual* X11Compositor::find_visual(xcb_visualid_t id) const {
+    // Xlib keeps the screen's visuals locally; no round trip
+    Screen* screen = ScreenOfDisplay(display_, screen_);
+    for (int d = 0; d < screen->ndepths; ++d) {
+        const Depth& depth = screen->depths[d];
+        for (int v = 0; v < depth.nvisuals; ++v) {
+            if (depth.visuals[v].visualid == id) return &depth.visuals[v];
+        }
+    }
+    return nullptr;
+}
+
+XRectangle X11Compositor::bounds(const Client& client) const {
+    XRectangle r;
+    r.x = static_cast<short>(client.x);
+    r.y = static_cast<short>(client.y);
+    r.width = static_cast<unsigned short>(client.width + 2 * client.border);
+    r.height = static_cast<unsigned short>(client.height + 2 * client.border);
+    return r;
+}
+
+XRectangle X11Compositor::extents(const Client& client) const {
+    XRectangle r = bounds(client);
+    if (client.shadow) {
+        r.x = static_cast<short>(r.x + kShadowOffsetX - shadow_extent_);
+        r.y = static_cast<short>(r.y + kShadowOffsetY - shadow_extent_);
+        r.width = static_cast<unsigned short>(r.width + 2 * shadow_extent_);
+        r.height = static_cast<unsigned short>(r.height + 2 * shadow_extent_);
+    }
+    return r;
+}
+
+void X11Compositor::add_damage(XserverRegion region) {
+    if (damage_) {
+        XFixesUnionRegion(display_, damage_, damage_, region);
+        XFixesDestroyRegion(display_, region);
+    } else {
+        damage_ = region;
+    }
+}
+
+void X11Compositor::add_damage(const XRectangle& rect) {
+    XRectangle r = rect;
+    add_damage(XFixesCreateRegion(display_, &r, 1));
+}
+
+void X11Compositor::damage_screen() {
+    XRectangle screen;
+    screen.x = 0;
+    screen.y = 0;
+    screen.width = static_cast<unsigned short>(screen_width_);
+    screen.height = static_cast<unsigned short>(screen_height_);
+    add_damage(screen);
+}
+
+void X11Compositor::release_picture(Client& client) {
+    if (client.picture) {
+        XRenderFreePicture(display_, client.picture);
+        client.picture = 0;
+    }
+    if (client.pixmap) {
+        XFreePixmap(display_, client.pixmap);
+        client.pixmap = 0;
+    }
+}
+
+bool X11Compositor::ensure_picture(Client& client) {
+    if (client.picture) return true;
+    if (!client.mapped || !client.visual) return false;
+
+    XRenderPictFormat* format = XRenderFindVisualFormat(display_, client.visual);
+    if (!format) return false;
+
+    // The pixmap stays valid until the window is unmapped or resized
+    client.pixmap = XCompositeNameWindowPixmap(display_, client.id);
+    XRenderPictureAttributes attributes;
+    attributes.subwindow_mode = IncludeInferiors;
+    client.picture = XRenderCreatePicture(display_, client.pixmap, format, CPSubwindowMode, &attributes);
+    return true;
+}
+
+Picture X11Compositor::opacity_mask(unsigned char opacity) {
+    auto it = opacity_masks_.find(opacity);
+    if (it != opacity_masks_.end()) return it->second;
+
+    unsigned short alpha = static_cast<unsigned short>(opacity * 0x101);
+    Picture mask = create_solid(display_, root_, 8, XRenderFindStandardFormat(display_, PictStandardA8), 0, 0, 0,
+                                alpha);
+    opacity_masks_[opacity] = mask;
+    return mask;
+}
+
+void X11Compositor::create_back_buffer() {
+    back_pixmap_ = XCreatePixmap(display_, root_, static_cast<unsigned int>(screen_width_),
+                                 static_cast<unsigned int>(screen_height_),
+                                 static_cast<unsigned int>(DefaultDepth(display_, screen_)));
+    back_picture_ = XRenderCreatePicture(display_, back_pixmap_,
+                                         XRenderFindVisualFormat(display_, DefaultVisual(display_, screen_)), 0,
+                                         nullptr);
+}
+
+bool X11Compositor::can_bypass() const {
+    // Only the topmost visible window decides: a popup or notification
+    // above a fullscreen game keeps compositing on
+    for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+        const Client& client = clients_.at(*it);
+        if (!client.mapped || client.input_only) continue;
+        if (client.attributes_pending || !fullscreen_.count(client.id) || !opaque(client)) return false;
+        XRectangle r = bounds(client);
+        return r.x <= 0 && r.y <= 0 && r.x + r.width >= screen_width_ && r.y + r.height >= screen_height_;
+    }
+    return false;
+}
+
+void X11Compositor::set_bypassed(bool bypassed) {
+    if (bypassed) {
+        // Window pixmaps are only valid while redirected
+        for (auto& pair : clients_) {
+            release_picture(pair.second);
+        }
+        XCompositeUnredirectSubwindows(display_, root_, CompositeRedirectManual);
+        XUnmapWindow(display_, overlay_);
+    } else {
+        XCompositeRedirectSubwindows(display_, root_, CompositeRedirectManual);
+        XMapWindow(display_, overlay_);
+        damage_screen();
+    }
+    bypassed_ = bypassed;
+    std::cout << "X11Compositor: " << (bypassed ? "Bypassed for a fullscreen window" : "Compositing again")
+              << std::endl;
+}
@@ -0,0 +1,151 @@
+#ifndef SRDWM_X11_COMPOSITOR_H
+#define SRDWM_X11_COMPOSITOR_H
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <X11/Xlib.h>
+#include <X11/extensions/Xcomposite.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#include <X11/extensions/Xrender.h>
+#include <xcb/xcb.h>
+
+#include "x11_shadow_cache.h"
+
+// In-process compositing manager using only core extensions.
+//
+// Every child of the root is redirected (manual mode) and painted by us
+// into a back buffer with XRender, which the server does on the CPU, so
+// this runs on machines without a GPU and under Xvfb. Each window has an
+// XDamage object; damage is accumulated into one server-side region and
+// only that region is repainted, once per main loop iteration (paint()).
+//
+// The paint pass follows the usual two-pass scheme: opaque windows top
+// to bottom, each one removing its area from the clip, then shadows and
+// translucent windows bottom to top, each clipped to what was still
+// visible above it. Opacity uses one cached 1x1 alpha picture per level;
+// shadows are nine-piece masks shared by all windows (X11ShadowCache), so
+// resizing a window does not recompute its shadow.
+//
+// Window attributes (visual, class) for new windows are requested when
+// the window appears and collected in one batch before the next paint.
+//
+// While the topmost window is an opaque fullscreen window covering the
+// whole screen, compositing is bypassed: everything is unredirected and
+// the overlay unmapped, so the client's frames go straight to the screen
+// and neither we nor the server do any compositing work for them.
+class X11Compositor {
+public:
+    static constexpr int kShadowRadius = 12;
+    static constexpr int kShadowOffsetX = 0;
+    static constexpr int kShadowOffsetY = 4;
+    static constexpr double kShadowOpacity = 0.5;
+
+    X11Compositor() = default;
+    ~X11Compositor();
+
+    X11Compositor(const X11Compositor&) = delete;
+    X11Compositor& operator=(const X11Compositor&) = delete;
+
+    // False (and nothing redirected) if Composite, Damage, Render or
+    // XFixes is missing
+    bool initialize(Display* display, Window root);
+    void shutdown();
+    bool active() const { return display_ != nullptr; }
+
+    // Track stacking, geometry and damage from the root's substructure
+    // events; returns true if the event was a damage notification
+    bool handle_event(const XEvent& event);
+
+    // Per top-level window (frame, or client when not reparented)
+    void set_opacity(Window window, unsigned char opacity);
+    void set_shadow(Window window, bool enabled);
+    void set_fullscreen(Window window, bool fullscreen);
+
+    // Repaint the accumulated damage, if any
+    void paint();
+
+    Window overlay() const { return overlay_; }
+    bool bypassed() const { return bypassed_; }
+
+private:
+    struct Client {
+        Window id = 0;
+        int x = 0, y = 0;
+        int width = 0, height = 0, border = 0;
+        bool mapped = false;
+        bool input_only = false;
+        bool attributes_pending = true;
+        bool argb = false;
+        Visual* visual = nullptr;
+        Damage damage = 0;
+        Pixmap pixmap = 0;
+        Picture picture = 0;
+        unsigned char opacity = 255;
+        bool shadow = false;
+    };
+
+    struct PendingWindow {
+        Window id;
+        xcb_get_window_attributes_cookie_t attributes;
+        xcb_get_geometry_cookie_t geometry;
+        bool need_geometry; // Reparented to the root: no geometry in the event
+    };
+
+    bool add_window(Window id, int x, int y, int width, int height, int border, bool mapped, Window above);
+    void remove_window(Window id, bool destroyed);
+    void restack(Window id, Window above);
+    void map_window(Window id);
+    void unmap_window(Window id);
+    void configure_window(const XConfigureEvent& event);
+    void damage_window(const XDamageNotifyEvent& event);
+    void resolve_attributes();
+    Visual* find_visual(xcb_visualid_t id) const;
+
+    bool opaque(const Client& client) const { return !client.argb && client.opacity == 255; }
+    XRectangle bounds(const Client& client) const;
+    XRectangle extents(const Client& client) const; // Including the shadow
+    void add_damage(XserverRegion region); // Takes ownership
+    void add_damage(const XRectangle& rect);
+    void damage_screen();
+
+    void release_picture(Client& client);
+    bool ensure_picture(Client& client);
+    Picture opacity_mask(unsigned char opacity);
+    void create_back_buffer();
+
+    // Fullscreen bypass: candidate check, and switching in and out
+    bool can_bypass() const;
+    void set_bypassed(bool bypassed);
+
+    Display* display_ = nullptr;
+    xcb_connection_t* conn_ = nullptr;
+    Window root_ = 0;
+    Window overlay_ = 0;
+    Window selection_window_ = 0; // Owns _NET_WM_CM_Sn
+    int screen_ = 0;
+    int screen_width_ = 0, screen_height_ = 0;
+    int damage_event_base_ = 0;
+    bool bypassed_ = false; // Unredirected for a fullscreen window
+
+    Picture overlay_picture_ = 0;
+    Pixmap back_pixmap_ = 0;
+    Picture back_picture_ = 0;
+    Picture background_ = 0;   // Solid fill where no window covers the root
+    Picture black_ = 0;        // Shadow colour
+    XserverRegion damage_ = 0; // Accumulated since the last paint
+
+    std::vector<Window> stack_; // Bottom to top
+    std::unordered_map<Window, Client> clients_;
+    std::vector<PendingWindow> pending_;
+    std::map<unsigned char, Picture> opacity_masks_;
+    std::set<Window> fullscreen_; // May be set before we see the window
+    X11ShadowCache shadows_;
+    int shadow_extent_ = 0;
+};
+
+#endif // SRDWM_X11_COMPOSITOR_H
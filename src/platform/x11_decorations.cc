@@ -0,0 +1,408 @@
+#include "x11_decorations.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+X11DecorationRenderer::~X11DecorationRenderer() {
+    shutdown();
+}
+
+bool X11DecorationRenderer::initialize(Display* display, const X11DecorationTheme& focused,
+                                       const X11DecorationTheme& unfocused) {
+    display_ = display;
+    screen_ = DefaultScreen(display_);
+    focused_theme_ = focused;
+    unfocused_theme_ = unfocused;
+
+    Metrics base = metrics_.base();
+    base.titlebar_height = kTitlebarHeight;
+    base.text_padding = kTextPadding;
+    metrics_.set_base(base);
+
+    XGCValues values;
+    values.graphics_exposures = False;
+    copy_gc_ = XCreateGC(display_, RootWindow(display_, screen_), GCGraphicsExposures, &values);
+
+    // 1x up front, so a broken theme fails here; other scales on first use
+    if (!scale_resources(ScaledMetrics::bucket(1.0f))) {
+        std::cerr << "X11DecorationRenderer: Failed to create theme resources" << std::endl;
+        shutdown();
+        return false;
+    }
+    return true;
+}
+
+void X11DecorationRenderer::set_border_width(int width) {
+    Metrics base = metrics_.base();
+    base.border_width = width;
+    metrics_.set_base(base);
+}
+
+const X11DecorationRenderer::ScaleResources* X11DecorationRenderer::scale_resources(int bucket) {
+    auto it = scales_.find(bucket);
+    if (it != scales_.end()) return &it->second;
+
+    const float scale = ScaledMetrics::bucket_scale(bucket);
+    ScaleResources resources;
+    if (!create_theme(focused_theme_, scale, resources.focused) ||
+        !create_theme(unfocused_theme_, scale, resources.unfocused)) {
+        free_theme(resources.focused);
+        free_theme(resources.unfocused);
+        return nullptr;
+    }
+    return &scales_.emplace(bucket, resources).first->second;
+}
+
+void X11DecorationRenderer::shutdown() {
+    if (!display_) return;
+
+    for (auto& pair : frames_) {
+        free_frame(pair.second);
+    }
+    frames_.clear();
+
+    for (auto& pair : scales_) {
+        free_theme(pair.second.focused);
+        free_theme(pair.second.unfocused);
+    }
+    scales_.clear();
+    if (copy_gc_) {
+        XFreeGC(display_, copy_gc_);
+        copy_gc_ = nullptr;
+    }
+    text_cache_.clear(); // Keyed by font pointers that are now gone
+    display_ = nullptr;
+}
+
+bool X11DecorationRenderer::render(Window frame, const std::string& title, bool focused, int width, float scale) {
+    if (!display_ || width <= 0) return false;
+
+    const int bucket = ScaledMetrics::bucket(scale);
+    const ScaleResources* resources = scale_resources(bucket);
+    if (!resources) return false;
+    const int height = metrics_.at_bucket(bucket).titlebar_height;
+
+    FrameCache& cache = frames_[frame];
+    if (cache.pixmap && cache.width == width && cache.bucket == bucket && cache.focused == focused &&
+        cache.title == title) {
+        return false;
+    }
+
+    // Only a size change needs a new pixmap; title/focus reuse it
+    if (!cache.pixmap || cache.width != width || cache.height != height) {
+        free_frame(cache);
+        cache.pixmap = XCreatePixmap(display_, frame, static_cast<unsigned int>(width),
+                                     static_cast<unsigned int>(height),
+                                     static_cast<unsigned int>(DefaultDepth(display_, screen_)));
+        cache.width = width;
+        cache.height = height;
+#if HAVE_XFT
+        cache.xft_draw = XftDrawCreate(display_, cache.pixmap, DefaultVisual(display_, screen_),
+                                       DefaultColormap(display_, screen_));
+#endif
+    }
+
+    cache.bucket = bucket;
+    cache.title = title;
+    cache.focused = focused;
+    draw_title(cache, focused ? resources->focused : resources->unfocused);
+    return true;
+}
+
+void X11DecorationRenderer::blit(Window frame, int x, int y, int width, int height) const {
+    auto it = frames_.find(frame);
+    if (it == frames_.end() || !it->second.pixmap) return;
+
+    const FrameCache& cache = it->second;
+    if (x >= cache.width || y >= cache.height || width <= 0 || height <= 0) return;
+
+    XCopyArea(display_, cache.pixmap, frame, copy_gc_, x, y,
+              static_cast<unsigned int>(std::min(width, cache.width - x)),
+              static_cast<unsigned int>(std::min(height, cache.height - y)), x, y);
+}
+
+void X11DecorationRenderer::blit(Window frame) const {
+    blit(frame, 0, 0, 1 << 15, 1 << 15);
+}
+
+namespace {
+
+// True if the rectangles overlap or share an edge
+bool touches(const XRectangle& a, const XRectangle& b) {
+    return a.x <= b.x + b.width && b.x <= a.x + a.width &&
+           a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+XRectangle bounds(const XRectangle& a, const XRectangle& b) {
+    int x1 = std::min(a.x, b.x);
+    int y1 = std::min(a.y, b.y);
+    int x2 = std::max(a.x + a.width, b.x + b.width);
+    int y2 = std::max(a.y + a.height, b.y + b.height);
+    XRectangle r;
+    r.x = static_cast<short>(x1);
+    r.y = static_cast<short>(y1);
+    r.width = static_cast<unsigned short>(x2 - x1);
+    r.height = static_cast<unsigned short>(y2 - y1);
+    return r;
+}
+
+} // namespace
+
+void X11DecorationRenderer::add_damage(Window frame, int x, int y, int width, int height) {
+    auto it = frames_.find(frame);
+    if (it == frames_.end() || !it->second.pixmap) return;
+    FrameCache& cache = it->second;
+
+    // Only the titlebar is drawn by us; the rest of the frame is covered by
+    // the client or painted by the server (background and border)
+    int x1 = std::max(0, x);
+    int y1 = std::max(0, y);
+    int x2 = std::min(cache.width, x + width);
+    int y2 = std::min(cache.height, y + height);
+    if (x1 >= x2 || y1 >= y2) return;
+
+    XRectangle rect;
+    rect.x = static_cast<short>(x1);
+    rect.y = static_cast<short>(y1);
+    rect.width = static_cast<unsigned short>(x2 - x1);
+    rect.height = static_cast<unsigned short>(y2 - y1);
+
+    // Fold in every rectangle the new one touches; a merge can make it
+    // touch ones already passed, so rescan until nothing changes
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (auto r = cache.damage.begin(); r != cache.damage.end(); ++r) {
+            if (touches(*r, rect)) {
+                rect = bounds(*r, rect);
+                cache.damage.erase(r);
+                merged = true;
+                break;
+            }
+        }
+    }
+    cache.damage.push_back(rect);
+
+    if (cache.damage.size() > kMaxDamageRects) {
+        XRectangle all = cache.damage.front();
+        for (const XRectangle& r : cache.damage) {
+            all = bounds(all, r);
+        }
+        cache.damage.assign(1, all);
+    }
+}
+
+void X11DecorationRenderer::repaint_damage(Window frame) {
+    auto it = frames_.find(frame);
+    if (it == frames_.end()) return;
+
+    for (const XRectangle& r : it->second.damage) {
+        blit(frame, r.x, r.y, r.width, r.height);
+    }
+    it->second.damage.clear();
+}
+
+void X11DecorationRenderer::release(Window frame) {
+    auto it = frames_.find(frame);
+    if (it == frames_.end()) return;
+
+    free_frame(it->second);
+    frames_.erase(it);
+}
+
+bool X11DecorationRenderer::create_theme(const X11DecorationTheme& theme, float scale, ThemeResources& resources) {
+    Window root = RootWindow(display_, screen_);
+    resources.theme = theme;
+
+    XGCValues values;
+    values.foreground = theme.background;
+    values.graphics_exposures = False;
+    resources.background_gc = XCreateGC(display_, root, GCForeground | GCGraphicsExposures, &values);
+
+    values.foreground = theme.foreground;
+    values.background = theme.background;
+    resources.text_gc = XCreateGC(display_, root, GCForeground | GCBackground | GCGraphicsExposures, &values);
+
+#if HAVE_XFT
+    // Fontconfig scales the pattern's own size, whether given in points
+    // or pixels
+    std::string font = theme.font;
+    if (scale != 1.0f) {
+        std::ostringstream pattern;
+        pattern << font << ":scale=" << scale;
+        font = pattern.str();
+    }
+    resources.xft_font = XftFontOpenName(display_, screen_, font.c_str());
+    XRenderColor color;
+    color.red = static_cast<unsigned short>(((theme.foreground >> 16) & 0xff) * 0x101);
+    color.green = static_cast<unsigned short>(((theme.foreground >> 8) & 0xff) * 0x101);
+    color.blue = static_cast<unsigned short>((theme.foreground & 0xff) * 0x101);
+    color.alpha = 0xffff;
+    resources.xft_color_allocated = XftColorAllocValue(display_, DefaultVisual(display_, screen_),
+                                                       DefaultColormap(display_, screen_), &color,
+                                                       &resources.xft_color);
+    if (resources.xft_font && resources.xft_color_allocated) {
+        return true;
+    }
+    std::cerr << "X11DecorationRenderer: Xft font '" << theme.font << "' unavailable, using core font" << std::endl;
+#endif
+
+    // Core font fallback; loaded once, not per draw. Core fonts do not
+    // scale, so pick the nearest misc-fixed size (10x20 is the largest
+    // of the standard aliases) and settle for "fixed" if it is missing.
+    const char* core_font = scale >= 2.0f ? "10x20" : scale >= 1.5f ? "9x18" : "fixed";
+    resources.core_font = XLoadQueryFont(display_, core_font);
+    if (!resources.core_font && scale >= 1.5f) {
+        resources.core_font = XLoadQueryFont(display_, "fixed");
+    }
+    if (!resources.core_font) return false;
+    XSetFont(display_, resources.text_gc, resources.core_font->fid);
+    return true;
+}
+
+void X11DecorationRenderer::free_theme(ThemeResources& resources) {
+#if HAVE_XFT
+    if (resources.xft_font) {
+        XftFontClose(display_, resources.xft_font);
+        resources.xft_font = nullptr;
+    }
+    if (resources.xft_color_allocated) {
+        XftColorFree(display_, DefaultVisual(display_, screen_), DefaultColormap(display_, screen_),
+                     &resources.xft_color);
+        resources.xft_color_allocated = false;
+    }
+#endif
+    if (resources.core_font) {
+        XFreeFont(display_, resources.core_font);
+        resources.core_font = nullptr;
+    }
+    if (resources.text_gc) {
+        XFreeGC(display_, resources.text_gc);
+        resources.text_gc = nullptr;
+    }
+    if (resources.background_gc) {
+        XFreeGC(display_, resources.background_gc);
+        resources.background_gc = nullptr;
+    }
+}
+
+void X11DecorationRenderer::free_frame(FrameCache& cache) {
+#if HAVE_XFT
+    if (cache.xft_draw) {
+        XftDrawDestroy(cache.xft_draw);
+        cache.xft_draw = nullptr;
+    }
+#endif
+    if (cache.pixmap) {
+        XFreePixmap(display_, cache.pixmap);
+        cache.pixmap = 0;
+    }
+    cache.width = 0;
+    cache.height = 0;
+    cache.damage.clear();
+}
+
+void X11DecorationRenderer::draw_title(FrameCache& cache, const ThemeResources& resources) {
+    XFillRectangle(display_, cache.pixmap, resources.background_gc, 0, 0,
+                   static_cast<unsigned int>(cache.width), static_cast<unsigned int>(cache.height));
+    if (cache.title.empty()) return;
+
+    const int padding = metrics_.at_bucket(cache.bucket).text_padding;
+    const X11TextRun& run = layout_title(cache.title, resources, cache.width - 2 * padding);
+
+#if HAVE_XFT
+    if (resources.xft_font && cache.xft_draw) {
+        int baseline = (cache.height + resources.xft_font->ascent - resources.xft_font->descent) / 2;
+        XftDrawGlyphs(cache.xft_draw, &resources.xft_color, resources.xft_font, padding, baseline,
+                      run.glyphs.data(), static_cast<int>(run.glyphs.size()));
+        return;
+    }
+#endif
+
+    if (resources.core_font) {
+        int baseline = (cache.height + resources.core_font->ascent - resources.core_font->descent) / 2;
+        XDrawString(display_, cache.pixmap, resources.text_gc, padding, baseline,
+                    run.text.data(), static_cast<int>(run.text.size()));
+    }
+}
+
+const X11TextRun& X11DecorationRenderer::layout_title(const std::string& title, const ThemeResources& resources,
+                                                      int max_width) {
+    const void* font = resources.core_font;
+    std::string ellipsis = "...";
+#if HAVE_XFT
+    if (resources.xft_font) {
+        font = resources.xft_font;
+        ellipsis = "\xE2\x80\xA6"; // U+2026
+    }
+#endif
+
+    if (const X11TextRun* cached = text_cache_.find(title, font, max_width)) {
+        return *cached;
+    }
+
+    X11TextRun run;
+    run.text = title;
+    run.width = text_width(resources, title);
+
+    if (run.width > max_width) {
+        // Cut only at code point boundaries so UTF-8 sequences stay whole
+        std::vector<size_t> cuts;
+        for (size_t i = 0; i < title.size(); ++i) {
+            if ((static_cast<unsigned char>(title[i]) & 0xC0) != 0x80) {
+                cuts.push_back(i);
+            }
+        }
+
+        // Longest prefix that still fits with the ellipsis appended; if not
+        // even the ellipsis fits it is drawn anyway and clipped
+        size_t lo = 0;
+        size_t hi = cuts.empty() ? 0 : cuts.size() - 1;
+        run.text = ellipsis;
+        run.width = text_width(resources, ellipsis);
+        while (lo < hi) {
+            size_t mid = (lo + hi + 1) / 2;
+            std::string candidate = title.substr(0, cuts[mid]) + ellipsis;
+            int width = text_width(resources, candidate);
+            if (width <= max_width) {
+                lo = mid;
+                run.text = std::move(candidate);
+                run.width = width;
+            } else {
+                hi = mid - 1;
+            }
+        }
+    }
+
+#if HAVE_XFT
+    if (resources.xft_font) {
+        const FcChar8* p = reinterpret_cast<const FcChar8*>(run.text.data());
+        int remaining = static_cast<int>(run.text.size());
+        while (remaining > 0) {
+            FcChar32 ucs4;
+            int used = FcUtf8ToUcs4(p, &ucs4, remaining);
+            if (used <= 0) break; // Invalid UTF-8; draw what decoded so far
+            run.glyphs.push_back(XftCharIndex(display_, resources.xft_font, ucs4));
+            p += used;
+            remaining -= used;
+        }
+    }
+#endif
+
+    return text_cache_.insert(title, font, max_width, std::move(run));
+}
+
+int X11DecorationRenderer::text_width(const ThemeResources& resources, const std::string& text) const {
+#if HAVE_XFT
+    if (resources.xft_font) {
+        XGlyphInfo extents;
+        XftTextExtentsUtf8(display_, resources.xft_font, reinterpret_cast<const FcChar8*>(text.data()),
+                           static_cast<int>(text.size()), &extents);
+        return extents.xOff;
+    }
+#endif
+    if (resources.core_font) {
+        return XTextWidth(resources.core_font, text.data(), static_cast<int>(text.size()));
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+#ifndef SRDWM_X11_DECORATIONS_H
+#define SRDWM_X11_DECORATIONS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <X11/Xlib.h>
+#if HAVE_XFT
+#include <X11/Xft/Xft.h>
+#endif
+
+#include "x11_text_cache.h"
+#include "../layouts/scaled_metrics.h"
+
+// Titlebar colours and font for one decoration state
+struct X11DecorationTheme {
+    unsigned long background;
+    unsigned long foreground;
+    std::string font; // Xft pattern when HAVE_XFT, core font name otherwise
+};
+
+// Renders titlebars for frame windows.
+//
+// GCs and fonts are created once per theme state and live as long as the
+// connection. Each frame keeps an offscreen pixmap holding its rendered
+// titlebar at the real width; Expose only copies from it, and the pixmap
+// is redrawn only when the title, focus state or width changes.
+//
+// Exposed rectangles are accumulated per frame and merged until the last
+// Expose of a burst (count == 0), so uncovering a frame costs a few small
+// copies of the damaged area rather than a full repaint.
+//
+// Title text is measured, ellipsized to the available width and (with Xft)
+// mapped to glyphs once; the result is kept in an LRU layout cache.
+//
+// Sizes are logical pixels, scaled per monitor. Fonts and GCs are kept per
+// scale bucket and created the first time something is drawn at that
+// scale, so a window moving between a 1x and a 2x monitor only redraws
+// its own titlebar with resources (and text layouts) that already exist.
+class X11DecorationRenderer {
+public:
+    static constexpr int kTitlebarHeight = 30; // Logical pixels
+    static constexpr int kTextPadding = 10;
+
+    X11DecorationRenderer() = default;
+    ~X11DecorationRenderer();
+
+    bool initialize(Display* display, const X11DecorationTheme& focused, const X11DecorationTheme& unfocused);
+    void shutdown();
+
+    // Titlebar height, text padding and frame border at a monitor scale
+    const Metrics& metrics(float scale) { return metrics_.at(scale); }
+    void set_border_width(int width);
+
+    // Bring the cached pixmap up to date; returns true if it was redrawn
+    bool render(Window frame, const std::string& title, bool focused, int width, float scale = 1.0f);
+
+    // Copy a region of the cached titlebar onto the frame
+    void blit(Window frame, int x, int y, int width, int height) const;
+    void blit(Window frame) const;
+
+    // Record an exposed area of the frame; repaint_damage() copies the
+    // merged damage from the cached titlebar and clears it
+    void add_damage(Window frame, int x, int y, int width, int height);
+    void repaint_damage(Window frame);
+
+    // Forget a frame's cached pixmap (frame destroyed or undecorated)
+    void release(Window frame);
+
+    // Bound on remembered title layouts
+    void set_text_cache_size(size_t entries) { text_cache_.set_capacity(entries); }
+
+private:
+    struct ThemeResources {
+        X11DecorationTheme theme;
+        GC background_gc = nullptr;
+        GC text_gc = nullptr;
+        XFontStruct* core_font = nullptr;
+#if HAVE_XFT
+        XftFont* xft_font = nullptr;
+        XftColor xft_color{};
+        bool xft_color_allocated = false;
+#endif
+    };
+
+    // Above this many disjoint rectangles the damage collapses to its bounds
+    static constexpr size_t kMaxDamageRects = 8;
+
+    struct ScaleResources {
+        ThemeResources focused;
+        ThemeResources unfocused;
+    };
+
+    struct FrameCache {
+        Pixmap pixmap = 0;
+        int width = 0;
+        int height = 0;
+        int bucket = 0;
+        std::vector<XRectangle> damage;
+        std::string title;
+        bool focused = false;
+#if HAVE_XFT
+        XftDraw* xft_draw = nullptr;
+#endif
+    };
+
+    bool create_theme(const X11DecorationTheme& theme, float scale, ThemeResources& resources);
+    void free_theme(ThemeResources& resources);
+    const ScaleResources* scale_resources(int bucket);
+    void free_frame(FrameCache& cache);
+    void draw_title(FrameCache& cache, const ThemeResources& resources);
+    const X11TextRun& layout_title(const std::string& title, const ThemeResources& resources, int max_width);
+    int text_width(const ThemeResources& resources, const std::string& text) const;
+
+    Display* display_ = nullptr;
+    int screen_ = 0;
+    X11DecorationTheme focused_theme_;
+    X11DecorationTheme unfocused_theme_;
+    std::map<int, ScaleResources> scales_; // By scale bucket
+    GC copy_gc_ = nullptr;
+    ScaledMetrics metrics_;
+    std::map<Window, FrameCache> frames_;
+    X11TextLayoutCache text_cache_;
+};
+
+#endif // SRDWM_X11_DECORATIONS_H
@@ -0,0 +1,79 @@
+#include "x11_keysyms.h"
+#include "x11_xcb.h"
+#include <algorithm>
+
+X11KeysymCache::~X11KeysymCache() {
+    shutdown();
+}
+
+void X11KeysymCache::initialize(xcb_connection_t* conn) {
+    conn_ = conn;
+    rebuild();
+}
+
+void X11KeysymCache::shutdown() {
+    if (symbols_) {
+        xcb_key_symbols_free(symbols_);
+        symbols_ = nullptr;
+    }
+    key_codes_.clear();
+    conn_ = nullptr;
+}
+
+bool X11KeysymCache::rebuild() {
+    if (!conn_) return false;
+
+    // Send the modifier mapping request before xcb-keysyms blocks on the
+    // keyboard mapping, so both replies arrive in one round trip
+    xcb_get_modifier_mapping_cookie_t modifier_cookie = xcb_get_modifier_mapping(conn_);
+
+    if (symbols_) {
+        xcb_key_symbols_free(symbols_);
+    }
+    symbols_ = xcb_key_symbols_alloc(conn_);
+
+    const xcb_setup_t* setup = xcb_get_setup(conn_);
+    std::array<Row, 256> table{};
+    for (int code = setup->min_keycode; code <= setup->max_keycode; ++code) {
+        for (int column = 0; column < kGroups * kLevels; ++column) {
+            table[code][column] = symbols_ ? xcb_key_symbols_get_keysym(symbols_, static_cast<xcb_keycode_t>(code),
+                                                                       column)
+                                           : 0;
+        }
+    }
+
+    std::bitset<256> modifiers;
+    XcbReply<xcb_get_modifier_mapping_reply_t> reply =
+        xcb_take(xcb_get_modifier_mapping_reply(conn_, modifier_cookie, nullptr));
+    if (reply) {
+        const xcb_keycode_t* codes = xcb_get_modifier_mapping_keycodes(reply.get());
+        int count = xcb_get_modifier_mapping_keycodes_length(reply.get());
+        for (int i = 0; i < count; ++i) {
+            if (codes[i]) modifiers.set(codes[i]);
+        }
+    }
+
+    bool changed = table != table_ || modifiers != modifiers_;
+    if (!changed) return false;
+
+    table_ = table;
+    modifiers_ = modifiers;
+
+    key_codes_.clear();
+    for (int code = setup->min_keycode; code <= setup->max_keycode; ++code) {
+        for (xcb_keysym_t sym : table_[code]) {
+            if (sym == 0) continue;
+            std::vector<xcb_keycode_t>& codes = key_codes_[sym];
+            if (std::find(codes.begin(), codes.end(), code) == codes.end()) {
+                codes.push_back(static_cast<xcb_keycode_t>(code));
+            }
+        }
+    }
+    return true;
+}
+
+const std::vector<xcb_keycode_t>& X11KeysymCache::key_codes(xcb_keysym_t keysym) const {
+    static const std::vector<xcb_keycode_t> none;
+    auto it = key_codes_.find(keysym);
+    return it != key_codes_.end() ? it->second : none;
+}
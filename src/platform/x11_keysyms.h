@@ -0,0 +1,62 @@
+#ifndef SRDWM_X11_KEYSYMS_H
+#define SRDWM_X11_KEYSYMS_H
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <xcb/xcb.h>
+#include <xcb/xcb_keysyms.h>
+
+// Keycode -> keysym table for the current keyboard mapping.
+//
+// Built once from xcb-keysyms (plus the modifier mapping) and rebuilt
+// only when the server reports a new mapping (MappingNotify) or a new
+// keyboard (XkbNewKeyboardNotify). Key presses and binding resolution
+// are plain array/hash lookups into it; nothing here talks to the server
+// outside rebuild().
+//
+// The core keyboard mapping carries two groups of two levels each; XKB
+// groups beyond the second fall back to the first.
+class X11KeysymCache {
+public:
+    static constexpr int kGroups = 2;
+    static constexpr int kLevels = 2;
+
+    X11KeysymCache() = default;
+    ~X11KeysymCache();
+
+    X11KeysymCache(const X11KeysymCache&) = delete;
+    X11KeysymCache& operator=(const X11KeysymCache&) = delete;
+
+    void initialize(xcb_connection_t* conn);
+    void shutdown();
+
+    // Refetch the mapping; returns true if any keycode's keysyms or the
+    // set of modifier keys changed
+    bool rebuild();
+
+    xcb_keysym_t keysym(xcb_keycode_t key_code, int group, int level) const {
+        if (group < 0 || group >= kGroups) group = 0;
+        if (level < 0 || level >= kLevels) level = 0;
+        return table_[key_code][group * kLevels + level];
+    }
+
+    // Every keycode producing the keysym in any group or level
+    const std::vector<xcb_keycode_t>& key_codes(xcb_keysym_t keysym) const;
+
+    bool is_modifier(xcb_keycode_t key_code) const { return modifiers_.test(key_code); }
+
+private:
+    using Row = std::array<xcb_keysym_t, kGroups * kLevels>;
+
+    xcb_connection_t* conn_ = nullptr;
+    xcb_key_symbols_t* symbols_ = nullptr;
+    std::array<Row, 256> table_{};
+    std::unordered_map<xcb_keysym_t, std::vector<xcb_keycode_t>> key_codes_;
+    std::bitset<256> modifiers_;
+};
+
+#endif // SRDWM_X11_KEYSYMS_H
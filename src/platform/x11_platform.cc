@@ -1,5 +1,6 @@
 #include "x11_platform.h"
 #include <iostream>
+#include <iterator>
 #include <cstring>
 
 X11Platform::X11Platform() {
@@ -20,6 +21,9 @@ bool X11Platform::initialize() {
         return false;
     }
     
+    // Requests that need a reply go through XCB on the same connection
+    conn_ = XGetXCBConnection(display_);
+    
     // Get root window
     root_ = DefaultRootWindow(display_);
     
@@ -46,6 +50,14 @@ bool X11Platform::initialize() {
     
     // Setup extensions
     setup_extensions();
+    work_areas_.set_monitors(get_monitors());
+    
+    // EWMH: _NET_SUPPORTED and the check window; everything else is
+    // published by flush()
+    ewmh_supported_ = setup_ewmh();
+    
+    // Keycode -> keysym table; rebuilt only when the keymap changes
+    keysyms_.initialize(conn_);
     
     // Initialize decoration state
     decorations_enabled_ = true;
@@ -53,6 +65,20 @@ bool X11Platform::initialize() {
     border_color_ = 0x2e3440; // Default border color
     focused_border_color_ = 0x88c0d0; // Default focused border color
     
+    // Titlebar GCs and fonts are created once here, not per draw
+#if HAVE_XFT
+    const std::string titlebar_font = "monospace:size=9";
+#else
+    const std::string titlebar_font = "fixed";
+#endif
+    X11DecorationTheme focused_theme{focused_border_color_, 0x2E3440, titlebar_font};
+    X11DecorationTheme unfocused_theme{0x2E3440, 0xFFFFFF, titlebar_font};
+    if (!decorations_.initialize(display_, focused_theme, unfocused_theme)) {
+        std::cerr << "X11Platform: Failed to initialize decoration renderer" << std::endl;
+        return false;
+    }
+    decorations_.set_border_width(border_width_);
+    
     std::cout << "X11Platform: Initialized successfully" << std::endl;
     return true;
 }
@@ -67,12 +93,35 @@ void X11Platform::shutdown() {
         }
     }
     window_map_.clear();
+    pending_window_events_.clear();
+    if (wm_check_window_) {
+        xcb_destroy_window(conn_, wm_check_window_);
+        wm_check_window_ = 0;
+    }
+    ewmh_supported_ = false;
+    published_.clear();
+    client_order_.clear();
+    client_desktops_.clear();
     frame_window_map_.clear();
-    
-    // Close X11 display
+    frame_clients_.clear();
+    overlay_titlebar_map_.clear();
+    occlusion_ = OcclusionTracker();
+    occluded_.clear();
+    iconic_.clear();
+    expected_unmaps_.clear();
+    configured_.clear();
+    floating_.clear();
+    decoration_scale_.clear();
+    compositor_.shutdown();
+    decorations_.shutdown();
+    keysyms_.shutdown();
+    key_grabs_.clear();
+    
+    // Close X11 display (also closes the shared XCB connection)
     if (display_) {
         XCloseDisplay(display_);
         display_ = nullptr;
+        conn_ = nullptr;
     }
     
     std::cout << "X11Platform: Shutdown complete" << std::endl;
@@ -82,26 +131,118 @@ bool X11Platform::poll_events(std::vector<Event>& events) {
     if (!display_) return false;
     
     events.clear();
+    key_events_.clear(); // The previous batch has been consumed
+    fullscreen_events_.clear();
     
-    // Check for pending events
-    if (XPending(display_) > 0) {
+    // Drain everything that is queued. Only the first check may flush;
+    // requests made by the handlers stay buffered until flush().
+    int pending = XPending(display_);
+    while (pending > 0) {
         XEvent xevent;
         XNextEvent(display_, &xevent);
         
         // Handle the X11 event
         handle_x11_event(xevent);
         
-        // Convert to SRDWM events (simplified for now)
+        if (xevent.type == KeyPress || xevent.type == KeyRelease) {
+            // handle_key_press/release queued the converted event
+            Event event;
+            event.type = xevent.type == KeyPress ? kKeyPressEvent : kKeyReleaseEvent;
+            event.data = &key_events_.back();
+            event.data_size = sizeof(KeyboardEvent);
+            events.push_back(event);
+        }
+        
+        pending = XEventsQueued(display_, QueuedAfterReading);
+    }
+    
+    // Property refetches whose replies came in with the events
+    apply_property_updates();
+    
+    // Visibility after the whole batch of stacking and geometry changes
+    update_occlusion();
+    
+    // Hotplug arrives as a burst of RandR events; re-read the outputs once
+    if (monitors_dirty_) {
+        monitors_dirty_ = false;
+        monitors_changed_ |= refresh_monitors();
+    }
+    if (monitors_changed_) {
+        work_areas_.set_monitors(get_monitors());
+    }
+    
+    // Struts from this batch of dock maps, unmaps and property changes.
+    // A monitor change carries the new work areas with it.
+    bool work_area_changed = !work_areas_.update().empty();
+    if (work_area_changed) {
+        ewmh_desktop_dirty_ = true;
+    }
+    if (monitors_changed_ || work_area_changed) {
         Event event;
-        event.type = EventType::WindowCreated; // Placeholder
+        event.type = monitors_changed_ ? EventType::MonitorsChanged : EventType::WorkAreaChanged;
         event.data = nullptr;
         event.data_size = 0;
         events.push_back(event);
-        
-        return true;
+        monitors_changed_ = false;
     }
     
-    return false;
+    // A layout switch arrives as a burst of mapping events; refetch once
+    if (keymap_dirty_) {
+        keymap_dirty_ = false;
+        if (keysyms_.rebuild()) {
+            Event event;
+            event.type = EventType::KeymapChanged;
+            event.data = nullptr;
+            event.data_size = 0;
+            events.push_back(event);
+        }
+    }
+    
+    // Clients managed and destroyed during the drain, in that order
+    for (const auto& pending : pending_window_events_) {
+        Event event;
+        event.type = pending.first;
+        event.data = pending.second;
+        event.data_size = sizeof(SRDWindow);
+        events.push_back(event);
+    }
+    pending_window_events_.clear();
+    
+    // Fullscreen changes from client messages, new windows or bindings
+    for (const FullscreenEvent& fullscreen : pending_fullscreen_events_) {
+        fullscreen_events_.push_back(fullscreen);
+        Event event;
+        event.type = EventType::WindowFullscreen;
+        event.data = &fullscreen_events_.back();
+        event.data_size = sizeof(FullscreenEvent);
+        events.push_back(event);
+    }
+    pending_fullscreen_events_.clear();
+    
+    return !events.empty();
+}
+
+void X11Platform::flush() {
+    if (!display_) return;
+    
+    // EWMH properties this iteration changed, one write each at most
+    publish_ewmh();
+    
+    // Composite the damage this iteration produced, then send everything.
+    // XFlush also hands Xlib's own buffer (drawing, compositing) to XCB,
+    // which xcb_flush alone would leave behind.
+    compositor_.paint();
+    XFlush(display_);
+}
+
+void X11Platform::set_window_cache_size(int entries) {
+    decorations_.set_text_cache_size(static_cast<size_t>(std::max(1, entries)));
+}
+
+void X11Platform::flush_if_immediate() {
+    if (immediate_flush_) {
+        flush();
+    }
 }
 
 void X11Platform::process_event(const Event& event) {
@@ -122,32 +263,77 @@ void X11Platform::set_window_position(SRDWindow* window, int x, int y) {
     std::cout << "X11Platform: Set window position to (" << x << "," << y << ")" << std::endl;
     if (!window || !display_) return;
     X11Window x11_window = static_cast<X11Window>(window->getId());
-    XMoveWindow(display_, to_x11_window(x11_window), x, y);
-    XFlush(display_);
+    configured_.erase(x11_window);
+    
+    // A framed client sits at a fixed offset inside its frame; move the frame
+    auto frame_it = frame_window_map_.find(x11_window);
+    if (frame_it != frame_window_map_.end()) {
+        x11_window = frame_it->second;
+    } else if (overlay_titlebar_map_.count(x11_window)) {
+        update_overlay_geometry(window, x, y, window->getWidth());
+    }
+    
+    const uint32_t values[] = {static_cast<uint32_t>(x), static_cast<uint32_t>(y)};
+    xcb_configure_window(conn_, x11_window, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, values);
+    flush_if_immediate();
 }
 
 void X11Platform::set_window_size(SRDWindow* window, int width, int height) {
     std::cout << "X11Platform: Set window size to (" << width << "x" << height << ")" << std::endl;
     if (!window || !display_) return;
     X11Window x11_window = static_cast<X11Window>(window->getId());
-    XResizeWindow(display_, to_x11_window(x11_window), static_cast<unsigned int>(width), static_cast<unsigned int>(height));
-    XFlush(display_);
+    configured_.erase(x11_window);
+    const uint32_t values[] = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+    xcb_configure_window(conn_, x11_window, XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, values);
+    
+    auto frame_it = frame_window_map_.find(x11_window);
+    if (frame_it != frame_window_map_.end()) {
+        const Metrics& metrics = metrics_for(window);
+        const uint32_t frame_values[] = {
+            static_cast<uint32_t>(width + metrics.border_width * 2),
+            static_cast<uint32_t>(height + metrics.border_width + metrics.titlebar_height)
+        };
+        xcb_configure_window(conn_, frame_it->second, XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT,
+                             frame_values);
+        draw_titlebar(window, width + metrics.border_width * 2);
+    } else if (overlay_titlebar_map_.count(x11_window)) {
+        update_overlay_geometry(window, window->getX(), window->getY(), width);
+    }
+    flush_if_immediate();
 }
 
 void X11Platform::set_window_title(SRDWindow* window, const std::string& title) {
     std::cout << "X11Platform: Set window title to '" << title << "'" << std::endl;
     if (!window || !display_) return;
     X11Window x11_window = static_cast<X11Window>(window->getId());
-    XStoreName(display_, to_x11_window(x11_window), title.c_str());
-    XFlush(display_);
+    xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, x11_window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8,
+                        static_cast<uint32_t>(title.size()), title.data());
+    window->setTitle(title);
+    draw_titlebar(window);
+    flush_if_immediate();
 }
 
 void X11Platform::focus_window(SRDWindow* window) {
     std::cout << "X11Platform: Focus window" << std::endl;
     if (!window || !display_) return;
     X11Window x11_window = static_cast<X11Window>(window->getId());
-    XSetInputFocus(display_, to_x11_window(x11_window), RevertToParent, CurrentTime);
-    XFlush(display_);
+    xcb_set_input_focus(conn_, XCB_INPUT_FOCUS_PARENT, x11_window, XCB_CURRENT_TIME);
+    
+    // Only the two titlebars whose focus state changed are re-rendered
+    SRDWindow* previous = get_focused_window();
+    focused_client_ = x11_window;
+    ewmh_active_dirty_ = true;
+    if (previous && previous != window) {
+        if (frameless_ && decorations_enabled_) {
+            apply_native_border(static_cast<X11Window>(previous->getId()), false);
+        }
+        draw_titlebar(previous);
+    }
+    if (frameless_ && decorations_enabled_) {
+        apply_native_border(x11_window, true);
+    }
+    draw_titlebar(window);
+    flush_if_immediate();
 }
 
 void X11Platform::minimize_window(SRDWindow* window) {
@@ -162,30 +348,28 @@ void X11Platform::close_window(SRDWindow* window) {
     std::cout << "X11Platform: Close window" << std::endl;
     if (!window || !display_) return;
     X11Window x11_window = static_cast<X11Window>(window->getId());
-    Atom wm_delete = XInternAtom(display_, "WM_DELETE_WINDOW", False);
-    if (wm_delete != None) {
-        XEvent ev{};
-        ev.xclient.type = ClientMessage;
-        ev.xclient.message_type = XInternAtom(display_, "WM_PROTOCOLS", False);
-        ev.xclient.display = display_;
-        ev.xclient.window = to_x11_window(x11_window);
-        ev.xclient.format = 32;
-        ev.xclient.data.l[0] = wm_delete;
-        ev.xclient.data.l[1] = CurrentTime;
-        XSendEvent(display_, to_x11_window(x11_window), False, NoEventMask, &ev);
-        XFlush(display_);
+    
+    // Ask politely if the client speaks WM_DELETE_WINDOW, otherwise kill it.
+    // Both the atoms and the client's protocols are already known locally.
+    const X11ClientProperties* props = property_cache_.find(x11_window);
+    if (props && props->supports_protocol(atoms_[X11Atom::WM_DELETE_WINDOW])) {
+        xcb_client_message_event_t ev{};
+        ev.response_type = XCB_CLIENT_MESSAGE;
+        ev.format = 32;
+        ev.window = x11_window;
+        ev.type = atoms_[X11Atom::WM_PROTOCOLS];
+        ev.data.data32[0] = atoms_[X11Atom::WM_DELETE_WINDOW];
+        ev.data.data32[1] = XCB_CURRENT_TIME;
+        xcb_send_event(conn_, 0, x11_window, XCB_EVENT_MASK_NO_EVENT, reinterpret_cast<const char*>(&ev));
     } else {
-        XDestroyWindow(display_, to_x11_window(x11_window));
-        XFlush(display_);
+        xcb_kill_client(conn_, x11_window);
     }
+    flush_if_immediate();
 }
 
 // EWMH (Extended Window Manager Hints) support implementation
 void X11Platform::set_ewmh_supported(bool supported) {
-    ewmh_supported_ = supported;
-    if (supported) {
-        setup_ewmh();
-    }
+    ewmh_supported_ = supported && setup_ewmh();
     std::cout << "X11Platform: EWMH support " << (supported ? "enabled" : "disabled") << std::endl;
 }
 
@@ -193,26 +377,26 @@ void X11Platform::set_window_type(SRDWindow* window, const std::string& type) {
     if (!ewmh_supported_ || !window) return;
     
     X11Window x11_window = static_cast<X11Window>(window->getId());
-    Atom window_type_atom = None;
-    
-    if (type == "desktop") window_type_atom = _NET_WM_WINDOW_TYPE_DESKTOP_;
-    else if (type == "dock") window_type_atom = _NET_WM_WINDOW_TYPE_DOCK_;
-    else if (type == "toolbar") window_type_atom = _NET_WM_WINDOW_TYPE_TOOLBAR_;
-    else if (type == "menu") window_type_atom = _NET_WM_WINDOW_TYPE_MENU_;
-    else if (type == "utility") window_type_atom = _NET_WM_WINDOW_TYPE_UTILITY_;
-    else if (type == "splash") window_type_atom = _NET_WM_WINDOW_TYPE_SPLASH_;
-    else if (type == "dialog") window_type_atom = _NET_WM_WINDOW_TYPE_DIALOG_;
-    else if (type == "dropdown_menu") window_type_atom = _NET_WM_WINDOW_TYPE_DROPDOWN_MENU_;
-    else if (type == "popup_menu") window_type_atom = _NET_WM_WINDOW_TYPE_POPUP_MENU_;
-    else if (type == "tooltip") window_type_atom = _NET_WM_WINDOW_TYPE_TOOLTIP_;
-    else if (type == "notification") window_type_atom = _NET_WM_WINDOW_TYPE_NOTIFICATION_;
-    else if (type == "combo") window_type_atom = _NET_WM_WINDOW_TYPE_COMBO_;
-    else if (type == "dnd") window_type_atom = _NET_WM_WINDOW_TYPE_DND_;
-    else window_type_atom = _NET_WM_WINDOW_TYPE_NORMAL_;
-    
-    if (window_type_atom != None) {
-        XChangeProperty(display_, x11_window, _NET_WM_WINDOW_TYPE_, XA_ATOM, 32,
-                       PropModeReplace, (unsigned char*)&window_type_atom, 1);
+    X11Atom window_type = X11Atom::NET_WM_WINDOW_TYPE_NORMAL;
+    
+    if (type == "desktop") window_type = X11Atom::NET_WM_WINDOW_TYPE_DESKTOP;
+    else if (type == "dock") window_type = X11Atom::NET_WM_WINDOW_TYPE_DOCK;
+    else if (type == "toolbar") window_type = X11Atom::NET_WM_WINDOW_TYPE_TOOLBAR;
+    else if (type == "menu") window_type = X11Atom::NET_WM_WINDOW_TYPE_MENU;
+    else if (type == "utility") window_type = X11Atom::NET_WM_WINDOW_TYPE_UTILITY;
+    else if (type == "splash") window_type = X11Atom::NET_WM_WINDOW_TYPE_SPLASH;
+    else if (type == "dialog") window_type = X11Atom::NET_WM_WINDOW_TYPE_DIALOG;
+    else if (type == "dropdown_menu") window_type = X11Atom::NET_WM_WINDOW_TYPE_DROPDOWN_MENU;
+    else if (type == "popup_menu") window_type = X11Atom::NET_WM_WINDOW_TYPE_POPUP_MENU;
+    else if (type == "tooltip") window_type = X11Atom::NET_WM_WINDOW_TYPE_TOOLTIP;
+    else if (type == "notification") window_type = X11Atom::NET_WM_WINDOW_TYPE_NOTIFICATION;
+    else if (type == "combo") window_type = X11Atom::NET_WM_WINDOW_TYPE_COMBO;
+    else if (type == "dnd") window_type = X11Atom::NET_WM_WINDOW_TYPE_DND;
+    
+    xcb_atom_t window_type_atom = atoms_[window_type];
+    if (window_type_atom != XCB_ATOM_NONE) {
+        xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, x11_window, atoms_[X11Atom::NET_WM_WINDOW_TYPE],
+                            XCB_ATOM_ATOM, 32, 1, &window_type_atom);
     }
 }
 
@@ -220,24 +404,25 @@ void X11Platform::set_window_state(SRDWindow* window, const std::vector<std::str
     if (!ewmh_supported_ || !window) return;
     
     X11Window x11_window = static_cast<X11Window>(window->getId());
-    std::vector<Atom> state_atoms;
+    std::vector<xcb_atom_t> state_atoms;
     
     for (const auto& state : states) {
-        Atom state_atom = None;
-        if (state == "maximized_vert") state_atom = _NET_WM_STATE_MAXIMIZED_VERT_;
-        else if (state == "maximized_horz") state_atom = _NET_WM_STATE_MAXIMIZED_HORZ_;
-        else if (state == "fullscreen") state_atom = _NET_WM_STATE_FULLSCREEN_;
-        else if (state == "above") state_atom = _NET_WM_STATE_ABOVE_;
-        else if (state == "below") state_atom = _NET_WM_STATE_BELOW_;
+        xcb_atom_t state_atom = XCB_ATOM_NONE;
+        if (state == "maximized_vert") state_atom = atoms_[X11Atom::NET_WM_STATE_MAXIMIZED_VERT];
+        else if (state == "maximized_horz") state_atom = atoms_[X11Atom::NET_WM_STATE_MAXIMIZED_HORZ];
+        else if (state == "fullscreen") state_atom = atoms_[X11Atom::NET_WM_STATE_FULLSCREEN];
+        else if (state == "above") state_atom = atoms_[X11Atom::NET_WM_STATE_ABOVE];
+        else if (state == "below") state_atom = atoms_[X11Atom::NET_WM_STATE_BELOW];
+        else if (state == "hidden") state_atom = atoms_[X11Atom::NET_WM_STATE_HIDDEN];
         
-        if (state_atom != None) {
+        if (state_atom != XCB_ATOM_NONE) {
             state_atoms.push_back(state_atom);
         }
     }
     
     if (!state_atoms.empty()) {
-        XChangeProperty(display_, x11_window, _NET_WM_STATE_, XA_ATOM, 32,
-                       PropModeReplace, (unsigned char*)state_atoms.data(), state_atoms.size());
+        xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, x11_window, atoms_[X11Atom::NET_WM_STATE],
+                            XCB_ATOM_ATOM, 32, static_cast<uint32_t>(state_atoms.size()), state_atoms.data());
     }
 }
 
@@ -245,10 +430,14 @@ void X11Platform::set_window_strut(SRDWindow* window, int left, int right, int t
     if (!ewmh_supported_ || !window) return;
     
     X11Window x11_window = static_cast<X11Window>(window->getId());
-    long strut[12] = {left, right, top, bottom, 0, 0, 0, 0, 0, 0, 0, 0};
+    const uint32_t strut[12] = {
+        static_cast<uint32_t>(left), static_cast<uint32_t>(right),
+        static_cast<uint32_t>(top), static_cast<uint32_t>(bottom),
+        0, 0, 0, 0, 0, 0, 0, 0
+    };
     
-    XChangeProperty(display_, x11_window, XInternAtom(display_, "_NET_WM_STRUT_PARTIAL", False),
-                   XA_CARDINAL, 32, PropModeReplace, (unsigned char*)strut, 12);
+    xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, x11_window, atoms_[X11Atom::NET_WM_STRUT_PARTIAL],
+                        XCB_ATOM_CARDINAL, 32, 12, strut);
 }
 
 // Virtual Desktop support implementation
@@ -257,6 +446,8 @@ void X11Platform::create_virtual_desktop(const std::string& name) {
     
     int desktop_id = virtual_desktops_.size();
     virtual_desktops_.push_back(desktop_id);
+    desktop_names_.resize(virtual_desktops_.size());
+    desktop_names_.back() = name;
     
     // Update EWMH desktop info
     update_ewmh_desktop_info();
@@ -269,6 +460,10 @@ void X11Platform::remove_virtual_desktop(int desktop_id) {
     
     auto it = std::find(virtual_desktops_.begin(), virtual_desktops_.end(), desktop_id);
     if (it != virtual_desktops_.end()) {
+        size_t index = static_cast<size_t>(it - virtual_desktops_.begin());
+        if (index < desktop_names_.size()) {
+            desktop_names_.erase(desktop_names_.begin() + static_cast<std::ptrdiff_t>(index));
+        }
         virtual_desktops_.erase(it);
         
         // If removing current desktop, switch to first available
@@ -287,10 +482,7 @@ void X11Platform::switch_to_virtual_desktop(int desktop_id) {
     auto it = std::find(virtual_desktops_.begin(), virtual_desktops_.end(), desktop_id);
     if (it != virtual_desktops_.end()) {
         current_virtual_desktop_ = desktop_id;
-        
-        // Update EWMH current desktop
-        XChangeProperty(display_, root_, _NET_CURRENT_DESKTOP_, XA_CARDINAL, 32,
-                       PropModeReplace, (unsigned char*)&current_virtual_desktop_, 1);
+        update_ewmh_desktop_info();
         
         std::cout << "X11Platform: Switched to virtual desktop " << desktop_id << std::endl;
     }
@@ -307,30 +499,55 @@ std::vector<int> X11Platform::get_virtual_desktops() const {
 void X11Platform::move_window_to_desktop(SRDWindow* window, int desktop_id) {
     if (!ewmh_supported_ || !window) return;
     
-    X11Window x11_window = static_cast<X11Window>(window->getId());
-    XChangeProperty(display_, x11_window, _NET_WM_DESKTOP_, XA_CARDINAL, 32,
-                   PropModeReplace, (unsigned char*)&desktop_id, 1);
+    // Published with the client lists at the end of the iteration
+    client_desktops_[static_cast<X11Window>(window->getId())] = desktop_id;
+    ewmh_clients_dirty_ = true;
     
     std::cout << "X11Platform: Moved window " << window->getId() << " to desktop " << desktop_id << std::endl;
 }
 
+// The window manager's workspaces are the EWMH desktops
+void X11Platform::set_workspaces(const std::vector<std::string>& names, int current) {
+    virtual_desktops_.resize(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        virtual_desktops_[i] = static_cast<int>(i);
+    }
+    desktop_names_ = names;
+    current_virtual_desktop_ = current;
+    update_ewmh_desktop_info();
+}
+
 std::vector<Monitor> X11Platform::get_monitors() {
-    std::cout << "X11Platform: Get monitors called" << std::endl;
-    // Return a default monitor for now
-    return {Monitor{0, 0, 0, 1920, 1080}};
+    // Without RandR, a default monitor
+    if (monitors_.empty()) {
+        return {Monitor{0, 0, 0, 1920, 1080}};
+    }
+    return monitors_;
 }
 
 Monitor X11Platform::get_primary_monitor() {
-    std::cout << "X11Platform: Get primary monitor called" << std::endl;
-    return Monitor{0, 0, 0, 1920, 1080};
+    return get_monitors().front();
 }
 
+std::vector<Monitor> X11Platform::get_work_areas() {
+    if (work_areas_.empty()) return get_monitors();
+    return work_areas_.areas();
+}
+
+// Active grab for the duration of a key sequence or mode. Nothing waits
+// for the reply: if another client holds the keyboard the keys simply
+// keep going to it and the sequence times out.
 void X11Platform::grab_keyboard() {
-    std::cout << "X11Platform: Grab keyboard called" << std::endl;
+    if (!display_) return;
+    xcb_discard_reply(conn_, xcb_grab_keyboard(conn_, 1, root_, XCB_CURRENT_TIME,
+                                               XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC).sequence);
+    flush_if_immediate();
 }
 
 void X11Platform::ungrab_keyboard() {
-    std::cout << "X11Platform: Ungrab keyboard called" << std::endl;
+    if (!display_) return;
+    xcb_ungrab_keyboard(conn_, XCB_CURRENT_TIME);
+    flush_if_immediate();
 }
 
 void X11Platform::grab_pointer() {
@@ -345,23 +562,31 @@ void X11Platform::ungrab_pointer() {
 
 void X11Platform::setup_extensions() {
     std::cout << "X11Platform: Setup extensions called" << std::endl;
+    
+    // Core MappingNotify is always delivered; XKB adds a notification for
+    // a different keyboard (layout switch, device hotplug)
+    int opcode, error_base;
+    int major = XkbMajorVersion;
+    int minor = XkbMinorVersion;
+    if (XkbQueryExtension(display_, &opcode, &xkb_event_base_, &error_base, &major, &minor)) {
+        XkbSelectEvents(display_, XkbUseCoreKbd, XkbNewKeyboardNotifyMask, XkbNewKeyboardNotifyMask);
+    } else {
+        xkb_event_base_ = -1;
+    }
+    
+    // Outputs and their geometry, kept up to date across hotplug
+    enable_randr(true);
 }
 
 bool X11Platform::check_for_other_wm() {
-    // Try to select SubstructureRedirectMask on root window
-    // If another WM is running, this will fail
-    XSelectInput(display_, root_, SubstructureRedirectMask);
-    XSync(display_, False);
-    
-    // Check if the selection was successful
-    XErrorHandler old_handler = XSetErrorHandler([](Display*, XErrorEvent*) -> int {
-        return 0; // Ignore errors
-    });
-    
-    XSync(display_, False);
-    XSetErrorHandler(old_handler);
+    // Only one client may select SubstructureRedirect on the root window.
+    // A checked request reports BadAccess directly, without an XSync and
+    // without going through the global Xlib error handler.
+    const uint32_t mask = XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT;
+    xcb_void_cookie_t cookie = xcb_change_window_attributes_checked(conn_, root_, XCB_CW_EVENT_MASK, &mask);
+    XcbReply<xcb_generic_error_t> error = xcb_take(xcb_request_check(conn_, cookie));
     
-    return true; // Simplified check
+    return !error;
 }
 
 bool X11Platform::setup_x11_environment() {
@@ -399,13 +624,33 @@ bool X11Platform::setup_event_masks() {
 void X11Platform::setup_atoms() {
     std::cout << "X11Platform: Setting up atoms..." << std::endl;
     
-    // TODO: Implement atom setup for EWMH/ICCCM
-    // This would involve creating atoms for window manager protocols
+    // One InternAtom sweep for the whole table; everything afterwards is
+    // an indexed lookup
+    if (!atoms_.intern_all(conn_)) {
+        std::cerr << "X11Platform: Some atoms could not be interned" << std::endl;
+    }
+    
+    // Property atoms the manage pipeline reads that are not predefined
+    property_cache_.set_atom(X11ClientProperty::NetWmName, atoms_[X11Atom::NET_WM_NAME]);
+    property_cache_.set_atom(X11ClientProperty::NetWmWindowType, atoms_[X11Atom::NET_WM_WINDOW_TYPE]);
+    property_cache_.set_atom(X11ClientProperty::NetWmState, atoms_[X11Atom::NET_WM_STATE]);
+    property_cache_.set_atom(X11ClientProperty::WmProtocols, atoms_[X11Atom::WM_PROTOCOLS]);
+    property_cache_.set_atom(X11ClientProperty::NetWmPid, atoms_[X11Atom::NET_WM_PID]);
+    property_cache_.set_atom(X11ClientProperty::NetWmStrut, atoms_[X11Atom::NET_WM_STRUT]);
+    property_cache_.set_atom(X11ClientProperty::NetWmStrutPartial, atoms_[X11Atom::NET_WM_STRUT_PARTIAL]);
 }
 
 void X11Platform::handle_x11_event(XEvent& event) {
     std::cout << "X11Platform: Handle X11 event called" << std::endl;
     
+    // The compositor follows stacking and geometry from the same
+    // substructure events; damage notifications are only for it
+    if (compositor_.active() && compositor_.handle_event(event)) {
+        return;
+    }
+    
+    track_stacking(event);
+    
     switch (event.type) {
         case MapRequest:
             handle_map_request(event.xmaprequest);
@@ -422,13 +667,36 @@ void X11Platform::handle_x11_event(XEvent& event) {
         case KeyPress:
             handle_key_press(event.xkey);
             break;
+        case KeyRelease:
+            handle_key_release(event.xkey);
+            break;
         case ButtonPress:
             handle_button_press(event.xbutton);
             break;
         case MotionNotify:
             handle_motion_notify(event.xmotion);
             break;
+        case Expose:
+            handle_expose(event.xexpose);
+            break;
+        case PropertyNotify:
+            handle_property_notify(event.xproperty);
+            break;
+        case MappingNotify:
+            handle_mapping_notify(event.xmapping);
+            break;
+        case ClientMessage:
+            handle_ewmh_message(event.xclient);
+            break;
         default:
+            if (xkb_event_base_ >= 0 && event.type == xkb_event_base_ &&
+                reinterpret_cast<XkbAnyEvent&>(event).xkb_type == XkbNewKeyboardNotify) {
+                keymap_dirty_ = true;
+            } else if (randr_event_base_ >= 0 && (event.type == randr_event_base_ + RRScreenChangeNotify ||
+                                                  event.type == randr_event_base_ + RRNotify)) {
+                XRRUpdateConfiguration(&event);
+                monitors_dirty_ = true;
+            }
             break;
     }
 }
@@ -436,25 +704,171 @@ void X11Platform::handle_x11_event(XEvent& event) {
 void X11Platform::handle_map_request(XMapRequestEvent& event) {
     std::cout << "X11Platform: Map request for window " << static_cast<unsigned long>(event.window) << std::endl;
     
-    // Create a SRDWindow object for this X11 window
-    auto window = std::make_unique<SRDWindow>(static_cast<int>(static_cast<unsigned long>(event.window)), "X11 Window");
+    X11Window client_window = from_x11_window(event.window);
     
-    // Add to window map
-    window_map_[from_x11_window(event.window)] = window.get();
-    window.release();
+    // Already managed: the client is just remapping itself
+    if (window_map_.find(client_window) != window_map_.end() || docks_.count(client_window)) {
+        xcb_map_window(conn_, client_window);
+        return;
+    }
+    
+    // Issue every query for the new client before waiting on any reply,
+    // so all of them share a single round-trip
+    SRDWindow* managed = finish_manage(request_manage(client_window));
+    if (!managed) {
+        return;
+    }
+    pending_window_events_.emplace_back(EventType::WindowCreated, managed);
     
     // Map the window
-    XMapWindow(display_, event.window);
+    xcb_map_window(conn_, client_window);
+}
+
+X11Platform::PendingManage X11Platform::request_manage(X11Window window) {
+    PendingManage pending;
+    pending.window = window;
+    pending.attributes = xcb_get_window_attributes_unchecked(conn_, window);
+    pending.geometry = xcb_get_geometry_unchecked(conn_, window);
+    pending.properties = property_cache_.request(conn_, window);
+    return pending;
+}
+
+SRDWindow* X11Platform::finish_manage(const PendingManage& pending, bool require_viewable) {
+    auto attr = xcb_take(xcb_get_window_attributes_reply(conn_, pending.attributes, nullptr));
+    auto geom = xcb_take(xcb_get_geometry_reply(conn_, pending.geometry, nullptr));
+    const X11ClientProperties& props = property_cache_.collect(conn_, pending.properties);
+    
+    // The window went away before we got to it, or asked not to be managed.
+    // When adopting, windows that are not on screen are left alone.
+    if (!attr || !geom || attr->override_redirect ||
+        (require_viewable && attr->map_state != XCB_MAP_STATE_VIEWABLE)) {
+        property_cache_.erase(pending.window);
+        return nullptr;
+    }
+    
+    // From here on the property cache follows the client via PropertyNotify
+    const uint32_t client_mask[] = {XCB_EVENT_MASK_PROPERTY_CHANGE};
+    xcb_change_window_attributes(conn_, pending.window, XCB_CW_EVENT_MASK, client_mask);
+    
+    if (props.has_window_type(atoms_[X11Atom::NET_WM_WINDOW_TYPE_DOCK])) {
+        manage_dock(pending.window, props, attr->map_state == XCB_MAP_STATE_VIEWABLE);
+        return nullptr;
+    }
     
-    // Apply decorations if enabled
+    std::string title = props.title();
+    if (title.empty()) title = "X11 Window";
+    
+    // Create a SRDWindow object for this X11 window
+    auto window = std::make_unique<SRDWindow>(static_cast<int>(pending.window), title);
+    window->setGeometry(geom->x, geom->y, geom->width, geom->height);
+    
+    // Add to window map
+    window_map_[pending.window] = window.get();
+    SRDWindow* managed = window.release();
+    client_order_.push_back(pending.window);
+    ewmh_clients_dirty_ = true;
+    ewmh_stacking_dirty_ = true;
+    
+    // Apply decorations if enabled. Frameless mode only sets the native
+    // border: no frame window, no reparent, no extra map.
     if (decorations_enabled_) {
-        create_frame_window(window_map_[from_x11_window(event.window)]);
+        if (frameless_) {
+            apply_native_border(pending.window, false);
+        } else {
+            create_frame_window(managed);
+        }
     }
+    
+    write_wm_state(pending.window, NormalState);
+    configured_[pending.window] = {geom->x, geom->y, geom->width, geom->height};
+    
+    // The frame, or the client itself, is what takes part in stacking
+    X11Window toplevel = toplevel_window(pending.window);
+    occlusion_.add(toplevel);
+    if (toplevel == pending.window) {
+        const int border = frameless_ && decorations_enabled_ ? metrics_for(managed).border_width : geom->border_width;
+        occlusion_.set_geometry(toplevel, {geom->x, geom->y, geom->width + 2 * border, geom->height + 2 * border});
+        occlusion_.set_mapped(toplevel, attr->map_state == XCB_MAP_STATE_VIEWABLE);
+    }
+    occlusion_.set_tracked(toplevel, true);
+    
+    // Clients may ask for fullscreen before mapping by setting the state
+    if (props.has_state(atoms_[X11Atom::NET_WM_STATE_FULLSCREEN])) {
+        set_window_fullscreen(managed, true);
+    }
+    
+    return managed;
+}
+
+std::vector<SRDWindow*> X11Platform::adopt_existing_windows() {
+    std::vector<SRDWindow*> adopted;
+    if (!display_) return adopted;
+    
+    auto tree = xcb_take(xcb_query_tree_reply(conn_, xcb_query_tree(conn_, root_), nullptr));
+    if (!tree) return adopted;
+    
+    const xcb_window_t* children = xcb_query_tree_children(tree.get());
+    int count = xcb_query_tree_children_length(tree.get());
+    
+    // Our own frames and titlebars are root children too
+    std::set<X11Window> decorations;
+    for (const auto& pair : frame_window_map_) decorations.insert(pair.second);
+    for (const auto& pair : overlay_titlebar_map_) decorations.insert(pair.second);
+    
+    // Queue the queries for every child before collecting any reply, so
+    // the whole tree is adopted in one round-trip
+    std::vector<PendingManage> pending;
+    pending.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        X11Window child = children[i];
+        occlusion_.add(child); // Children come bottom to top
+        if (window_map_.count(child) || decorations.count(child)) continue;
+        pending.push_back(request_manage(child));
+    }
+    
+    for (const PendingManage& p : pending) {
+        if (SRDWindow* managed = finish_manage(p, true)) {
+            adopted.push_back(managed);
+        }
+    }
+    
+    std::cout << "X11Platform: Adopted " << adopted.size() << " of " << count << " existing windows" << std::endl;
+    return adopted;
 }
 
 void X11Platform::handle_configure_request(XConfigureRequestEvent& event) {
     std::cout << "X11Platform: Configure request for window " << static_cast<unsigned long>(event.window) << std::endl;
     
+    // A tiled (or fullscreen) client keeps the geometry we gave it; tell
+    // it so with a synthetic ConfigureNotify, as ICCCM asks
+    X11Window client = from_x11_window(event.window);
+    auto managed = window_map_.find(client);
+    if (managed != window_map_.end() && !floating_.count(client)) {
+        SRDWindow* window = managed->second;
+        int x = window->getX(), y = window->getY();
+        if (toplevel_window(client) != client) {
+            const Metrics& metrics = metrics_for(window);
+            x += metrics.border_width;
+            y += metrics.titlebar_height;
+        }
+        // xcb_send_event always sends 32 bytes; the event struct is shorter
+        alignas(xcb_configure_notify_event_t) char buffer[32] = {};
+        auto* notify = reinterpret_cast<xcb_configure_notify_event_t*>(buffer);
+        notify->response_type = XCB_CONFIGURE_NOTIFY;
+        notify->event = client;
+        notify->window = client;
+        notify->above_sibling = XCB_WINDOW_NONE;
+        notify->x = static_cast<int16_t>(x);
+        notify->y = static_cast<int16_t>(y);
+        notify->width = static_cast<uint16_t>(std::max(1, window->getWidth()));
+        notify->height = static_cast<uint16_t>(std::max(1, window->getHeight()));
+        xcb_send_event(conn_, 0, client, XCB_EVENT_MASK_STRUCTURE_NOTIFY, buffer);
+        return;
+    }
+    
+    // Granted as asked: whatever we last sent no longer holds
+    configured_.erase(client);
+    
     XWindowChanges changes;
     changes.x = event.x;
     changes.y = event.y;
@@ -470,24 +884,298 @@ void X11Platform::handle_configure_request(XConfigureRequestEvent& event) {
 void X11Platform::handle_destroy_notify(XDestroyWindowEvent& event) {
     std::cout << "X11Platform: Destroy notify for window " << static_cast<unsigned long>(event.window) << std::endl;
     
+    end_fullscreen(from_x11_window(event.window), false);
+    deferred_titlebars_.erase(from_x11_window(event.window));
+    occluded_.erase(from_x11_window(event.window));
+    iconic_.erase(from_x11_window(event.window));
+    expected_unmaps_.erase(from_x11_window(event.window));
+    configured_.erase(from_x11_window(event.window));
+    floating_.erase(from_x11_window(event.window));
+    decoration_scale_.erase(from_x11_window(event.window));
+    unmanage_dock(from_x11_window(event.window));
+    
+    // The client is gone; its frame (or overlay titlebar) goes with it
+    release_frame(from_x11_window(event.window), false);
+    destroy_overlay_titlebar(from_x11_window(event.window));
+    
     auto it = window_map_.find(from_x11_window(event.window));
     if (it != window_map_.end()) {
-        destroy_window(it->second);
+        // The window manager drops the window and deletes it
+        pending_window_events_.emplace_back(EventType::WindowDestroyed, it->second);
         window_map_.erase(it);
+        client_order_.erase(std::remove(client_order_.begin(), client_order_.end(), from_x11_window(event.window)),
+                            client_order_.end());
+        ewmh_clients_dirty_ = true;
+        ewmh_stacking_dirty_ = true;
+    }
+    client_desktops_.erase(from_x11_window(event.window));
+    forget_published(from_x11_window(event.window));
+    
+    property_cache_.erase(from_x11_window(event.window));
+    
+    if (focused_client_ == from_x11_window(event.window)) {
+        focused_client_ = 0;
+        ewmh_active_dirty_ = true;
     }
 }
 
 void X11Platform::handle_unmap_notify(XUnmapEvent& event) {
     std::cout << "X11Platform: Unmap notify for window " << static_cast<unsigned long>(event.window) << std::endl;
     
-    // Handle window unmapping
+    // Our own unmaps (workspace switches) are not the client withdrawing
+    auto expected = expected_unmaps_.find(from_x11_window(event.window));
+    if (expected != expected_unmaps_.end()) {
+        if (--expected->second == 0) expected_unmaps_.erase(expected);
+        return;
+    }
+    
+    // A withdrawn window gives up fullscreen; its geometry no longer matters
+    end_fullscreen(from_x11_window(event.window), false);
+    
+    // A hidden dock reserves nothing; it is managed afresh when remapped
+    unmanage_dock(from_x11_window(event.window));
+}
+
+// Follow the root's children from SubstructureNotify. Windows below root
+// (clients inside frames) never occlude anything on their own.
+void X11Platform::track_stacking(const XEvent& event) {
+    switch (event.type) {
+        case CreateNotify: {
+            const XCreateWindowEvent& e = event.xcreatewindow;
+            if (e.parent != root_) break;
+            occlusion_.add(from_x11_window(e.window));
+            occlusion_.set_geometry(from_x11_window(e.window),
+                                    {e.x, e.y, e.width + 2 * e.border_width, e.height + 2 * e.border_width});
+            break;
+        }
+        case ConfigureNotify: {
+            const XConfigureEvent& e = event.xconfigure;
+            if (e.event != root_ || e.window == root_) break;
+            occlusion_.set_geometry(from_x11_window(e.window),
+                                    {e.x, e.y, e.width + 2 * e.border_width, e.height + 2 * e.border_width});
+            if (occlusion_.restack(from_x11_window(e.window), from_x11_window(e.above))) {
+                ewmh_stacking_dirty_ = true;
+            }
+            break;
+        }
+        case MapNotify:
+            if (event.xmap.event != root_) break;
+            occlusion_.set_mapped(from_x11_window(event.xmap.window), true);
+            ewmh_stacking_dirty_ = true;
+            break;
+        case UnmapNotify:
+            if (event.xunmap.event != root_) break;
+            occlusion_.set_mapped(from_x11_window(event.xunmap.window), false);
+            ewmh_stacking_dirty_ = true;
+            break;
+        case CirculateNotify: {
+            X11Window window = from_x11_window(event.xcirculate.window);
+            bool moved = event.xcirculate.place == PlaceOnTop ? occlusion_.raise(window) : occlusion_.restack(window, 0);
+            if (moved) ewmh_stacking_dirty_ = true;
+            break;
+        }
+        case ReparentNotify:
+            // Geometry follows with the next ConfigureNotify
+            if (event.xreparent.parent == root_) {
+                occlusion_.add(from_x11_window(event.xreparent.window));
+            } else {
+                occlusion_.remove(from_x11_window(event.xreparent.window));
+            }
+            ewmh_stacking_dirty_ = true;
+            break;
+        case DestroyNotify:
+            occlusion_.remove(from_x11_window(event.xdestroywindow.window));
+            ewmh_stacking_dirty_ = true;
+            break;
+        default:
+            break;
+    }
+}
+
+void X11Platform::update_occlusion() {
+    bool uncovered = false;
+    for (const OcclusionTracker::Change& change : occlusion_.update()) {
+        // Changes are for frames; the state belongs on the client
+        X11Window client = static_cast<X11Window>(change.id);
+        if (!window_map_.count(client)) {
+            auto frame = frame_clients_.find(client);
+            if (frame == frame_clients_.end()) continue;
+            client = frame->second;
+        }
+        
+        if (change.visible) {
+            occluded_.erase(client);
+            uncovered = true;
+        } else {
+            occluded_.insert(client);
+        }
+        write_net_wm_state(client);
+    }
+    
+    if (uncovered) {
+        resume_deferred_work();
+    }
+}
+
+void X11Platform::handle_expose(XExposeEvent& event) {
+    // Frames repaint from their cached titlebar; nothing is redrawn here.
+    // Wait for the last Expose of the burst, then copy the merged damage.
+    X11Window frame = from_x11_window(event.window);
+    decorations_.add_damage(frame, event.x, event.y, event.width, event.height);
+    if (event.count == 0) {
+        decorations_.repaint_damage(frame);
+    }
+}
+
+void X11Platform::handle_property_notify(XPropertyEvent& event) {
+    X11Window window = from_x11_window(event.window);
+    if (window_map_.find(window) == window_map_.end() && !docks_.count(window)) return;
+    
+    // Refetch only the property that changed; the value is applied once
+    // its reply is in, see apply_property_updates()
+    X11ClientProperty property;
+    if (property_cache_.property_for_atom(static_cast<xcb_atom_t>(event.atom), property)) {
+        property_cache_.invalidate(conn_, window, property);
+    }
+}
+
+// Docks keep their own geometry and stay out of the layout. Their struts
+// take effect with the next work_areas_.update().
+void X11Platform::manage_dock(X11Window dock, const X11ClientProperties& props, bool mapped) {
+    docks_.insert(dock);
+    work_areas_.set_strut(dock, WorkAreaTracker::Strut::from_properties(props.strut_partial, props.strut));
+    if (!mapped) {
+        xcb_map_window(conn_, dock);
+    }
+    std::cout << "X11Platform: Managing dock " << static_cast<unsigned long>(dock) << std::endl;
+}
+
+void X11Platform::unmanage_dock(X11Window dock) {
+    if (!docks_.erase(dock)) return;
+    work_areas_.remove(dock);
+    property_cache_.erase(dock);
+}
+
+void X11Platform::publish_work_area() {
+    if (!display_ || !ewmh_supported_ || work_areas_.empty()) return;
+    
+    std::vector<uint32_t> values = work_areas_.net_workarea(virtual_desktops_.size());
+    publish_property(root_, X11Atom::NET_WORKAREA, XCB_ATOM_CARDINAL, 32, static_cast<uint32_t>(values.size()),
+                     values.data());
+}
+
+void X11Platform::apply_property_updates() {
+    for (xcb_window_t window : property_cache_.poll_updates(conn_)) {
+        auto it = window_map_.find(window);
+        const X11ClientProperties* props = property_cache_.find(window);
+        if (props && docks_.count(window)) {
+            // Applied with the rest of the batch by work_areas_.update()
+            work_areas_.set_strut(window, WorkAreaTracker::Strut::from_properties(props->strut_partial,
+                                                                                  props->strut));
+            continue;
+        }
+        if (it == window_map_.end() || !props) continue;
+        
+        const std::string& title = props->title();
+        if (!title.empty() && title != it->second->getTitle()) {
+            it->second->setTitle(title);
+            draw_titlebar(it->second);
+        }
+    }
 }
 
 void X11Platform::handle_key_press(XKeyEvent& event) {
-    std::cout << "X11Platform: Key press event" << std::endl;
+    // Raw keycode plus neutral modifiers; the window manager's binding
+    // table is keyed on exactly this, so no keysym lookup happens here
+    KeyboardEvent key;
+    key.key_code = static_cast<int>(event.keycode);
+    key.modifiers = static_cast<int>(key_modifiers_from_x(event.state));
+    key.modifier_key = keysyms_.is_modifier(static_cast<xcb_keycode_t>(event.keycode));
+    key.keysym = keysyms_.keysym(static_cast<xcb_keycode_t>(event.keycode), XkbGroupForCoreState(event.state),
+                                 (event.state & ShiftMask) ? 1 : 0);
+    key_events_.push_back(key);
+}
+
+void X11Platform::handle_key_release(XKeyEvent& event) {
+    KeyboardEvent key;
+    key.key_code = static_cast<int>(event.keycode);
+    key.modifiers = static_cast<int>(key_modifiers_from_x(event.state));
+    key_events_.push_back(key);
+}
+
+// NumLock is assumed on Mod2, where every common keymap puts it
+uint32_t X11Platform::key_modifiers_from_x(unsigned int state) {
+    uint32_t modifiers = 0;
+    if (state & ControlMask) modifiers |= KeyMod::Ctrl;
+    if (state & ShiftMask) modifiers |= KeyMod::Shift;
+    if (state & Mod1Mask) modifiers |= KeyMod::Alt;
+    if (state & Mod4Mask) modifiers |= KeyMod::Super;
+    if (state & Mod2Mask) modifiers |= KeyMod::NumLock;
+    if (state & LockMask) modifiers |= KeyMod::CapsLock;
+    return modifiers;
+}
+
+uint16_t X11Platform::key_modifiers_to_x(uint32_t modifiers) {
+    uint16_t state = 0;
+    if (modifiers & KeyMod::Ctrl) state |= XCB_MOD_MASK_CONTROL;
+    if (modifiers & KeyMod::Shift) state |= XCB_MOD_MASK_SHIFT;
+    if (modifiers & KeyMod::Alt) state |= XCB_MOD_MASK_1;
+    if (modifiers & KeyMod::Super) state |= XCB_MOD_MASK_4;
+    if (modifiers & KeyMod::NumLock) state |= XCB_MOD_MASK_2;
+    if (modifiers & KeyMod::CapsLock) state |= XCB_MOD_MASK_LOCK;
+    return state;
+}
+
+std::vector<uint32_t> X11Platform::key_codes_for(const std::string& key_name) {
+    std::vector<uint32_t> codes;
+    if (!display_) return codes;
+    
+    // Name -> keysym is a local table lookup in Xlib; keysym -> keycodes
+    // comes from the cache, so re-resolving after a layout switch is cheap
+    KeySym keysym = XStringToKeysym(key_name.c_str());
+    if (keysym == NoSymbol) return codes;
+    
+    for (xcb_keycode_t code : keysyms_.key_codes(static_cast<xcb_keysym_t>(keysym))) {
+        codes.push_back(code);
+    }
+    return codes;
+}
+
+void X11Platform::grab_keys(const std::vector<KeyGrab>& grabs) {
+    if (!display_) return;
+    
+    // Both lists are sorted; only the difference goes to the server, so a
+    // keymap change that moves a few keys costs a few requests. The first
+    // call clears whatever a previous instance left behind.
+    if (key_grabs_.empty()) {
+        xcb_ungrab_key(conn_, XCB_GRAB_ANY, root_, XCB_MOD_MASK_ANY);
+    }
+    
+    std::vector<KeyGrab> removed;
+    std::vector<KeyGrab> added;
+    std::set_difference(key_grabs_.begin(), key_grabs_.end(), grabs.begin(), grabs.end(),
+                        std::back_inserter(removed));
+    std::set_difference(grabs.begin(), grabs.end(), key_grabs_.begin(), key_grabs_.end(),
+                        std::back_inserter(added));
     
-    // Convert X11 key event to SRDWM event
-    // TODO: Implement key event conversion
+    for (const KeyGrab& grab : removed) {
+        xcb_ungrab_key(conn_, static_cast<xcb_keycode_t>(grab.key_code), root_, key_modifiers_to_x(grab.modifiers));
+    }
+    for (const KeyGrab& grab : added) {
+        xcb_grab_key(conn_, 1, root_, key_modifiers_to_x(grab.modifiers), static_cast<xcb_keycode_t>(grab.key_code),
+                     XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC);
+    }
+    key_grabs_ = grabs;
+    flush_if_immediate();
+}
+
+void X11Platform::handle_mapping_notify(XMappingEvent& event) {
+    if (event.request == MappingPointer) return;
+    
+    // Keep Xlib's own tables (XLookupString etc.) in step; our cache is
+    // rebuilt once after the event drain
+    XRefreshKeyboardMapping(&event);
+    keymap_dirty_ = true;
 }
 
 void X11Platform::handle_button_press(XButtonEvent& event) {
@@ -504,6 +1192,11 @@ void X11Platform::handle_motion_notify(XMotionEvent& event) {
     // TODO: Implement motion event conversion
 }
 
+const X11ClientProperties* X11Platform::get_client_properties(SRDWindow* window) const {
+    if (!window) return nullptr;
+    return property_cache_.find(static_cast<X11Window>(window->getId()));
+}
+
 // Window decoration implementations
 void X11Platform::set_window_decorations(SRDWindow* window, bool enabled) {
     std::cout << "X11Platform: Set window decorations " << (enabled ? "enabled" : "disabled") << std::endl;
@@ -512,7 +1205,15 @@ void X11Platform::set_window_decorations(SRDWindow* window, bool enabled) {
     
     X11Window x11_window = static_cast<X11Window>(window->getId());
     
-    if (enabled) {
+    if (frameless_) {
+        if (enabled) {
+            apply_native_border(x11_window, x11_window == focused_client_);
+        } else {
+            const uint32_t no_border[] = {0};
+            xcb_configure_window(conn_, x11_window, XCB_CONFIG_WINDOW_BORDER_WIDTH, no_border);
+            destroy_overlay_titlebar(x11_window);
+        }
+    } else if (enabled) {
         create_frame_window(window);
     } else {
         destroy_frame_window(window);
@@ -548,6 +1249,7 @@ void X11Platform::set_window_border_width(SRDWindow* window, int width) {
     XSetWindowBorderWidth(display_, to_x11_window(x11_window), width);
     
     border_width_ = width;
+    decorations_.set_border_width(width);
 }
 
 bool X11Platform::get_window_decorations(SRDWindow* window) const {
@@ -555,11 +1257,33 @@ bool X11Platform::get_window_decorations(SRDWindow* window) const {
     
     // Check if window has a frame window
     X11Window x11_window = static_cast<X11Window>(window->getId());
+    if (frameless_) {
+        return decorations_enabled_ && window_map_.count(x11_window) > 0;
+    }
     auto it = frame_window_map_.find(x11_window);
     
     return it != frame_window_map_.end();
 }
 
+void X11Platform::set_window_floating(SRDWindow* window, bool floating) {
+    if (!window) return;
+    if (floating) {
+        floating_.insert(static_cast<X11Window>(window->getId()));
+    } else {
+        floating_.erase(static_cast<X11Window>(window->getId()));
+    }
+    if (!display_ || !frameless_) return;
+    
+    // Tiled windows stay bare in frameless mode; only floating ones get a
+    // titlebar, as a separate override-redirect window above the client
+    if (floating && decorations_enabled_) {
+        create_overlay_titlebar(window);
+    } else {
+        destroy_overlay_titlebar(static_cast<X11Window>(window->getId()));
+    }
+    flush_if_immediate();
+}
+
 void X11Platform::create_frame_window(SRDWindow* window) {
     std::cout << "X11Platform: Create frame window for window " << window->getId() << std::endl;
     
@@ -572,60 +1296,45 @@ void X11Platform::create_frame_window(SRDWindow* window) {
         return;
     }
     
-    // Get client window attributes
-    XWindowAttributes attr;
-    attr.x = 0;
-    attr.y = 0;
-    attr.width = 0;
-    attr.height = 0;
-    attr.border_width = 0;
-    attr.depth = 0;
-    attr.visual = nullptr;
-    attr.root = 0;
-    attr.c_class = 0;
-    attr.bit_gravity = 0;
-    attr.win_gravity = 0;
-    attr.backing_store = 0;
-    attr.backing_planes = 0;
-    attr.backing_pixel = 0;
-    attr.save_under = 0;
-    attr.colormap = 0;
-    attr.map_installed = 0;
-    attr.map_state = 0;
-    attr.all_event_masks = 0;
-    attr.your_event_mask = 0;
-    attr.do_not_propagate_mask = 0;
-    attr.override_redirect = 0;
-    if (XGetWindowAttributes(display_, to_x11_window(client_window), &attr) == 0) {
-        std::cerr << "Failed to get window attributes" << std::endl;
-        return;
-    }
+    // Geometry is already known from the manage pipeline, no query needed
+    int x = window->getX();
+    int y = window->getY();
+    int width = std::max(1, window->getWidth());
+    int height = std::max(1, window->getHeight());
+    const Metrics& metrics = metrics_for(window);
     
     // Create frame window
-    X11Window frame_window = from_x11_window(XCreateSimpleWindow(
-        display_, to_x11_window(root_),
-        attr.x, attr.y,
-        attr.width + border_width_ * 2,
-        attr.height + border_width_ + 30, // Add titlebar height
-        border_width_,
-        border_color_,
-        0x000000 // Background color
-    ));
-    
-    // Set frame window properties
-    XSetWindowAttributes frame_attr;
-    frame_attr.event_mask = ButtonPressMask | ButtonReleaseMask | 
-                           PointerMotionMask | ExposureMask;
-    XChangeWindowAttributes(display_, to_x11_window(frame_window), CWEventMask, &frame_attr);
+    X11Window frame_window = xcb_generate_id(conn_);
+    const uint32_t frame_values[] = {
+        0x000000,     // Background color
+        static_cast<uint32_t>(border_color_),
+        XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE |
+        XCB_EVENT_MASK_POINTER_MOTION | XCB_EVENT_MASK_EXPOSURE |
+        XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY // DestroyNotify for the client inside
+    };
+    xcb_create_window(conn_, XCB_COPY_FROM_PARENT, frame_window, root_,
+                      static_cast<int16_t>(x), static_cast<int16_t>(y),
+                      static_cast<uint16_t>(width + metrics.border_width * 2),
+                      static_cast<uint16_t>(height + metrics.border_width + metrics.titlebar_height),
+                      static_cast<uint16_t>(metrics.border_width),
+                      XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT,
+                      XCB_CW_BACK_PIXEL | XCB_CW_BORDER_PIXEL | XCB_CW_EVENT_MASK, frame_values);
+    
+    // Save-set: if we exit or restart, the server reparents the client back
+    // to the root instead of destroying it along with our frame
+    xcb_change_save_set(conn_, XCB_SET_MODE_INSERT, client_window);
     
     // Reparent client window into frame
-    XReparentWindow(display_, to_x11_window(client_window), to_x11_window(frame_window), border_width_, 30);
+    xcb_reparent_window(conn_, client_window, frame_window, static_cast<int16_t>(metrics.border_width),
+                        static_cast<int16_t>(metrics.titlebar_height));
+    decoration_scale_[client_window] = ScaledMetrics::bucket(window_scale(window));
     
     // Map frame window
-    XMapWindow(display_, to_x11_window(frame_window));
+    xcb_map_window(conn_, frame_window);
     
     // Store frame window mapping
     frame_window_map_[client_window] = frame_window;
+    frame_clients_[frame_window] = client_window;
     
     // Draw titlebar
     draw_titlebar(window);
@@ -638,85 +1347,191 @@ void X11Platform::destroy_frame_window(SRDWindow* window) {
     
     if (!window || !display_) return;
     
-    X11Window client_window = static_cast<X11Window>(window->getId());
-    
-    // Find frame window
-    auto it = frame_window_map_.find(client_window);
-    if (it == frame_window_map_.end()) {
-        return;
+    if (frame_window_map_.count(static_cast<X11Window>(window->getId()))) {
+        release_frame(static_cast<X11Window>(window->getId()), true);
+        std::cout << "X11Platform: Frame window destroyed successfully" << std::endl;
     }
+}
+
+void X11Platform::release_frame(X11Window client, bool reparent) {
+    auto it = frame_window_map_.find(client);
+    if (it == frame_window_map_.end()) return;
     
     X11Window frame_window = it->second;
+    if (reparent) {
+        xcb_reparent_window(conn_, client, root_, 0, 0);
+    }
     
-    // Reparent client window back to root
-    XReparentWindow(display_, to_x11_window(client_window), to_x11_window(root_), 0, 0);
-    
-    // Destroy frame window
-    XDestroyWindow(display_, to_x11_window(frame_window));
-    
-    // Remove from mapping
+    // Destroy frame window and drop its cached titlebar
+    xcb_destroy_window(conn_, frame_window);
+    decorations_.release(frame_window);
+    frame_clients_.erase(frame_window);
     frame_window_map_.erase(it);
-    
-    std::cout << "X11Platform: Frame window destroyed successfully" << std::endl;
 }
 
 void X11Platform::draw_titlebar(SRDWindow* window) {
-    std::cout << "X11Platform: Draw titlebar for window " << window->getId() << std::endl;
-    
+    if (!window) return;
+    draw_titlebar(window, window->getWidth() + metrics_for(window).border_width * 2);
+}
+
+void X11Platform::draw_titlebar(SRDWindow* window, int frame_width) {
     if (!window || !display_) return;
     
     X11Window client_window = static_cast<X11Window>(window->getId());
     
-    // Find frame window
-    auto it = frame_window_map_.find(client_window);
-    if (it == frame_window_map_.end()) {
+    // Frame window, or overlay titlebar in frameless mode
+    X11Window frame_window = titlebar_window(client_window);
+    if (!frame_window) {
         return;
     }
     
-    X11Window frame_window = it->second;
+    // Nobody can see it under a fullscreen or overlapping window; draw it
+    // when it comes back into view
+    if (titlebar_hidden(window)) {
+        deferred_titlebars_.insert(client_window);
+        return;
+    }
     
-    // Get window title
-    char* window_name = nullptr;
-    if (XFetchName(display_, to_x11_window(client_window), &window_name) && window_name) {
-        // Create GC for drawing
-        XGCValues gc_values;
-        gc_values.foreground = 0xFFFFFF; // White text
-        gc_values.background = 0x2E3440; // Dark background
-        gc_values.font = XLoadFont(display_, "fixed");
-        
-        GC gc = XCreateGC(display_, to_x11_window(frame_window), 
-                         GCForeground | GCBackground | GCFont, &gc_values);
-        
-        // Draw titlebar background
-        XSetForeground(display_, gc, 0x2E3440);
-        XFillRectangle(display_, to_x11_window(frame_window), gc, 0, 0, 800, 30); // Placeholder size
-        
-        // Draw title text
-        XSetForeground(display_, gc, 0xFFFFFF);
-        XDrawString(display_, to_x11_window(frame_window), gc, 10, 20, window_name, strlen(window_name));
-        
-        // Clean up
-        XFreeGC(display_, gc);
-        XFree(window_name);
+    // Title was read during manage; drawing never waits on the server.
+    // The cached pixmap is only redrawn when title, focus or width changed.
+    bool focused = client_window == focused_client_;
+    if (decorations_.render(frame_window, window->getTitle(), focused, frame_width, window_scale(window))) {
+        decorations_.blit(frame_window);
+    }
+}
+
+X11Window X11Platform::titlebar_window(X11Window client) const {
+    auto it = frame_window_map_.find(client);
+    if (it != frame_window_map_.end()) {
+        return it->second;
+    }
+    auto overlay = overlay_titlebar_map_.find(client);
+    return overlay != overlay_titlebar_map_.end() ? overlay->second : 0;
+}
+
+void X11Platform::apply_native_border(X11Window client, bool focused) {
+    auto window_it = window_map_.find(client);
+    int border_width = border_width_;
+    if (window_it != window_map_.end()) {
+        border_width = metrics_for(window_it->second).border_width;
+        decoration_scale_[client] = ScaledMetrics::bucket(window_scale(window_it->second));
     }
+    const uint32_t width[] = {static_cast<uint32_t>(border_width)};
+    xcb_configure_window(conn_, client, XCB_CONFIG_WINDOW_BORDER_WIDTH, width);
+    const uint32_t pixel[] = {static_cast<uint32_t>(focused ? focused_border_color_ : border_color_)};
+    xcb_change_window_attributes(conn_, client, XCB_CW_BORDER_PIXEL, pixel);
+}
+
+void X11Platform::create_overlay_titlebar(SRDWindow* window) {
+    X11Window client_window = static_cast<X11Window>(window->getId());
+    if (overlay_titlebar_map_.count(client_window)) {
+        return;
+    }
+    
+    X11Window titlebar = xcb_generate_id(conn_);
+    const uint32_t values[] = {
+        0x000000,     // Background color
+        1,            // Override redirect: we place it ourselves
+        XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE |
+        XCB_EVENT_MASK_POINTER_MOTION | XCB_EVENT_MASK_EXPOSURE
+    };
+    const Metrics& metrics = metrics_for(window);
+    int width = std::max(1, window->getWidth()) + metrics.border_width * 2;
+    xcb_create_window(conn_, XCB_COPY_FROM_PARENT, titlebar, root_,
+                      static_cast<int16_t>(window->getX()),
+                      static_cast<int16_t>(window->getY() - metrics.titlebar_height),
+                      static_cast<uint16_t>(width), static_cast<uint16_t>(metrics.titlebar_height), 0,
+                      XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT,
+                      XCB_CW_BACK_PIXEL | XCB_CW_OVERRIDE_REDIRECT | XCB_CW_EVENT_MASK, values);
+    
+    // Keep it stacked directly above its client
+    const uint32_t stacking[] = {static_cast<uint32_t>(client_window), XCB_STACK_MODE_ABOVE};
+    xcb_configure_window(conn_, titlebar, XCB_CONFIG_WINDOW_SIBLING | XCB_CONFIG_WINDOW_STACK_MODE, stacking);
+    xcb_map_window(conn_, titlebar);
+    
+    overlay_titlebar_map_[client_window] = titlebar;
+    draw_titlebar(window, width);
+}
+
+void X11Platform::destroy_overlay_titlebar(X11Window client) {
+    auto it = overlay_titlebar_map_.find(client);
+    if (it == overlay_titlebar_map_.end()) {
+        return;
+    }
+    
+    xcb_destroy_window(conn_, it->second);
+    decorations_.release(it->second);
+    overlay_titlebar_map_.erase(it);
+}
+
+void X11Platform::update_overlay_geometry(SRDWindow* window, int x, int y, int width) {
+    auto it = overlay_titlebar_map_.find(static_cast<X11Window>(window->getId()));
+    if (it == overlay_titlebar_map_.end()) {
+        return;
+    }
+    
+    const Metrics& metrics = metrics_for(window);
+    int titlebar_width = std::max(1, width) + metrics.border_width * 2;
+    const uint32_t values[] = {
+        static_cast<uint32_t>(x),
+        static_cast<uint32_t>(y - metrics.titlebar_height),
+        static_cast<uint32_t>(titlebar_width),
+        static_cast<uint32_t>(metrics.titlebar_height)
+    };
+    xcb_configure_window(conn_, it->second,
+                         XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
+                         XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, values);
+    draw_titlebar(window, titlebar_width);
 }
 
 void X11Platform::update_frame_geometry(SRDWindow* window) {
-    std::cout << "X11Platform: Update frame geometry" << std::endl;
+    if (!window || !display_) return;
+    
+    X11Window client_window = static_cast<X11Window>(window->getId());
+    auto it = frame_window_map_.find(client_window);
+    if (it == frame_window_map_.end()) {
+        return;
+    }
+    
+    int width = std::max(1, window->getWidth());
+    int height = std::max(1, window->getHeight());
+    const Metrics& metrics = metrics_for(window);
+    
+    // Moved to a monitor with another scale: the client sits below a
+    // titlebar of a different height
+    int bucket = ScaledMetrics::bucket(window_scale(window));
+    int& frame_bucket = decoration_scale_[client_window];
+    if (frame_bucket != bucket) {
+        frame_bucket = bucket;
+        const uint32_t inside[] = {static_cast<uint32_t>(metrics.border_width),
+                                   static_cast<uint32_t>(metrics.titlebar_height)};
+        xcb_configure_window(conn_, client_window, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, inside);
+        const uint32_t border[] = {static_cast<uint32_t>(metrics.border_width)};
+        xcb_configure_window(conn_, it->second, XCB_CONFIG_WINDOW_BORDER_WIDTH, border);
+    }
+    
+    const uint32_t frame_values[] = {
+        static_cast<uint32_t>(window->getX()),
+        static_cast<uint32_t>(window->getY()),
+        static_cast<uint32_t>(width + metrics.border_width * 2),
+        static_cast<uint32_t>(height + metrics.border_width + metrics.titlebar_height)
+    };
+    xcb_configure_window(conn_, it->second,
+                         XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
+                         XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, frame_values);
+    
+    const uint32_t client_values[] = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+    xcb_configure_window(conn_, client_window, XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, client_values);
     
-    // TODO: Implement when X11 headers are available
-    // Update frame window geometry when client window changes
+    draw_titlebar(window, width + metrics.border_width * 2);
 }
 
 SRDWindow* X11Platform::get_focused_window() const {
-    if (!display_) return nullptr;
+    if (!display_ || !focused_client_) return nullptr;
     
-    typedef ::Window X11WindowType;
-    X11WindowType focused_window;
-    int revert_to;
-    XGetInputFocus(display_, &focused_window, &revert_to);
-    
-    auto it = window_map_.find(from_x11_window(focused_window));
+    // Focus only changes through focus_window(), so track it locally
+    // instead of asking the server with GetInputFocus
+    auto it = window_map_.find(focused_client_);
     if (it != window_map_.end()) {
         return it->second;
     }
@@ -725,87 +1540,517 @@ SRDWindow* X11Platform::get_focused_window() const {
 }
 
 // EWMH helper methods
-void X11Platform::setup_ewmh() {
-    if (!display_ || !ewmh_supported_) return;
+bool X11Platform::setup_ewmh() {
+    if (!display_) return false;
     
     // Set EWMH supported atoms
-    Atom supported[] = {
-        _NET_WM_STATE_,
-        _NET_WM_STATE_MAXIMIZED_VERT_,
-        _NET_WM_STATE_MAXIMIZED_HORZ_,
-        _NET_WM_STATE_FULLSCREEN_,
-        _NET_WM_STATE_ABOVE_,
-        _NET_WM_STATE_BELOW_,
-        _NET_WM_WINDOW_TYPE_,
-        _NET_WM_WINDOW_TYPE_DESKTOP_,
-        _NET_WM_WINDOW_TYPE_DOCK_,
-        _NET_WM_WINDOW_TYPE_TOOLBAR_,
-        _NET_WM_WINDOW_TYPE_MENU_,
-        _NET_WM_WINDOW_TYPE_UTILITY_,
-        _NET_WM_WINDOW_TYPE_SPLASH_,
-        _NET_WM_WINDOW_TYPE_DIALOG_,
-        _NET_WM_WINDOW_TYPE_DROPDOWN_MENU_,
-        _NET_WM_WINDOW_TYPE_POPUP_MENU_,
-        _NET_WM_WINDOW_TYPE_TOOLTIP_,
-        _NET_WM_WINDOW_TYPE_NOTIFICATION_,
-        _NET_WM_WINDOW_TYPE_COMBO_,
-        _NET_WM_WINDOW_TYPE_DND_,
-        _NET_WM_WINDOW_TYPE_NORMAL_,
-        _NET_WM_DESKTOP_,
-        _NET_NUMBER_OF_DESKTOPS_,
-        _NET_CURRENT_DESKTOP_,
-        _NET_DESKTOP_NAMES_
+    static const X11Atom supported_atoms[] = {
+        X11Atom::NET_WM_STATE,
+        X11Atom::NET_WM_STATE_MAXIMIZED_VERT,
+        X11Atom::NET_WM_STATE_MAXIMIZED_HORZ,
+        X11Atom::NET_WM_STATE_FULLSCREEN,
+        X11Atom::NET_WM_STATE_ABOVE,
+        X11Atom::NET_WM_STATE_BELOW,
+        X11Atom::NET_WM_STATE_HIDDEN,
+        X11Atom::NET_WM_WINDOW_TYPE,
+        X11Atom::NET_WM_WINDOW_TYPE_DESKTOP,
+        X11Atom::NET_WM_WINDOW_TYPE_DOCK,
+        X11Atom::NET_WM_WINDOW_TYPE_TOOLBAR,
+        X11Atom::NET_WM_WINDOW_TYPE_MENU,
+        X11Atom::NET_WM_WINDOW_TYPE_UTILITY,
+        X11Atom::NET_WM_WINDOW_TYPE_SPLASH,
+        X11Atom::NET_WM_WINDOW_TYPE_DIALOG,
+        X11Atom::NET_WM_WINDOW_TYPE_DROPDOWN_MENU,
+        X11Atom::NET_WM_WINDOW_TYPE_POPUP_MENU,
+        X11Atom::NET_WM_WINDOW_TYPE_TOOLTIP,
+        X11Atom::NET_WM_WINDOW_TYPE_NOTIFICATION,
+        X11Atom::NET_WM_WINDOW_TYPE_COMBO,
+        X11Atom::NET_WM_WINDOW_TYPE_DND,
+        X11Atom::NET_WM_WINDOW_TYPE_NORMAL,
+        X11Atom::NET_WM_DESKTOP,
+        X11Atom::NET_NUMBER_OF_DESKTOPS,
+        X11Atom::NET_CURRENT_DESKTOP,
+        X11Atom::NET_DESKTOP_NAMES,
+        X11Atom::NET_WORKAREA,
+        X11Atom::NET_CLIENT_LIST,
+        X11Atom::NET_CLIENT_LIST_STACKING,
+        X11Atom::NET_ACTIVE_WINDOW,
+        X11Atom::NET_WM_STRUT,
+        X11Atom::NET_WM_STRUT_PARTIAL,
+        X11Atom::NET_SUPPORTING_WM_CHECK
     };
     
-    XChangeProperty(display_, root_, XInternAtom(display_, "_NET_SUPPORTED", False),
-                   XA_ATOM, 32, PropModeReplace, (unsigned char*)supported, 
-                   sizeof(supported) / sizeof(supported[0]));
+    std::vector<xcb_atom_t> supported;
+    for (X11Atom atom : supported_atoms) {
+        supported.push_back(atoms_[atom]);
+    }
     
-    // Set initial desktop info
+    xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, root_, atoms_[X11Atom::NET_SUPPORTED],
+                        XCB_ATOM_ATOM, 32, static_cast<uint32_t>(supported.size()), supported.data());
+    
+    // Pagers find the window manager through a child window of ours that
+    // names itself on both ends
+    if (!wm_check_window_) {
+        wm_check_window_ = xcb_generate_id(conn_);
+        xcb_create_window(conn_, XCB_COPY_FROM_PARENT, wm_check_window_, root_, -1, -1, 1, 1, 0,
+                          XCB_WINDOW_CLASS_INPUT_ONLY, XCB_COPY_FROM_PARENT, 0, nullptr);
+        const uint32_t check = static_cast<uint32_t>(wm_check_window_);
+        xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, wm_check_window_, atoms_[X11Atom::NET_SUPPORTING_WM_CHECK],
+                            XCB_ATOM_WINDOW, 32, 1, &check);
+        xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, root_, atoms_[X11Atom::NET_SUPPORTING_WM_CHECK],
+                            XCB_ATOM_WINDOW, 32, 1, &check);
+        static const char wm_name[] = "srdwm";
+        xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, wm_check_window_, atoms_[X11Atom::NET_WM_NAME],
+                            atoms_[X11Atom::UTF8_STRING], 8, sizeof(wm_name) - 1, wm_name);
+    }
+    
+    // Initial desktop info and client lists, written by the next flush()
     update_ewmh_desktop_info();
+    ewmh_clients_dirty_ = ewmh_stacking_dirty_ = ewmh_active_dirty_ = true;
     
     std::cout << "X11Platform: EWMH setup completed" << std::endl;
+    return true;
 }
 
+// Desktop changes come in bursts (a desktop added, then switched to);
+// publish_ewmh() writes the result once at the end of the iteration
 void X11Platform::update_ewmh_desktop_info() {
+    ewmh_desktop_dirty_ = true;
+}
+
+void X11Platform::publish_ewmh() {
     if (!display_ || !ewmh_supported_) return;
     
-    // Set number of desktops
-    int num_desktops = virtual_desktops_.size();
-    XChangeProperty(display_, root_, _NET_NUMBER_OF_DESKTOPS_, XA_CARDINAL, 32,
-                   PropModeReplace, (unsigned char*)&num_desktops, 1);
+    if (ewmh_clients_dirty_) {
+        ewmh_clients_dirty_ = false;
+        
+        std::vector<uint32_t> clients(client_order_.begin(), client_order_.end());
+        publish_property(root_, X11Atom::NET_CLIENT_LIST, XCB_ATOM_WINDOW, 32, static_cast<uint32_t>(clients.size()),
+                         clients.data());
+        
+        for (const auto& pair : client_desktops_) {
+            const uint32_t desktop = static_cast<uint32_t>(pair.second);
+            publish_property(pair.first, X11Atom::NET_WM_DESKTOP, XCB_ATOM_CARDINAL, 32, 1, &desktop);
+        }
+    }
     
-    // Set current desktop
-    XChangeProperty(display_, root_, _NET_CURRENT_DESKTOP_, XA_CARDINAL, 32,
-                   PropModeReplace, (unsigned char*)&current_virtual_desktop_, 1);
+    if (ewmh_stacking_dirty_) {
+        ewmh_stacking_dirty_ = false;
+        
+        // Bottom to top, as the frames (or clients) are stacked
+        std::map<X11Window, X11Window> client_of;
+        for (X11Window client : client_order_) {
+            client_of[toplevel_window(client)] = client;
+        }
+        std::vector<uint32_t> stacking;
+        stacking.reserve(client_order_.size());
+        for (OcclusionTracker::Id id : occlusion_.stack()) {
+            auto it = client_of.find(static_cast<X11Window>(id));
+            if (it != client_of.end()) stacking.push_back(static_cast<uint32_t>(it->second));
+        }
+        publish_property(root_, X11Atom::NET_CLIENT_LIST_STACKING, XCB_ATOM_WINDOW, 32,
+                         static_cast<uint32_t>(stacking.size()), stacking.data());
+    }
     
-    // Set desktop names (simplified - just use numbers for now)
-    std::vector<std::string> desktop_names;
-    for (int i = 0; i < num_desktops; ++i) {
-        desktop_names.push_back("Desktop " + std::to_string(i + 1));
+    if (ewmh_active_dirty_) {
+        ewmh_active_dirty_ = false;
+        const uint32_t active = window_map_.count(focused_client_) ? static_cast<uint32_t>(focused_client_) : 0;
+        publish_property(root_, X11Atom::NET_ACTIVE_WINDOW, XCB_ATOM_WINDOW, 32, 1, &active);
     }
     
-    // Convert to X11 string format
-    std::string names_str;
-    for (const auto& name : desktop_names) {
-        names_str += name + '\0';
+    // Pagers are hidden behind the fullscreen window; publish once it ends
+    if (!ewmh_desktop_dirty_ || fullscreen_active()) return;
+    ewmh_desktop_dirty_ = false;
+    
+    const uint32_t desktop_count = static_cast<uint32_t>(virtual_desktops_.size());
+    publish_property(root_, X11Atom::NET_NUMBER_OF_DESKTOPS, XCB_ATOM_CARDINAL, 32, 1, &desktop_count);
+    
+    const uint32_t current = static_cast<uint32_t>(current_virtual_desktop_);
+    publish_property(root_, X11Atom::NET_CURRENT_DESKTOP, XCB_ATOM_CARDINAL, 32, 1, &current);
+    
+    // Workspace names, each NUL-terminated; numbers for unnamed ones
+    std::string names;
+    for (size_t i = 0; i < virtual_desktops_.size(); ++i) {
+        names += i < desktop_names_.size() && !desktop_names_[i].empty() ? desktop_names_[i]
+                                                                          : "Desktop " + std::to_string(i + 1);
+        names += '\0';
     }
+    publish_property(root_, X11Atom::NET_DESKTOP_NAMES, atoms_[X11Atom::UTF8_STRING], 8,
+                     static_cast<uint32_t>(names.size()), names.data());
+    
+    // One work area per desktop
+    publish_work_area();
+}
+
+// Writes the property unless it already holds exactly this value; every
+// write wakes up each pager and bar watching the window
+void X11Platform::publish_property(X11Window window, X11Atom property, xcb_atom_t type, uint8_t format,
+                                   uint32_t count, const void* data) {
+    std::string value(static_cast<const char*>(data), static_cast<size_t>(count) * (format / 8));
+    auto key = std::make_pair(window, atoms_[property]);
+    auto it = published_.find(key);
+    if (it != published_.end() && it->second == value) return;
     
-    XChangeProperty(display_, root_, _NET_DESKTOP_NAMES_, XA_STRING, 8,
-                   PropModeReplace, (unsigned char*)names_str.c_str(), names_str.length());
+    xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, window, atoms_[property], type, format, count, data);
+    published_[key] = std::move(value);
+}
+
+void X11Platform::forget_published(X11Window window) {
+    auto it = published_.lower_bound({window, XCB_ATOM_NONE});
+    while (it != published_.end() && it->first.first == window) {
+        it = published_.erase(it);
+    }
 }
 
 // Linux/X11-specific features implementation
 void X11Platform::enable_compositor(bool enabled) {
-    compositor_enabled_ = enabled;
+    if (!display_) return;
     
     if (enabled) {
-        // Try to enable compositor effects
-        // This is a simplified implementation - real compositors have more complex setup
-        std::cout << "X11Platform: Compositor effects enabled" << std::endl;
+        // Stays off if an extension is missing or another compositing
+        // manager owns the screen
+        compositor_enabled_ = compositor_.initialize(display_, to_x11_window(root_));
+        if (compositor_enabled_) {
+            for (const auto& pair : fullscreen_) {
+                compositor_.set_fullscreen(toplevel_window(pair.first), true);
+            }
+        }
     } else {
-        std::cout << "X11Platform: Compositor effects disabled" << std::endl;
+        compositor_.shutdown();
+        compositor_enabled_ = false;
+    }
+    std::cout << "X11Platform: Compositor " << (compositor_enabled_ ? "enabled" : "disabled") << std::endl;
+}
+
+X11Window X11Platform::toplevel_window(X11Window client) const {
+    auto frame = frame_window_map_.find(client);
+    return frame != frame_window_map_.end() ? frame->second : client;
+}
+
+Monitor X11Platform::monitor_at(int x, int y) const {
+    for (const Monitor& monitor : monitors_) {
+        if (x >= monitor.x && x < monitor.x + monitor.width && y >= monitor.y && y < monitor.y + monitor.height) {
+            return monitor;
+        }
+    }
+    // Same fallback as get_monitors()
+    return monitors_.empty() ? Monitor{0, 0, 0, 1920, 1080} : monitors_.front();
+}
+
+float X11Platform::window_scale(SRDWindow* window) const {
+    if (!window) return 1.0f;
+    return monitor_at(window->getX() + window->getWidth() / 2, window->getY() + window->getHeight() / 2).scale;
+}
+
+// Workspace switch in one go. Outgoing windows are unmapped (frame, or
+// the client and its overlay titlebar) and marked iconic; incoming ones
+// are moved to their new geometry while still unmapped, then mapped. The
+// server grab keeps other clients, the compositor included, from seeing
+// any state in between, and everything goes out with the next flush().
+void X11Platform::apply_workspace_switch(const std::vector<SRDWindow*>& hide, const std::vector<SRDWindow*>& show) {
+    if (!display_ || (hide.empty() && show.empty())) return;
+    
+    xcb_grab_server(conn_);
+    
+    for (SRDWindow* window : hide) {
+        X11Window client = static_cast<X11Window>(window->getId());
+        if (!window_map_.count(client) || iconic_.count(client)) continue;
+        
+        X11Window toplevel = toplevel_window(client);
+        if (toplevel == client) {
+            // Swallow the UnmapNotify, and have the server map the client
+            // again should we exit while it is hidden
+            expected_unmaps_[client]++;
+            xcb_change_save_set(conn_, XCB_SET_MODE_INSERT, client);
+        }
+        xcb_unmap_window(conn_, toplevel);
+        auto overlay = overlay_titlebar_map_.find(client);
+        if (overlay != overlay_titlebar_map_.end()) {
+            xcb_unmap_window(conn_, overlay->second);
+        }
+        
+        iconic_.insert(client);
+        write_wm_state(client, IconicState);
+        write_net_wm_state(client);
+    }
+    
+    for (SRDWindow* window : show) {
+        X11Window client = static_cast<X11Window>(window->getId());
+        if (!window_map_.count(client) || !iconic_.count(client)) continue;
+        iconic_.erase(client);
+        
+        X11Window toplevel = toplevel_window(client);
+        configure_client(window);
+        xcb_map_window(conn_, toplevel);
+        auto overlay = overlay_titlebar_map_.find(client);
+        if (overlay != overlay_titlebar_map_.end()) {
+            xcb_map_window(conn_, overlay->second);
+        }
+        
+        write_wm_state(client, NormalState);
+        write_net_wm_state(client);
+    }
+    
+    xcb_ungrab_server(conn_);
+    
+    // Titlebars that changed while hidden, and pagers held back by a
+    // fullscreen window that just left the screen
+    resume_deferred_work();
+    
+    std::cout << "X11Platform: Workspace switch hid " << hide.size() << " and showed " << show.size()
+              << " windows" << std::endl;
+}
+
+void X11Platform::apply_window_geometry(SRDWindow* window) {
+    if (!window || !display_ || !window_map_.count(static_cast<X11Window>(window->getId()))) return;
+    configure_client(window);
+    flush_if_immediate();
+}
+
+// Only what differs from the last geometry sent goes out: nothing for a
+// window that did not move, a frame move without touching the client for
+// one that only moved
+bool X11Platform::configure_client(SRDWindow* window) {
+    X11Window client = static_cast<X11Window>(window->getId());
+    if (fullscreen_.count(client)) return false; // Stays covering its monitor
+    
+    const std::array<int, 4> geometry{window->getX(), window->getY(), std::max(1, window->getWidth()),
+                                      std::max(1, window->getHeight())};
+    auto it = configured_.find(client);
+    bool known = it != configured_.end();
+    bool moved = !known || it->second[0] != geometry[0] || it->second[1] != geometry[1];
+    bool resized = !known || it->second[2] != geometry[2] || it->second[3] != geometry[3];
+    
+    // A move onto a monitor with another scale, or a monitor rescaled,
+    // changes the decorations
+    auto scale_it = decoration_scale_.find(client);
+    bool rescaled = scale_it != decoration_scale_.end() &&
+                    scale_it->second != ScaledMetrics::bucket(window_scale(window));
+    if (!moved && !resized && !rescaled) return false;
+    configured_[client] = geometry;
+    
+    X11Window toplevel = toplevel_window(client);
+    if (toplevel != client && (resized || rescaled)) {
+        update_frame_geometry(window);
+        return true;
+    }
+    if (rescaled) {
+        apply_native_border(client, client == focused_client_);
+    }
+    
+    uint32_t values[4];
+    uint16_t mask = 0;
+    size_t count = 0;
+    if (moved) {
+        mask |= XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y;
+        values[count++] = static_cast<uint32_t>(geometry[0]);
+        values[count++] = static_cast<uint32_t>(geometry[1]);
+    }
+    if (resized) {
+        mask |= XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT;
+        values[count++] = static_cast<uint32_t>(geometry[2]);
+        values[count++] = static_cast<uint32_t>(geometry[3]);
+    }
+    if (mask) {
+        xcb_configure_window(conn_, toplevel, mask, values);
+    }
+    if (toplevel == client) {
+        update_overlay_geometry(window, geometry[0], geometry[1], geometry[2]);
     }
+    return true;
+}
+
+void X11Platform::write_wm_state(X11Window client, uint32_t state) {
+    const uint32_t data[] = {state, XCB_NONE}; // State, icon window
+    xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, client, atoms_[X11Atom::WM_STATE], atoms_[X11Atom::WM_STATE],
+                        32, 2, data);
+}
+
+// Fullscreen fast path. The window covers its monitor with no border and
+// its frame's titlebar hidden underneath; the compositor (if running)
+// stops compositing while it is on top, and work nobody can see is
+// deferred until the last fullscreen window goes away.
+void X11Platform::set_window_fullscreen(SRDWindow* window, bool fullscreen) {
+    if (!window || !display_) return;
+    
+    X11Window client = static_cast<X11Window>(window->getId());
+    if (fullscreen == (fullscreen_.count(client) != 0)) return;
+    if (!fullscreen) {
+        end_fullscreen(client, true);
+        flush_if_immediate();
+        return;
+    }
+    
+    Monitor monitor = monitor_at(window->getX() + window->getWidth() / 2, window->getY() + window->getHeight() / 2);
+    
+    // One fullscreen window per monitor; the newer one wins
+    for (const auto& pair : fullscreen_) {
+        if (pair.second.monitor_id == monitor.id) {
+            end_fullscreen(pair.first, true);
+            break;
+        }
+    }
+    fullscreen_[client] = FullscreenState{monitor.id, window->getX(), window->getY(), window->getWidth(),
+                                          window->getHeight()};
+    configured_.erase(client);
+    fit_fullscreen(client, monitor);
+    
+    X11Window toplevel = toplevel_window(client);
+    write_net_wm_state(client);
+    if (compositor_enabled_) {
+        compositor_.set_fullscreen(toplevel, true);
+    }
+    pending_fullscreen_events_.push_back(FullscreenEvent{window->getId(), monitor.id, true});
+    
+    std::cout << "X11Platform: Window " << window->getId() << " is fullscreen on monitor " << monitor.id << std::endl;
+    flush_if_immediate();
+}
+
+// Covers the monitor with the client's toplevel, above everything else
+void X11Platform::fit_fullscreen(X11Window client, const Monitor& monitor) {
+    auto window_it = window_map_.find(client);
+    if (window_it == window_map_.end()) return;
+    
+    X11Window toplevel = toplevel_window(client);
+    if (toplevel != client) {
+        const uint32_t inside[] = {0, 0, static_cast<uint32_t>(monitor.width), static_cast<uint32_t>(monitor.height)};
+        xcb_configure_window(conn_, client,
+                             XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
+                             XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, inside);
+    }
+    const uint32_t values[] = {
+        static_cast<uint32_t>(monitor.x), static_cast<uint32_t>(monitor.y),
+        static_cast<uint32_t>(monitor.width), static_cast<uint32_t>(monitor.height),
+        0, XCB_STACK_MODE_ABOVE
+    };
+    xcb_configure_window(conn_, toplevel,
+                         XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH |
+                         XCB_CONFIG_WINDOW_HEIGHT | XCB_CONFIG_WINDOW_BORDER_WIDTH | XCB_CONFIG_WINDOW_STACK_MODE,
+                         values);
+    window_it->second->setGeometry(monitor.x, monitor.y, monitor.width, monitor.height);
+}
+
+// restore is false when the client is gone or withdrawn
+void X11Platform::end_fullscreen(X11Window client, bool restore) {
+    auto it = fullscreen_.find(client);
+    if (it == fullscreen_.end()) return;
+    
+    FullscreenState state = it->second;
+    fullscreen_.erase(it);
+    
+    X11Window toplevel = toplevel_window(client);
+    if (compositor_enabled_) {
+        compositor_.set_fullscreen(toplevel, false);
+    }
+    
+    auto window_it = window_map_.find(client);
+    if (restore && window_it != window_map_.end()) {
+        SRDWindow* window = window_it->second;
+        window->setGeometry(state.x, state.y, state.width, state.height);
+        
+        const Metrics& metrics = metrics_for(window);
+        if (toplevel != client) {
+            const uint32_t inside[] = {static_cast<uint32_t>(metrics.border_width),
+                                       static_cast<uint32_t>(metrics.titlebar_height)};
+            xcb_configure_window(conn_, client, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, inside);
+            const uint32_t border[] = {static_cast<uint32_t>(metrics.border_width)};
+            xcb_configure_window(conn_, toplevel, XCB_CONFIG_WINDOW_BORDER_WIDTH, border);
+            decoration_scale_[client] = ScaledMetrics::bucket(window_scale(window));
+            update_frame_geometry(window);
+        } else {
+            const uint32_t values[] = {
+                static_cast<uint32_t>(state.x), static_cast<uint32_t>(state.y),
+                static_cast<uint32_t>(std::max(1, state.width)), static_cast<uint32_t>(std::max(1, state.height)),
+                static_cast<uint32_t>(frameless_ && decorations_enabled_ ? metrics.border_width : 0)
+            };
+            xcb_configure_window(conn_, client,
+                                 XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH |
+                                 XCB_CONFIG_WINDOW_HEIGHT | XCB_CONFIG_WINDOW_BORDER_WIDTH, values);
+            update_overlay_geometry(window, state.x, state.y, state.width);
+        }
+        configured_[client] = {state.x, state.y, state.width, state.height};
+        write_net_wm_state(client);
+    }
+    
+    pending_fullscreen_events_.push_back(FullscreenEvent{static_cast<int>(client), state.monitor_id, false});
+    resume_deferred_work();
+}
+
+void X11Platform::write_net_wm_state(X11Window client) {
+    // Keep whatever else the client had in _NET_WM_STATE; fullscreen and
+    // hidden are ours
+    xcb_atom_t fullscreen_atom = atoms_[X11Atom::NET_WM_STATE_FULLSCREEN];
+    xcb_atom_t hidden_atom = atoms_[X11Atom::NET_WM_STATE_HIDDEN];
+    std::vector<xcb_atom_t> state;
+    if (const X11ClientProperties* props = property_cache_.find(client)) {
+        for (xcb_atom_t atom : props->state) {
+            if (atom != fullscreen_atom && atom != hidden_atom) state.push_back(atom);
+        }
+    }
+    if (fullscreen_.count(client)) state.push_back(fullscreen_atom);
+    if (occluded_.count(client) || iconic_.count(client)) state.push_back(hidden_atom);
+    xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, client, atoms_[X11Atom::NET_WM_STATE], XCB_ATOM_ATOM, 32,
+                        static_cast<uint32_t>(state.size()), state.data());
+}
+
+bool X11Platform::covered_by_fullscreen(SRDWindow* window) const {
+    X11Window client = static_cast<X11Window>(window->getId());
+    if (fullscreen_.count(client)) return true;
+    
+    int monitor_id = monitor_at(window->getX() + window->getWidth() / 2, window->getY() + window->getHeight() / 2).id;
+    for (const auto& pair : fullscreen_) {
+        if (pair.second.monitor_id == monitor_id && !iconic_.count(pair.first)) return true;
+    }
+    return false;
+}
+
+bool X11Platform::fullscreen_active() const {
+    for (const auto& pair : fullscreen_) {
+        if (!iconic_.count(pair.first)) return true;
+    }
+    return false;
+}
+
+bool X11Platform::titlebar_hidden(SRDWindow* window) const {
+    X11Window client = static_cast<X11Window>(window->getId());
+    // An overlay titlebar sits outside the client, so only a frame goes
+    // down with its client
+    if (occluded_.count(client) && frame_window_map_.count(client)) return true;
+    return iconic_.count(client) || (fullscreen_active() && covered_by_fullscreen(window));
+}
+
+void X11Platform::resume_deferred_work() {
+    for (auto it = deferred_titlebars_.begin(); it != deferred_titlebars_.end();) {
+        auto window = window_map_.find(*it);
+        if (window == window_map_.end()) {
+            it = deferred_titlebars_.erase(it);
+        } else if (!titlebar_hidden(window->second)) {
+            SRDWindow* uncovered = window->second;
+            it = deferred_titlebars_.erase(it);
+            draw_titlebar(uncovered);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void X11Platform::handle_ewmh_message(XClientMessageEvent& event) {
+    if (event.format != 32 || static_cast<xcb_atom_t>(event.message_type) != atoms_[X11Atom::NET_WM_STATE]) {
+        return;
+    }
+    auto it = window_map_.find(from_x11_window(event.window));
+    if (it == window_map_.end()) return;
+    
+    // data.l[0] is the action (0 remove, 1 add, 2 toggle), l[1] and l[2]
+    // the one or two states it applies to
+    xcb_atom_t fullscreen_atom = atoms_[X11Atom::NET_WM_STATE_FULLSCREEN];
+    if (static_cast<xcb_atom_t>(event.data.l[1]) != fullscreen_atom &&
+        static_cast<xcb_atom_t>(event.data.l[2]) != fullscreen_atom) {
+        return;
+    }
+    bool active = fullscreen_.count(it->first) != 0;
+    long action = event.data.l[0];
+    set_window_fullscreen(it->second, action == 1 || (action == 2 && !active));
 }
 
 void X11Platform::set_window_opacity(SRDWindow* window, unsigned char opacity) {
@@ -814,12 +2059,14 @@ void X11Platform::set_window_opacity(SRDWindow* window, unsigned char opacity) {
     X11Window x11_window = static_cast<X11Window>(window->getId());
     
     // Set window opacity using _NET_WM_WINDOW_OPACITY atom
-    Atom opacity_atom = XInternAtom(display_, "_NET_WM_WINDOW_OPACITY", False);
-    if (opacity_atom != None) {
-        unsigned long opacity_value = (opacity << 24) | (opacity << 16) | (opacity << 8) | opacity;
-        XChangeProperty(display_, x11_window, opacity_atom, XA_CARDINAL, 32,
-                       PropModeReplace, (unsigned char*)&opacity_value, 1);
+    xcb_atom_t opacity_atom = atoms_[X11Atom::NET_WM_WINDOW_OPACITY];
+    if (opacity_atom != XCB_ATOM_NONE) {
+        const uint32_t opacity_value = (static_cast<uint32_t>(opacity) << 24) | (opacity << 16) | (opacity << 8) | opacity;
+        xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, x11_window, opacity_atom,
+                            XCB_ATOM_CARDINAL, 32, 1, &opacity_value);
     }
+    compositor_.set_opacity(to_x11_window(toplevel_window(x11_window)), opacity);
+    occlusion_.set_opaque(toplevel_window(x11_window), opacity == 255);
     
     std::cout << "X11Platform: Set window " << window->getId() << " opacity to " << (int)opacity << std::endl;
 }
@@ -830,11 +2077,11 @@ void X11Platform::set_window_blur(SRDWindow* window, bool enabled) {
     X11Window x11_window = static_cast<X11Window>(window->getId());
     
     // Set window blur using _NET_WM_WINDOW_BLUR atom (if supported)
-    Atom blur_atom = XInternAtom(display_, "_NET_WM_WINDOW_BLUR", False);
-    if (blur_atom != None) {
-        unsigned long blur_value = enabled ? 1 : 0;
-        XChangeProperty(display_, x11_window, blur_atom, XA_CARDINAL, 32,
-                       PropModeReplace, (unsigned char*)&blur_value, 1);
+    xcb_atom_t blur_atom = atoms_[X11Atom::NET_WM_WINDOW_BLUR];
+    if (blur_atom != XCB_ATOM_NONE) {
+        const uint32_t blur_value = enabled ? 1 : 0;
+        xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, x11_window, blur_atom,
+                            XCB_ATOM_CARDINAL, 32, 1, &blur_value);
     }
     
     std::cout << "X11Platform: Set window " << window->getId() << " blur " << (enabled ? "enabled" : "disabled") << std::endl;
@@ -846,12 +2093,13 @@ void X11Platform::set_window_shadow(SRDWindow* window, bool enabled) {
     X11Window x11_window = static_cast<X11Window>(window->getId());
     
     // Set window shadow using _NET_WM_WINDOW_SHADOW atom (if supported)
-    Atom shadow_atom = XInternAtom(display_, "_NET_WM_WINDOW_SHADOW", False);
-    if (shadow_atom != None) {
-        unsigned long shadow_value = enabled ? 1 : 0;
-        XChangeProperty(display_, x11_window, shadow_atom, XA_CARDINAL, 32,
-                       PropModeReplace, (unsigned char*)&shadow_value, 1);
+    xcb_atom_t shadow_atom = atoms_[X11Atom::NET_WM_WINDOW_SHADOW];
+    if (shadow_atom != XCB_ATOM_NONE) {
+        const uint32_t shadow_value = enabled ? 1 : 0;
+        xcb_change_property(conn_, XCB_PROP_MODE_REPLACE, x11_window, shadow_atom,
+                            XCB_ATOM_CARDINAL, 32, 1, &shadow_value);
     }
+    compositor_.set_shadow(to_x11_window(toplevel_window(x11_window)), enabled);
     
     std::cout << "X11Platform: Set window " << window->getId() << " shadow " << (enabled ? "enabled" : "disabled") << std::endl;
 }
@@ -888,12 +2136,35 @@ void X11Platform::set_monitor_refresh_rate(int monitor_id, int refresh_rate) {
     std::cout << "X11Platform: Set monitor " << monitor_id << " refresh rate to " << refresh_rate << " Hz" << std::endl;
 }
 
+void X11Platform::set_auto_scale(bool enabled) {
+    if (auto_scale_ == enabled) return;
+    auto_scale_ = enabled;
+    monitors_dirty_ = true; // Re-read the outputs with the next poll
+}
+
+// Scale is ours, not the server's: decorations and layout metrics on the
+// monitor are drawn that much larger. Kept across reconnects.
 void X11Platform::set_monitor_scale(int monitor_id, float scale) {
-    if (!randr_enabled_) return;
-    
     if (scale < 0.5f || scale > 3.0f) return;
     
-    // TODO: Implement actual RandR scaling
+    monitor_scales_[monitor_id] = scale;
+    for (Monitor& monitor : monitors_) {
+        if (monitor.id == monitor_id && monitor.scale != scale) {
+            monitor.scale = scale;
+            monitors_changed_ = true;
+            
+            // Decorations of windows there, whether or not a relayout
+            // moves them; resources for the new scale are cached
+            for (const auto& pair : window_map_) {
+                SRDWindow* window = pair.second;
+                if (monitor_at(window->getX() + window->getWidth() / 2,
+                               window->getY() + window->getHeight() / 2).id == monitor_id) {
+                    configure_client(window);
+                }
+            }
+        }
+    }
+    
     std::cout << "X11Platform: Set monitor " << monitor_id << " scale to " << scale << "x" << std::endl;
 }
 
@@ -901,46 +2172,171 @@ void X11Platform::initialize_randr() {
     if (!display_) return;
     
     // Check if RandR extension is available
-    int event_base, error_base;
-    if (XRRQueryExtension(display_, &event_base, &error_base)) {
+    int error_base;
+    if (XRRQueryExtension(display_, &randr_event_base_, &error_base)) {
         std::cout << "X11Platform: RandR extension available" << std::endl;
         
-        // Get screen resources
-        Window root = DefaultRootWindow(display_);
-        int screen = DefaultScreen(display_);
-        XRRScreenResources* resources = XRRGetScreenResources(display_, root);
-        
-        if (resources) {
-            // Process monitor information
-            for (int i = 0; i < resources->noutput; ++i) {
-                XRROutputInfo* output_info = XRRGetOutputInfo(display_, resources, resources->outputs[i]);
-                if (output_info && output_info->connection == RR_Connected) {
-                    // Add monitor to our list
-                    Monitor monitor;
-                    monitor.id = i;
-                    monitor.x = 0; // TODO: Get actual position
-                    monitor.y = 0;
-                    monitor.width = output_info->mm_width; // Convert mm to pixels
-                    monitor.height = output_info->mm_height;
-                    monitor.name = output_info->name;
-                    monitor.refresh_rate = 60; // Default
-                    
-                    monitors_.push_back(monitor);
-                }
-                if (output_info) XRRFreeOutputInfo(output_info);
-            }
-            XRRFreeScreenResources(resources);
-        }
+        // Hotplug, mode and layout changes; handled after the event drain
+        XRRSelectInput(display_, root_, RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask);
+        refresh_monitors();
     } else {
+        randr_event_base_ = -1;
         std::cout << "X11Platform: RandR extension not available" << std::endl;
     }
 }
 
 void X11Platform::cleanup_randr() {
-    // Clean up RandR resources if needed
+    if (display_ && randr_event_base_ >= 0) {
+        XRRSelectInput(display_, root_, 0);
+    }
+    randr_event_base_ = -1;
+    monitors_dirty_ = false;
     std::cout << "X11Platform: RandR cleanup completed" << std::endl;
 }
 
+// Reads the active outputs and diffs them against the cached set. Only a
+// monitor that was added, removed or resized counts as a change; the
+// window manager then migrates windows and workspaces in one relayout.
+bool X11Platform::refresh_monitors() {
+    if (!display_ || randr_event_base_ < 0) return false;
+    
+    // The current configuration, without making the server probe outputs.
+    // Every output and CRTC is queried before any reply is read, so a
+    // refresh costs two round-trips however many outputs there are.
+    auto resources_cookie = xcb_randr_get_screen_resources_current(conn_, root_);
+    auto primary_cookie = xcb_randr_get_output_primary(conn_, root_);
+    auto resources = xcb_take(xcb_randr_get_screen_resources_current_reply(conn_, resources_cookie, nullptr));
+    auto primary_reply = xcb_take(xcb_randr_get_output_primary_reply(conn_, primary_cookie, nullptr));
+    if (!resources) return false;
+    const xcb_randr_output_t primary = primary_reply ? primary_reply->output : XCB_NONE;
+    
+    const xcb_randr_output_t* outputs = xcb_randr_get_screen_resources_current_outputs(resources.get());
+    const int output_count = xcb_randr_get_screen_resources_current_outputs_length(resources.get());
+    const xcb_randr_crtc_t* crtc_ids = xcb_randr_get_screen_resources_current_crtcs(resources.get());
+    const int crtc_count = xcb_randr_get_screen_resources_current_crtcs_length(resources.get());
+    const xcb_randr_mode_info_t* modes = xcb_randr_get_screen_resources_current_modes(resources.get());
+    const int mode_count = xcb_randr_get_screen_resources_current_modes_length(resources.get());
+    
+    std::vector<xcb_randr_get_output_info_cookie_t> output_cookies;
+    output_cookies.reserve(static_cast<size_t>(output_count));
+    for (int i = 0; i < output_count; ++i) {
+        output_cookies.push_back(xcb_randr_get_output_info(conn_, outputs[i], resources->config_timestamp));
+    }
+    std::map<xcb_randr_crtc_t, xcb_randr_get_crtc_info_cookie_t> crtc_cookies;
+    for (int i = 0; i < crtc_count; ++i) {
+        crtc_cookies[crtc_ids[i]] = xcb_randr_get_crtc_info(conn_, crtc_ids[i], resources->config_timestamp);
+    }
+    
+    // Collect every reply, even the unused ones, so none is left queued
+    std::map<xcb_randr_crtc_t, XcbReply<xcb_randr_get_crtc_info_reply_t>> crtcs;
+    for (const auto& pair : crtc_cookies) {
+        crtcs[pair.first] = xcb_take(xcb_randr_get_crtc_info_reply(conn_, pair.second, nullptr));
+    }
+    
+    std::vector<Monitor> monitors;
+    int primary_id = -1;
+    std::set<xcb_randr_crtc_t> used; // Cloned outputs share a CRTC and are one monitor
+    for (int i = 0; i < output_count; ++i) {
+        auto output = xcb_take(xcb_randr_get_output_info_reply(conn_, output_cookies[static_cast<size_t>(i)], nullptr));
+        if (!output || output->connection != XCB_RANDR_CONNECTION_CONNECTED || !output->crtc ||
+            !used.insert(output->crtc).second) {
+            continue;
+        }
+        auto crtc_it = crtcs.find(output->crtc);
+        const xcb_randr_get_crtc_info_reply_t* crtc = crtc_it != crtcs.end() ? crtc_it->second.get() : nullptr;
+        if (!crtc || crtc->width == 0 || crtc->height == 0) continue;
+        
+        std::string name(reinterpret_cast<const char*>(xcb_randr_get_output_info_name(output.get())),
+                         static_cast<size_t>(xcb_randr_get_output_info_name_length(output.get())));
+        auto id = monitor_ids_.find(name);
+        if (id == monitor_ids_.end()) {
+            id = monitor_ids_.emplace(name, next_monitor_id_++).first;
+        }
+        
+        int refresh_rate = 60;
+        for (int m = 0; m < mode_count; ++m) {
+            const xcb_randr_mode_info_t& mode = modes[m];
+            if (mode.id == crtc->mode && mode.htotal && mode.vtotal) {
+                const uint64_t pixels = static_cast<uint64_t>(mode.htotal) * mode.vtotal;
+                refresh_rate = static_cast<int>((mode.dot_clock + pixels / 2) / pixels);
+                break;
+            }
+        }
+        
+        monitors.emplace_back(id->second, crtc->x, crtc->y, static_cast<int>(crtc->width),
+                              static_cast<int>(crtc->height), name, refresh_rate);
+        
+        // An explicit scale wins; with auto-scaling on, 2x for panels
+        // dense and tall enough to need it
+        auto scale = monitor_scales_.find(id->second);
+        if (scale != monitor_scales_.end()) {
+            monitors.back().scale = scale->second;
+        } else if (auto_scale_ && output->mm_width > 0 && crtc->height >= 1200 &&
+                   crtc->width * 25.4 / output->mm_width >= 192.0) {
+            monitors.back().scale = 2.0f;
+        }
+        if (outputs[i] == primary) {
+            primary_id = id->second;
+        }
+    }
+    
+    // With every output off there is nowhere to move windows to; keep
+    // the old layout until something comes back
+    if (monitors.empty()) return false;
+    
+    std::sort(monitors.begin(), monitors.end(), [primary_id](const Monitor& a, const Monitor& b) {
+        if ((a.id == primary_id) != (b.id == primary_id)) return a.id == primary_id;
+        return a.id < b.id;
+    });
+    
+    auto find = [](const std::vector<Monitor>& set, int id) -> const Monitor* {
+        for (const Monitor& monitor : set) {
+            if (monitor.id == id) return &monitor;
+        }
+        return nullptr;
+    };
+    int added = 0, removed = 0, resized = 0;
+    for (const Monitor& monitor : monitors) {
+        const Monitor* old = find(monitors_, monitor.id);
+        if (!old) {
+            added++;
+        } else if (old->x != monitor.x || old->y != monitor.y || old->width != monitor.width ||
+                   old->height != monitor.height || old->scale != monitor.scale) {
+            resized++;
+        }
+    }
+    for (const Monitor& monitor : monitors_) {
+        if (!find(monitors, monitor.id)) removed++;
+    }
+    if (!added && !removed && !resized && primary_id == primary_monitor_id_) return false;
+    
+    monitors_ = std::move(monitors);
+    primary_monitor_id_ = primary_id;
+    
+    // Fullscreen windows follow their monitor, or leave fullscreen with it
+    std::vector<std::pair<X11Window, int>> fullscreen;
+    for (const auto& pair : fullscreen_) {
+        fullscreen.emplace_back(pair.first, pair.second.monitor_id);
+    }
+    for (const auto& pair : fullscreen) {
+        const Monitor* monitor = find(monitors_, pair.second);
+        if (monitor) {
+            auto window_it = window_map_.find(pair.first);
+            SRDWindow* window = window_it != window_map_.end() ? window_it->second : nullptr;
+            if (window && (window->getX() != monitor->x || window->getY() != monitor->y ||
+                           window->getWidth() != monitor->width || window->getHeight() != monitor->height)) {
+                fit_fullscreen(pair.first, *monitor);
+            }
+        } else {
+            end_fullscreen(pair.first, true);
+        }
+    }
+    
+    std::cout << "X11Platform: Monitors changed (" << added << " added, " << removed << " removed, "
+              << resized << " resized or rescaled)" << std::endl;
+    return true;
+}
+
 // Panel/Dock integration implementation
 void X11Platform::set_panel_visible(bool visible) {
     panel_visible_ = visible;
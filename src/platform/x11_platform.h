@@ -2,16 +2,37 @@
 #define SRDWM_X11_PLATFORM_H
 
 #include "platform.h"
+#include "../input/input_handler.h"
+#include <array>
+#include <deque>
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <algorithm>
 
+// Xlib defines KeyPress/KeyRelease as macros, which hides the EventType
+// enumerators of the same name once <X11/Xlib.h> is included
+constexpr EventType kKeyPressEvent = EventType::KeyPress;
+constexpr EventType kKeyReleaseEvent = EventType::KeyRelease;
+
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/XKBlib.h>
 #include <X11/Xatom.h>
 #include <X11/extensions/Xrandr.h>
 #include <X11/extensions/Xinerama.h>
+#include <X11/Xlib-xcb.h>
+#include <xcb/randr.h>
+
+#include "x11_xcb.h"
+#include "x11_atoms.h"
+#include "x11_property_cache.h"
+#include "x11_decorations.h"
+#include "x11_keysyms.h"
+#include "../core/occlusion_tracker.h"
+#include "../layouts/work_area.h"
+#include "x11_compositor.h"
 
 // X11 types are now properly included
 // Use X11Window typedef to avoid collision with our SRDWindow class
@@ -21,6 +42,12 @@ typedef unsigned long X11Window;
 inline ::Window to_x11_window(X11Window w) { return static_cast<::Window>(w); }
 inline X11Window from_x11_window(::Window w) { return static_cast<X11Window>(w); }
 
+// X11 backend.
+//
+// Xlib owns the connection and the event queue (and is kept for drawing),
+// but every request that needs a reply goes through XCB on the same socket:
+// queries are issued as cookies and their replies collected afterwards, so
+// managing a window costs one round-trip instead of one per query.
 class X11Platform : public Platform {
 public:
     X11Platform();
@@ -31,6 +58,10 @@ public:
     void shutdown() override;
     bool poll_events(std::vector<Event>& events) override;
     void process_event(const Event& event) override;
+    void flush() override;
+    void set_immediate_flush(bool enabled) override { immediate_flush_ = enabled; }
+    void set_window_cache_size(int entries) override;
+    std::vector<SRDWindow*> adopt_existing_windows() override;
 
     // Window management
     std::unique_ptr<SRDWindow> create_window(const std::string& title, int x, int y, int width, int height) override;
@@ -46,21 +77,30 @@ public:
     // Monitor management
     std::vector<Monitor> get_monitors() override;
     Monitor get_primary_monitor() override;
+    std::vector<Monitor> get_work_areas() override;
 
     // Input handling
     void grab_keyboard() override;
     void ungrab_keyboard() override;
     void grab_pointer() override;
     void ungrab_pointer() override;
+    std::vector<uint32_t> key_codes_for(const std::string& key_name) override;
+    void grab_keys(const std::vector<KeyGrab>& grabs) override;
 
     // Window decorations (X11 implementation)
     void set_window_decorations(SRDWindow* window, bool enabled) override;
     void set_window_border_color(SRDWindow* window, int r, int g, int b) override;
     void set_window_border_width(SRDWindow* window, int width) override;
     bool get_window_decorations(SRDWindow* window) const override;
+    void set_frameless_decorations(bool enabled) override { frameless_ = enabled; }
+    void set_window_floating(SRDWindow* window, bool floating) override;
+    void set_window_fullscreen(SRDWindow* window, bool fullscreen) override;
+    void apply_workspace_switch(const std::vector<SRDWindow*>& hide, const std::vector<SRDWindow*>& show) override;
+    void apply_window_geometry(SRDWindow* window) override;
 
     // Linux/X11-specific features
-    void enable_compositor(bool enabled);
+    void enable_compositor(bool enabled) override;
+    void set_auto_scale(bool enabled) override;
     void set_window_opacity(SRDWindow* window, unsigned char opacity);
     void set_window_blur(SRDWindow* window, bool enabled);
     void set_window_shadow(SRDWindow* window, bool enabled);
@@ -78,6 +118,8 @@ public:
     int get_current_virtual_desktop() const;
     std::vector<int> get_virtual_desktops() const;
     void move_window_to_desktop(SRDWindow* window, int desktop_id);
+    void set_workspaces(const std::vector<std::string>& names, int current) override;
+    void set_window_workspace(SRDWindow* window, int index) override { move_window_to_desktop(window, index); }
     
     // Panel/Dock integration
     void set_panel_visible(bool visible);
@@ -95,6 +137,9 @@ public:
     void set_monitor_rotation(int monitor_id, int rotation);
     void set_monitor_refresh_rate(int monitor_id, int refresh_rate);
     void set_monitor_scale(int monitor_id, float scale);
+    
+    // Client properties prefetched when the window was managed
+    const X11ClientProperties* get_client_properties(SRDWindow* window) const;
 
     // Utility
     std::string get_platform_name() const override { return "X11"; }
@@ -106,64 +151,136 @@ public:
 private:
     // X11-specific members
     Display* display_ = nullptr;
+    xcb_connection_t* conn_ = nullptr; // Shared with display_, not owned
     X11Window root_ = 0;
+    X11Window focused_client_ = 0; // Last client we gave input focus to
+    bool immediate_flush_ = false; // Debug: flush after every request
     
     // Window tracking
     std::map<X11Window, ::SRDWindow*> window_map_;
     std::map<X11Window, X11Window> frame_window_map_; // client -> frame
+    std::map<X11Window, X11Window> frame_clients_;    // frame -> client
+    std::map<X11Window, X11Window> overlay_titlebar_map_; // client -> titlebar (frameless mode)
+    X11PropertyCache property_cache_;
+    // Clients managed or destroyed, handed out by the next poll_events()
+    std::vector<std::pair<EventType, ::SRDWindow*>> pending_window_events_;
+    
+    // Key events handed to the window manager by the last poll_events()
+    std::deque<KeyboardEvent> key_events_;
+    X11KeysymCache keysyms_;
+    bool keymap_dirty_ = false; // Rebuild keysyms_ after the event drain
+    int xkb_event_base_ = -1;
+    std::vector<KeyGrab> key_grabs_; // Passive grabs currently registered, sorted
+    
+    // Fullscreen clients and the geometry to go back to. While any is
+    // active, titlebars it covers and EWMH desktop updates are deferred.
+    struct FullscreenState {
+        int monitor_id;
+        int x, y, width, height;
+    };
+    std::map<X11Window, FullscreenState> fullscreen_;
+    std::vector<FullscreenEvent> pending_fullscreen_events_; // Emitted by the next poll_events()
+    std::deque<FullscreenEvent> fullscreen_events_;          // Handed out by the last poll_events()
+    std::set<X11Window> deferred_titlebars_;
+    
+    // EWMH root and client properties are published once per iteration,
+    // from flush(), and only where the value differs from the last one
+    // written. Desktop properties also wait for fullscreen to end.
+    bool ewmh_desktop_dirty_ = false;
+    bool ewmh_clients_dirty_ = false;  // _NET_CLIENT_LIST, _NET_WM_DESKTOP
+    bool ewmh_stacking_dirty_ = false; // _NET_CLIENT_LIST_STACKING
+    bool ewmh_active_dirty_ = false;   // _NET_ACTIVE_WINDOW
+    std::vector<X11Window> client_order_;          // Managed clients, oldest first
+    std::map<X11Window, int> client_desktops_;     // _NET_WM_DESKTOP to publish
+    std::map<std::pair<X11Window, xcb_atom_t>, std::string> published_;
+    
+    // Root children in stacking order, from the substructure events we
+    // already get. Clients left with nothing showing are marked
+    // _NET_WM_STATE_HIDDEN and their titlebars are not redrawn.
+    OcclusionTracker occlusion_;
+    std::set<X11Window> occluded_; // Clients
+    
+    // Clients on hidden workspaces (unmapped by us, WM_STATE Iconic), and
+    // how many of the UnmapNotify events still to come we caused ourselves
+    std::set<X11Window> iconic_;
+    std::map<X11Window, int> expected_unmaps_;
+    
+    // Client -> x, y, width, height last sent, so unchanged layouts send nothing
+    std::map<X11Window, std::array<int, 4>> configured_;
+    std::set<X11Window> floating_; // Clients that may configure themselves
     
-    // Monitor information
-    std::vector<Monitor> monitors_;
+    // Client -> scale bucket its decorations were last laid out for
+    std::map<X11Window, int> decoration_scale_;
+    
+    // Monitor information, from RandR. Output names keep the id they
+    // first got, so a monitor plugged back in is the same monitor again.
+    std::vector<Monitor> monitors_; // Primary first
+    std::map<std::string, int> monitor_ids_;
+    int next_monitor_id_ = 0;
+    int primary_monitor_id_ = -1;
+    int randr_event_base_ = -1;
+    bool monitors_dirty_ = false;   // Re-read the outputs after the event drain
+    bool monitors_changed_ = false; // Report MonitorsChanged from the next poll_events()
+    std::map<int, float> monitor_scales_; // Set by set_monitor_scale(), by monitor id
+    bool auto_scale_ = false; // Guess 2x for dense panels without an explicit scale
+    
+    // Docks (_NET_WM_WINDOW_TYPE_DOCK) are mapped but never framed or
+    // handed to the window manager; their struts shrink the work area
+    std::set<X11Window> docks_;
+    WorkAreaTracker work_areas_;
     
     // Decoration state
     bool decorations_enabled_;
+    bool frameless_ = false; // Native borders, no reparenting
     int border_width_;
     unsigned long border_color_;
     unsigned long focused_border_color_;
+    X11DecorationRenderer decorations_;
     
     // Linux/X11-specific state
-    bool compositor_enabled_;
-    bool ewmh_supported_;
-    bool randr_enabled_;
-    int current_virtual_desktop_;
+    bool compositor_enabled_ = false;
+    X11Compositor compositor_; // Active only while compositor_enabled_
+    bool ewmh_supported_ = false;
+    X11Window wm_check_window_ = 0; // _NET_SUPPORTING_WM_CHECK
+    bool randr_enabled_ = false;
+    int current_virtual_desktop_ = 0;
     std::vector<int> virtual_desktops_;
+    std::vector<std::string> desktop_names_; // From set_workspaces(), by desktop index
     bool panel_visible_;
     bool panel_auto_hide_;
     int panel_position_;
     Window system_tray_icon_;
     
-    // EWMH atoms
-    Atom _NET_WM_STATE_;
-    Atom _NET_WM_STATE_MAXIMIZED_VERT_;
-    Atom _NET_WM_STATE_MAXIMIZED_HORZ_;
-    Atom _NET_WM_STATE_FULLSCREEN_;
-    Atom _NET_WM_STATE_ABOVE_;
-    Atom _NET_WM_STATE_BELOW_;
-    Atom _NET_WM_WINDOW_TYPE_;
-    Atom _NET_WM_WINDOW_TYPE_DESKTOP_;
-    Atom _NET_WM_WINDOW_TYPE_DOCK_;
-    Atom _NET_WM_WINDOW_TYPE_TOOLBAR_;
-    Atom _NET_WM_WINDOW_TYPE_MENU_;
-    Atom _NET_WM_WINDOW_TYPE_UTILITY_;
-    Atom _NET_WM_WINDOW_TYPE_SPLASH_;
-    Atom _NET_WM_WINDOW_TYPE_DIALOG_;
-    Atom _NET_WM_WINDOW_TYPE_DROPDOWN_MENU_;
-    Atom _NET_WM_WINDOW_TYPE_POPUP_MENU_;
-    Atom _NET_WM_WINDOW_TYPE_TOOLTIP_;
-    Atom _NET_WM_WINDOW_TYPE_NOTIFICATION_;
-    Atom _NET_WM_WINDOW_TYPE_COMBO_;
-    Atom _NET_WM_WINDOW_TYPE_DND_;
-    Atom _NET_WM_WINDOW_TYPE_NORMAL_;
-    Atom _NET_WM_DESKTOP_;
-    Atom _NET_NUMBER_OF_DESKTOPS_;
-    Atom _NET_CURRENT_DESKTOP_;
-    Atom _NET_DESKTOP_NAMES_;
-    Atom _NET_WM_STRUT_;
-    Atom _NET_WM_STRUT_PARTIAL_;
-    Atom _NET_WM_OPACITY_;
+    // ICCCM/EWMH/private atoms, interned in one batch during initialize()
+    X11AtomTable atoms_;
     
     // Helper methods
     SRDWindow* get_focused_window() const;
+    static uint32_t key_modifiers_from_x(unsigned int state);
+    static uint16_t key_modifiers_to_x(uint32_t modifiers);
+    void handle_mapping_notify(XMappingEvent& event);
+    void flush_if_immediate();
+    X11Window toplevel_window(X11Window client) const; // Frame, or the client itself
+    Monitor monitor_at(int x, int y) const;
+    float window_scale(SRDWindow* window) const; // Scale of the monitor the window is on
+    const Metrics& metrics_for(SRDWindow* window) { return decorations_.metrics(window_scale(window)); }
+    
+    // Fullscreen helpers
+    void end_fullscreen(X11Window client, bool restore);
+    void fit_fullscreen(X11Window client, const Monitor& monitor);
+    void write_net_wm_state(X11Window client);
+    bool covered_by_fullscreen(SRDWindow* window) const;
+    bool fullscreen_active() const; // Some fullscreen window is on screen
+    bool titlebar_hidden(SRDWindow* window) const;
+    void resume_deferred_work();
+    
+    // Occlusion helpers
+    void track_stacking(const XEvent& event);
+    void update_occlusion();
+    
+    // ICCCM WM_STATE: NormalState or IconicState
+    void write_wm_state(X11Window client, uint32_t state);
+    bool configure_client(SRDWindow* window);
 
     // Private methods
     bool setup_x11_environment();
@@ -173,24 +290,56 @@ private:
     void setup_extensions();
     bool check_for_other_wm();
     
+    // Manage pipeline: request() for any number of clients, then collect
+    struct PendingManage {
+        X11Window window;
+        xcb_get_window_attributes_cookie_t attributes;
+        xcb_get_geometry_cookie_t geometry;
+        X11PropertyCache::Pending properties;
+    };
+    PendingManage request_manage(X11Window window);
+    SRDWindow* finish_manage(const PendingManage& pending, bool require_viewable = false);
+    
     // Event handlers
     void handle_map_request(XMapRequestEvent& event);
     void handle_configure_request(XConfigureRequestEvent& event);
     void handle_destroy_notify(XDestroyWindowEvent& event);
     void handle_unmap_notify(XUnmapEvent& event);
     void handle_key_press(XKeyEvent& event);
+    void handle_key_release(XKeyEvent& event);
     void handle_button_press(XButtonEvent& event);
     void handle_motion_notify(XMotionEvent& event);
+    void handle_expose(XExposeEvent& event);
+    void handle_property_notify(XPropertyEvent& event);
+    void apply_property_updates();
+    
+    // Dock methods
+    void manage_dock(X11Window dock, const X11ClientProperties& props, bool mapped);
+    void unmanage_dock(X11Window dock);
+    void publish_work_area();
     
     // Decoration methods
     void create_frame_window(SRDWindow* window);
     void destroy_frame_window(SRDWindow* window);
+    void release_frame(X11Window client, bool reparent); // Reparent unless the client is gone
     void draw_titlebar(SRDWindow* window);
+    void draw_titlebar(SRDWindow* window, int frame_width);
     void update_frame_geometry(SRDWindow* window);
+    X11Window titlebar_window(X11Window client) const;
+    
+    // Frameless decoration methods
+    void apply_native_border(X11Window client, bool focused);
+    void create_overlay_titlebar(SRDWindow* window);
+    void destroy_overlay_titlebar(X11Window client);
+    void update_overlay_geometry(SRDWindow* window, int x, int y, int width);
     
     // EWMH methods
-    void setup_ewmh();
+    bool setup_ewmh();
     void update_ewmh_desktop_info();
+    void publish_ewmh();
+    void publish_property(X11Window window, X11Atom property, xcb_atom_t type, uint8_t format, uint32_t count,
+                          const void* data);
+    void forget_published(X11Window window);
     void handle_ewmh_message(XClientMessageEvent& event);
     
     // Virtual Desktop methods
@@ -199,6 +348,7 @@ private:
     
     // RandR methods
     void initialize_randr();
+    bool refresh_monitors(); // True if the monitor set changed
     void cleanup_randr();
     
     // Panel methods
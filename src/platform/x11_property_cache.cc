@@ -0,0 +1,307 @@
+#include "x11_property_cache.h"
+#include "x11_xcb.h"
+#include <algorithm>
+#include <cstring>
+
+#include <xcb/xcbext.h> // xcb_poll_for_reply
+
+namespace {
+
+// Upper bound (in 32-bit units) read for each property
+constexpr std::array<uint32_t, kX11ClientPropertyCount> kPropertyLength = {{
+    64,                                     // WM_CLASS
+    256,                                    // WM_NAME
+    256,                                    // _NET_WM_NAME
+    32,                                     // _NET_WM_WINDOW_TYPE
+    32,                                     // _NET_WM_STATE
+    XCB_ICCCM_NUM_WM_SIZE_HINTS_ELEMENTS,   // WM_NORMAL_HINTS
+    XCB_ICCCM_NUM_WM_HINTS_ELEMENTS,        // WM_HINTS
+    32,                                     // WM_PROTOCOLS
+    1,                                      // WM_TRANSIENT_FOR
+    1,                                      // _NET_WM_PID
+    4,                                      // _NET_WM_STRUT
+    12                                      // _NET_WM_STRUT_PARTIAL
+}};
+
+std::vector<xcb_atom_t> property_atoms(const xcb_get_property_reply_t* reply) {
+    std::vector<xcb_atom_t> atoms;
+    if (!reply || reply->format != 32) return atoms;
+    const xcb_atom_t* values = static_cast<const xcb_atom_t*>(xcb_get_property_value(reply));
+    int count = xcb_get_property_value_length(reply) / 4;
+    atoms.assign(values, values + std::max(0, count));
+    return atoms;
+}
+
+uint32_t property_cardinal(const xcb_get_property_reply_t* reply) {
+    if (!reply || reply->format != 32 || xcb_get_property_value_length(reply) < 4) return 0;
+    return *static_cast<const uint32_t*>(xcb_get_property_value(reply));
+}
+
+std::vector<uint32_t> property_cardinals(const xcb_get_property_reply_t* reply) {
+    std::vector<uint32_t> cardinals;
+    if (!reply || reply->format != 32) return cardinals;
+    const uint32_t* values = static_cast<const uint32_t*>(xcb_get_property_value(reply));
+    int count = xcb_get_property_value_length(reply) / 4;
+    cardinals.assign(values, values + std::max(0, count));
+    return cardinals;
+}
+
+bool contains(const std::vector<xcb_atom_t>& atoms, xcb_atom_t atom) {
+    return atom != XCB_ATOM_NONE && std::find(atoms.begin(), atoms.end(), atom) != atoms.end();
+}
+
+} // namespace
+
+bool X11ClientProperties::has_window_type(xcb_atom_t type) const {
+    return contains(window_type, type);
+}
+
+bool X11ClientProperties::has_state(xcb_atom_t state_atom) const {
+    return contains(state, state_atom);
+}
+
+bool X11ClientProperties::supports_protocol(xcb_atom_t protocol) const {
+    return contains(protocols, protocol);
+}
+
+void X11PropertyCache::set_atom(X11ClientProperty property, xcb_atom_t atom) {
+    atoms_[index(property)] = atom;
+}
+
+X11PropertyCache::Pending X11PropertyCache::request(xcb_connection_t* conn, xcb_window_t window) const {
+    Pending pending;
+    pending.window = window;
+    for (size_t i = 0; i < kX11ClientPropertyCount; ++i) {
+        if (atoms_[i] == XCB_ATOM_NONE) continue; // Atom could not be interned
+        // Unchecked: a client that vanished just yields null replies
+        pending.cookies[i] = xcb_get_property_unchecked(conn, 0, window, atoms_[i],
+                                                        XCB_GET_PROPERTY_TYPE_ANY, 0, kPropertyLength[i]);
+    }
+    return pending;
+}
+
+const X11ClientProperties& X11PropertyCache::collect(xcb_connection_t* conn, const Pending& pending) {
+    X11ClientProperties props;
+    for (size_t i = 0; i < kX11ClientPropertyCount; ++i) {
+        if (atoms_[i] == XCB_ATOM_NONE) continue;
+        auto reply = xcb_take(xcb_get_property_reply(conn, pending.cookies[i], nullptr));
+        decode(static_cast<X11ClientProperty>(i), reply.get(), props);
+    }
+
+    X11ClientProperties& entry = entries_[pending.window];
+    entry = std::move(props);
+    return entry;
+}
+
+const X11ClientProperties* X11PropertyCache::find(xcb_window_t window) const {
+    auto it = entries_.find(window);
+    return it != entries_.end() ? &it->second : nullptr;
+}
+
+void X11PropertyCache::erase(xcb_window_t window) {
+    // Outstanding refetches still get their replies consumed in
+    // poll_updates(); they are simply dropped there
+    entries_.erase(window);
+}
+
+void X11PropertyCache::clear() {
+    entries_.clear();
+    refetches_.clear();
+    unsent_.clear();
+}
+
+bool X11PropertyCache::property_for_atom(xcb_atom_t atom, X11ClientProperty& property) const {
+    if (atom == XCB_ATOM_NONE) return false;
+    for (size_t i = 0; i < kX11ClientPropertyCount; ++i) {
+        if (atoms_[i] == atom) {
+            property = static_cast<X11ClientProperty>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void X11PropertyCache::invalidate(xcb_connection_t* conn, xcb_window_t window, X11ClientProperty property) {
+    size_t i = index(property);
+    if (atoms_[i] == XCB_ATOM_NONE || entries_.find(window) == entries_.end()) return;
+    if (!unsent_.insert({window, i}).second) return;
+
+    Refetch refetch;
+    refetch.window = window;
+    refetch.property = property;
+    refetch.cookie = xcb_get_property_unchecked(conn, 0, window, atoms_[i], XCB_GET_PROPERTY_TYPE_ANY, 0,
+                                                kPropertyLength[i]);
+    refetches_.push_back(refetch);
+}
+
+std::vector<xcb_window_t> X11PropertyCache::poll_updates(xcb_connection_t* conn) {
+    std::vector<xcb_window_t> changed;
+    unsent_.clear();
+
+    // Replies arrive in request order; stop at the first one still in flight
+    while (!refetches_.empty()) {
+        const Refetch& refetch = refetches_.front();
+        void* raw = nullptr;
+        xcb_generic_error_t* error = nullptr;
+        if (!xcb_poll_for_reply(conn, refetch.cookie.sequence, &raw, &error)) {
+            break;
+        }
+        auto reply = xcb_take(static_cast<xcb_get_property_reply_t*>(raw));
+        XcbReply<xcb_generic_error_t> owned_error = xcb_take(error);
+
+        auto it = entries_.find(refetch.window);
+        if (it != entries_.end() && !owned_error) {
+            X11ClientProperties decoded;
+            decode(refetch.property, reply.get(), decoded);
+            X11ClientProperties& entry = it->second;
+            if (!same_value(refetch.property, entry, decoded)) {
+                copy_value(refetch.property, decoded, entry);
+                ++entry.generations[index(refetch.property)];
+                ++entry.generation;
+                if (changed.empty() || changed.back() != refetch.window) {
+                    changed.push_back(refetch.window);
+                }
+            }
+        }
+        refetches_.pop_front();
+    }
+
+    return changed;
+}
+
+bool X11PropertyCache::same_value(X11ClientProperty property, const X11ClientProperties& a,
+                                  const X11ClientProperties& b) {
+    switch (property) {
+        case X11ClientProperty::WmClass:
+            return a.wm_class_instance == b.wm_class_instance && a.wm_class_class == b.wm_class_class;
+        case X11ClientProperty::WmName:
+            return a.wm_name == b.wm_name;
+        case X11ClientProperty::NetWmName:
+            return a.net_wm_name == b.net_wm_name;
+        case X11ClientProperty::NetWmWindowType:
+            return a.window_type == b.window_type;
+        case X11ClientProperty::NetWmState:
+            return a.state == b.state;
+        case X11ClientProperty::WmNormalHints:
+            return a.has_normal_hints == b.has_normal_hints &&
+                   std::memcmp(&a.normal_hints, &b.normal_hints, sizeof(a.normal_hints)) == 0;
+        case X11ClientProperty::WmHints:
+            return a.has_hints == b.has_hints && std::memcmp(&a.hints, &b.hints, sizeof(a.hints)) == 0;
+        case X11ClientProperty::WmProtocols:
+            return a.protocols == b.protocols;
+        case X11ClientProperty::WmTransientFor:
+            return a.transient_for == b.transient_for;
+        case X11ClientProperty::NetWmPid:
+            return a.pid == b.pid;
+        case X11ClientProperty::NetWmStrut:
+            return a.strut == b.strut;
+        case X11ClientProperty::NetWmStrutPartial:
+            return a.strut_partial == b.strut_partial;
+        case X11ClientProperty::Count:
+            break;
+    }
+    return true;
+}
+
+void X11PropertyCache::copy_value(X11ClientProperty property, const X11ClientProperties& from,
+                                  X11ClientProperties& to) {
+    switch (property) {
+        case X11ClientProperty::WmClass:
+            to.wm_class_instance = from.wm_class_instance;
+            to.wm_class_class = from.wm_class_class;
+            break;
+        case X11ClientProperty::WmName:
+            to.wm_name = from.wm_name;
+            break;
+        case X11ClientProperty::NetWmName:
+            to.net_wm_name = from.net_wm_name;
+            break;
+        case X11ClientProperty::NetWmWindowType:
+            to.window_type = from.window_type;
+            break;
+        case X11ClientProperty::NetWmState:
+            to.state = from.state;
+            break;
+        case X11ClientProperty::WmNormalHints:
+            to.normal_hints = from.normal_hints;
+            to.has_normal_hints = from.has_normal_hints;
+            break;
+        case X11ClientProperty::WmHints:
+            to.hints = from.hints;
+            to.has_hints = from.has_hints;
+            break;
+        case X11ClientProperty::WmProtocols:
+            to.protocols = from.protocols;
+            break;
+        case X11ClientProperty::WmTransientFor:
+            to.transient_for = from.transient_for;
+            break;
+        case X11ClientProperty::NetWmPid:
+            to.pid = from.pid;
+            break;
+        case X11ClientProperty::NetWmStrut:
+            to.strut = from.strut;
+            break;
+        case X11ClientProperty::NetWmStrutPartial:
+            to.strut_partial = from.strut_partial;
+            break;
+        case X11ClientProperty::Count:
+            break;
+    }
+}
+
+void X11PropertyCache::decode(X11ClientProperty property, xcb_get_property_reply_t* reply,
+                              X11ClientProperties& props) {
+    switch (property) {
+        case X11ClientProperty::WmClass: {
+            // Two consecutive NUL-terminated strings: instance, then class
+            std::string value = xcb_property_string(reply);
+            size_t split = value.find('\0');
+            props.wm_class_instance = value.substr(0, split);
+            if (split != std::string::npos) {
+                std::string rest = value.substr(split + 1);
+                props.wm_class_class = rest.substr(0, rest.find('\0'));
+            } else {
+                props.wm_class_class.clear();
+            }
+            break;
+        }
+        case X11ClientProperty::WmName:
+            props.wm_name = xcb_property_string(reply);
+            break;
+        case X11ClientProperty::NetWmName:
+            props.net_wm_name = xcb_property_string(reply);
+            break;
+        case X11ClientProperty::NetWmWindowType:
+            props.window_type = property_atoms(reply);
+            break;
+        case X11ClientProperty::NetWmState:
+            props.state = property_atoms(reply);
+            break;
+        case X11ClientProperty::WmNormalHints:
+            props.normal_hints = xcb_size_hints_t{};
+            props.has_normal_hints = reply && xcb_icccm_get_wm_size_hints_from_reply(&props.normal_hints, reply);
+            break;
+        case X11ClientProperty::WmHints:
+            props.hints = xcb_icccm_wm_hints_t{};
+            props.has_hints = reply && xcb_icccm_get_wm_hints_from_reply(&props.hints, reply);
+            break;
+        case X11ClientProperty::WmProtocols:
+            props.protocols = property_atoms(reply);
+            break;
+        case X11ClientProperty::WmTransientFor:
+            props.transient_for = property_cardinal(reply);
+            break;
+        case X11ClientProperty::NetWmPid:
+            props.pid = property_cardinal(reply);
+            break;
+        case X11ClientProperty::NetWmStrut:
+            props.strut = property_cardinals(reply);
+            break;
+        case X11ClientProperty::NetWmStrutPartial:
+            props.strut_partial = property_cardinals(reply);
+            break;
+        case X11ClientProperty::Count:
+            break;
+    }
+}
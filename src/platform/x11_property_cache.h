@@ -0,0 +1,143 @@
+#ifndef SRDWM_X11_PROPERTY_CACHE_H
+#define SRDWM_X11_PROPERTY_CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <xcb/xcb.h>
+#include <xcb/xcb_icccm.h>
+
+// Client properties read when a window is managed
+enum class X11ClientProperty {
+    WmClass,
+    WmName,
+    NetWmName,
+    NetWmWindowType,
+    NetWmState,
+    WmNormalHints,
+    WmHints,
+    WmProtocols,
+    WmTransientFor,
+    NetWmPid,
+    NetWmStrut,
+    NetWmStrutPartial,
+    Count
+};
+
+constexpr size_t kX11ClientPropertyCount = static_cast<size_t>(X11ClientProperty::Count);
+
+// Decoded client properties, as last read from the server
+struct X11ClientProperties {
+    std::string wm_class_instance;
+    std::string wm_class_class;
+    std::string wm_name;
+    std::string net_wm_name;
+    std::vector<xcb_atom_t> window_type;
+    std::vector<xcb_atom_t> state;
+    xcb_size_hints_t normal_hints{};
+    bool has_normal_hints = false;
+    xcb_icccm_wm_hints_t hints{};
+    bool has_hints = false;
+    std::vector<xcb_atom_t> protocols;
+    xcb_window_t transient_for = XCB_WINDOW_NONE;
+    uint32_t pid = 0;
+    std::vector<uint32_t> strut;         // _NET_WM_STRUT: left, right, top, bottom
+    std::vector<uint32_t> strut_partial; // _NET_WM_STRUT_PARTIAL: the same plus 8 edge ranges
+
+    // Bumped whenever the decoded value changes: `generation` for any
+    // property, `generations[p]` for property p. Consumers remember the
+    // number they last saw instead of comparing values.
+    uint64_t generation = 0;
+    std::array<uint32_t, kX11ClientPropertyCount> generations{};
+    uint32_t generation_of(X11ClientProperty property) const {
+        return generations[static_cast<size_t>(property)];
+    }
+
+    // _NET_WM_NAME (UTF-8) wins over the legacy WM_NAME
+    const std::string& title() const { return net_wm_name.empty() ? wm_name : net_wm_name; }
+    bool has_window_type(xcb_atom_t type) const;
+    bool has_state(xcb_atom_t state_atom) const;
+    bool supports_protocol(xcb_atom_t protocol) const;
+};
+
+// Per-window cache of client properties.
+//
+// request() fires one GetProperty per property without waiting, collect()
+// gathers the replies and stores the decoded result. Issuing request() for
+// several windows before collecting any of them pipelines the whole batch
+// into a single round-trip.
+//
+// After that the cache is kept current by PropertyNotify: invalidate()
+// refetches just the property that changed, and poll_updates() applies
+// replies that have already arrived without ever blocking on one. Until
+// then readers see the previous value.
+class X11PropertyCache {
+public:
+    struct Pending {
+        xcb_window_t window = XCB_WINDOW_NONE;
+        std::array<xcb_get_property_cookie_t, kX11ClientPropertyCount> cookies{};
+    };
+
+    // Property atoms; predefined atoms are filled in, the rest are interned
+    // by the platform and handed over once at startup
+    void set_atom(X11ClientProperty property, xcb_atom_t atom);
+    xcb_atom_t atom(X11ClientProperty property) const { return atoms_[index(property)]; }
+
+    Pending request(xcb_connection_t* conn, xcb_window_t window) const;
+    const X11ClientProperties& collect(xcb_connection_t* conn, const Pending& pending);
+
+    const X11ClientProperties* find(xcb_window_t window) const;
+    void erase(xcb_window_t window);
+    void clear();
+
+    // Map an atom from a PropertyNotify to the property it carries
+    bool property_for_atom(xcb_atom_t atom, X11ClientProperty& property) const;
+
+    // Queue a refetch of one property of a cached window
+    void invalidate(xcb_connection_t* conn, xcb_window_t window, X11ClientProperty property);
+
+    // Apply refetched values whose replies are in; returns the windows
+    // whose properties changed
+    std::vector<xcb_window_t> poll_updates(xcb_connection_t* conn);
+
+private:
+    struct Refetch {
+        xcb_window_t window;
+        X11ClientProperty property;
+        xcb_get_property_cookie_t cookie;
+    };
+
+    static size_t index(X11ClientProperty property) { return static_cast<size_t>(property); }
+    static bool same_value(X11ClientProperty property, const X11ClientProperties& a, const X11ClientProperties& b);
+    static void copy_value(X11ClientProperty property, const X11ClientProperties& from, X11ClientProperties& to);
+    static void decode(X11ClientProperty property, xcb_get_property_reply_t* reply,
+                       X11ClientProperties& props);
+
+    std::array<xcb_atom_t, kX11ClientPropertyCount> atoms_{{
+        XCB_ATOM_WM_CLASS,
+        XCB_ATOM_WM_NAME,
+        XCB_ATOM_NONE,
+        XCB_ATOM_NONE,
+        XCB_ATOM_NONE,
+        XCB_ATOM_WM_NORMAL_HINTS,
+        XCB_ATOM_WM_HINTS,
+        XCB_ATOM_NONE,
+        XCB_ATOM_WM_TRANSIENT_FOR,
+        XCB_ATOM_NONE,
+        XCB_ATOM_NONE,
+        XCB_ATOM_NONE
+    }};
+    std::map<xcb_window_t, X11ClientProperties> entries_;
+    std::deque<Refetch> refetches_; // In request order, as replies arrive
+    // Refetches issued since the last poll; they are still unsent, so a
+    // second notify for the same property in one batch needs no request
+    std::set<std::pair<xcb_window_t, size_t>> unsent_;
+};
+
+#endif // SRDWM_X11_PROPERTY_CACHE_H
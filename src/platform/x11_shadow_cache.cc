@@ -0,0 +1,188 @@
+#include "x11_shadow_cache.h"
+#include "../utils/blur.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Shadows use a Gaussian of sigma radius / 2, as most compositors do
+double shadow_sigma(int radius) {
+    return std::max(1.0, radius / 2.0);
+}
+
+} // namespace
+
+X11ShadowCache::~X11ShadowCache() {
+    clear();
+}
+
+void X11ShadowCache::initialize(Display* display, Window root) {
+    clear();
+    display_ = display;
+    root_ = root;
+    format_ = XRenderFindStandardFormat(display_, PictStandardA8);
+}
+
+void X11ShadowCache::clear() {
+    if (!display_) return;
+
+    for (auto& pair : strips_) {
+        XRenderFreePicture(display_, pair.second.corners);
+        XRenderFreePicture(display_, pair.second.columns);
+        XRenderFreePicture(display_, pair.second.rows);
+        XRenderFreePicture(display_, pair.second.center);
+    }
+    strips_.clear();
+    for (auto& pair : small_masks_) {
+        XRenderFreePicture(display_, pair.second);
+    }
+    small_masks_.clear();
+
+    if (gc_) XFreeGC(display_, gc_);
+    gc_ = nullptr;
+    display_ = nullptr;
+}
+
+int X11ShadowCache::extent(int radius) {
+    return Blur::gaussian_extent(shadow_sigma(radius));
+}
+
+void X11ShadowCache::paint(Picture source, Picture dest, int x, int y, int width, int height, int radius,
+                           unsigned char opacity) {
+    if (!display_ || width <= 0 || height <= 0 || opacity == 0) return;
+
+    const int e = extent(radius);
+    const int total_width = width + 2 * e;
+    const int total_height = height + 2 * e;
+
+    // Corners are only independent of the far edge when the box is at
+    // least 2 * extent across
+    const int c = 2 * e;
+    if (width < c || height < c) {
+        if (Picture mask = small_mask(width, height, radius, opacity)) {
+            XRenderComposite(display_, PictOpOver, source, mask, dest, 0, 0, 0, 0, x, y,
+                             static_cast<unsigned int>(total_width), static_cast<unsigned int>(total_height));
+        }
+        return;
+    }
+
+    const Strips& s = strips(radius, opacity);
+    const int size = 4 * e + 1;
+    const int far_offset = size - c; // Template offset of the right and bottom corners
+
+    const int xs[3] = {0, c, total_width - c};
+    const int ws[3] = {c, total_width - 2 * c, c};
+    const int ys[3] = {0, c, total_height - c};
+    const int hs[3] = {c, total_height - 2 * c, c};
+
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            if (ws[col] <= 0 || hs[row] <= 0) continue;
+
+            Picture mask;
+            int mask_x = col == 2 ? far_offset : 0;
+            int mask_y = row == 2 ? far_offset : 0;
+            if (row != 1 && col != 1) {
+                mask = s.corners;
+            } else if (row != 1) {
+                mask = s.columns;
+                mask_x = 0;
+            } else if (col != 1) {
+                mask = s.rows;
+                mask_y = 0;
+            } else {
+                mask = s.center;
+                mask_x = mask_y = 0;
+            }
+            XRenderComposite(display_, PictOpOver, source, mask, dest, 0, 0, mask_x, mask_y, x + xs[col],
+                             y + ys[row], static_cast<unsigned int>(ws[col]), static_cast<unsigned int>(hs[row]));
+        }
+    }
+}
+
+const X11ShadowCache::Strips& X11ShadowCache::strips(int radius, unsigned char opacity) {
+    auto key = std::make_pair(radius, opacity);
+    auto it = strips_.find(key);
+    if (it != strips_.end()) return it->second;
+
+    // A box of 2 * extent + 1 leaves one pixel of flat middle between
+    // the corners in each direction
+    const int e = extent(radius);
+    const int box = 2 * e + 1;
+    const int size = box + 2 * e;
+
+    Strips entry;
+    char* data = render_mask(box, box, radius, opacity);
+    if (data) {
+        XImage* image = XCreateImage(display_, DefaultVisual(display_, DefaultScreen(display_)), 8, ZPixmap, 0, data,
+                                     static_cast<unsigned int>(size), static_cast<unsigned int>(size), 8, size);
+        entry.corners = upload(image, 0, 0, size, size, false);
+        entry.columns = upload(image, 2 * e, 0, 1, size, true);
+        entry.rows = upload(image, 0, 2 * e, size, 1, true);
+        entry.center = upload(image, 2 * e, 2 * e, 1, 1, true);
+        XDestroyImage(image);
+    }
+    return strips_.emplace(key, entry).first->second;
+}
+
+Picture X11ShadowCache::small_mask(int width, int height, int radius, unsigned char opacity) {
+    auto key = std::make_tuple(radius, opacity, width, height);
+    auto it = small_masks_.find(key);
+    if (it != small_masks_.end()) return it->second;
+
+    if (small_masks_.size() >= kMaxSmallMasks) {
+        for (auto& pair : small_masks_) {
+            XRenderFreePicture(display_, pair.second);
+        }
+        small_masks_.clear();
+    }
+
+    const int e = extent(radius);
+    const int total_width = width + 2 * e;
+    const int total_height = height + 2 * e;
+    char* data = render_mask(width, height, radius, opacity);
+    if (!data) return 0;
+
+    XImage* image = XCreateImage(display_, DefaultVisual(display_, DefaultScreen(display_)), 8, ZPixmap, 0, data,
+                                 static_cast<unsigned int>(total_width), static_cast<unsigned int>(total_height), 8,
+                                 total_width);
+    Picture mask = upload(image, 0, 0, total_width, total_height, false);
+    XDestroyImage(image);
+    small_masks_[key] = mask;
+    return mask;
+}
+
+char* X11ShadowCache::render_mask(int width, int height, int radius, unsigned char opacity) const {
+    const int e = extent(radius);
+    const int total_width = width + 2 * e;
+    const int total_height = height + 2 * e;
+
+    // XDestroyImage frees the data, so it must come from malloc
+    const size_t bytes = static_cast<size_t>(total_width) * static_cast<size_t>(total_height);
+    uint8_t* data = static_cast<uint8_t*>(std::malloc(bytes));
+    if (!data) return nullptr;
+    std::memset(data, 0, bytes);
+    for (int y = e; y < e + height; ++y) {
+        std::memset(data + static_cast<size_t>(y) * total_width + e, opacity, static_cast<size_t>(width));
+    }
+
+    Blur::gaussian_blur(data, total_width, total_height, 1, shadow_sigma(radius), Blur::Edge::Transparent);
+    return reinterpret_cast<char*>(data);
+}
+
+Picture X11ShadowCache::upload(XImage* image, int x, int y, int width, int height, bool repeat) {
+    Pixmap pixmap = XCreatePixmap(display_, root_, static_cast<unsigned int>(width),
+                                  static_cast<unsigned int>(height), 8);
+    if (!gc_) {
+        gc_ = XCreateGC(display_, pixmap, 0, nullptr);
+    }
+    XPutImage(display_, pixmap, gc_, image, x, y, 0, 0, static_cast<unsigned int>(width),
+              static_cast<unsigned int>(height));
+
+    XRenderPictureAttributes attributes;
+    attributes.repeat = repeat ? RepeatNormal : RepeatNone;
+    Picture picture = XRenderCreatePicture(display_, pixmap, format_, CPRepeat, &attributes);
+    XFreePixmap(display_, pixmap); // The picture keeps it alive
+    return picture;
+}
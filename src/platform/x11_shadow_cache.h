@@ -0,0 +1,69 @@
+#ifndef SRDWM_X11_SHADOW_CACHE_H
+#define SRDWM_X11_SHADOW_CACHE_H
+
+#include <map>
+#include <tuple>
+
+#include <X11/Xlib.h>
+#include <X11/extensions/Xrender.h>
+
+// Drop shadow masks drawn as nine pieces.
+//
+// A blurred rectangle only varies within twice the blur extent of its
+// edges: the corners are fixed, each edge is the same row or column
+// repeated, and the middle is flat. So for each (radius, opacity) one
+// small template is blurred on the CPU (Blur::gaussian_blur) and split
+// into a corner picture, two 1-pixel repeating strips and a 1x1 centre;
+// a shadow of any size is then nine XRenderComposite calls, and resizing
+// a window costs nothing.
+//
+// Boxes too small for the corners to be independent get a mask of their
+// own, kept in a small cache keyed by size as well.
+class X11ShadowCache {
+public:
+    X11ShadowCache() = default;
+    ~X11ShadowCache();
+
+    X11ShadowCache(const X11ShadowCache&) = delete;
+    X11ShadowCache& operator=(const X11ShadowCache&) = delete;
+
+    void initialize(Display* display, Window root);
+    void clear();
+
+    // Pixels the shadow of a box spreads past each of its edges
+    static int extent(int radius);
+
+    // Composite source through the shadow of a width x height box onto
+    // dest; (x, y) is the top-left of the shadow, extent(radius) above
+    // and left of the box
+    void paint(Picture source, Picture dest, int x, int y, int width, int height, int radius,
+               unsigned char opacity);
+
+private:
+    static constexpr size_t kMaxSmallMasks = 64;
+
+    struct Strips {
+        Picture corners = 0; // The whole template; corners are read from it
+        Picture columns = 0; // 1 x size, repeats along x (top and bottom edges)
+        Picture rows = 0;    // size x 1, repeats along y (left and right edges)
+        Picture center = 0;  // 1x1, repeats
+    };
+
+    const Strips& strips(int radius, unsigned char opacity);
+    Picture small_mask(int width, int height, int radius, unsigned char opacity);
+
+    // Blurred mask of a box of opacity, padded by extent(radius) on
+    // every side; malloc'd for XCreateImage
+    char* render_mask(int width, int height, int radius, unsigned char opacity) const;
+    Picture upload(XImage* image, int x, int y, int width, int height, bool repeat);
+
+    Display* display_ = nullptr;
+    Window root_ = 0;
+    GC gc_ = nullptr;
+    XRenderPictFormat* format_ = nullptr;
+
+    std::map<std::pair<int, unsigned char>, Strips> strips_;
+    std::map<std::tuple<int, unsigned char, int, int>, Picture> small_masks_;
+};
+
+#endif // SRDWM_X11_SHADOW_CACHE_H
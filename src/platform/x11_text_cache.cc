@@ -0,0 +1,54 @@
+#include "x11_text_cache.h"
+#include <functional>
+
+size_t X11TextLayoutCache::KeyHash::operator()(const Key& key) const {
+    size_t h = std::hash<std::string>()(key.text);
+    h ^= std::hash<const void*>()(key.font) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= std::hash<int>()(key.max_width) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+X11TextLayoutCache::X11TextLayoutCache(size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1) {
+}
+
+void X11TextLayoutCache::set_capacity(size_t capacity) {
+    capacity_ = capacity > 0 ? capacity : 1;
+    evict();
+}
+
+const X11TextRun* X11TextLayoutCache::find(const std::string& text, const void* font, int max_width) {
+    auto it = index_.find(Key{text, font, max_width});
+    if (it == index_.end()) return nullptr;
+
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->run;
+}
+
+const X11TextRun& X11TextLayoutCache::insert(const std::string& text, const void* font, int max_width,
+                                             X11TextRun run) {
+    Key key{text, font, max_width};
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->run = std::move(run);
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->run;
+    }
+
+    entries_.push_front(Entry{key, std::move(run)});
+    index_.emplace(std::move(key), entries_.begin());
+    evict();
+    return entries_.front().run;
+}
+
+void X11TextLayoutCache::clear() {
+    index_.clear();
+    entries_.clear();
+}
+
+void X11TextLayoutCache::evict() {
+    while (entries_.size() > capacity_) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef SRDWM_X11_TEXT_CACHE_H
+#define SRDWM_X11_TEXT_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Laid-out titlebar text: the string after ellipsizing to fit, the glyph
+// indices to draw it with (Xft only; empty for core fonts) and its width
+struct X11TextRun {
+    std::string text;
+    std::vector<unsigned int> glyphs;
+    int width = 0;
+};
+
+// LRU cache of laid-out text keyed by (text, font, max width).
+//
+// Clients that rewrite their title several times per second tend to cycle
+// through a handful of strings; keeping their layouts means only a string
+// not seen recently is measured and shaped again.
+class X11TextLayoutCache {
+public:
+    explicit X11TextLayoutCache(size_t capacity = 100);
+
+    // Shrinking evicts the least recently used entries
+    void set_capacity(size_t capacity);
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return entries_.size(); }
+
+    // Returns nullptr on a miss; a hit becomes the most recently used entry
+    const X11TextRun* find(const std::string& text, const void* font, int max_width);
+    const X11TextRun& insert(const std::string& text, const void* font, int max_width, X11TextRun run);
+
+    void clear();
+
+private:
+    struct Key {
+        std::string text;
+        const void* font;
+        int max_width;
+        bool operator==(const Key& other) const {
+            return font == other.font && max_width == other.max_width && text == other.text;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Entry {
+        Key key;
+        X11TextRun run;
+    };
+
+    void evict();
+
+    size_t capacity_;
+    std::list<Entry> entries_; // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+};
+
+#endif // SRDWM_X11_TEXT_CACHE_H
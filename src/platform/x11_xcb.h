@@ -0,0 +1,38 @@
+#ifndef SRDWM_X11_XCB_H
+#define SRDWM_X11_XCB_H
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <xcb/xcb.h>
+
+// Helpers for the XCB side of the X11 backend.
+//
+// Requests are issued as cookies and the replies are collected later, so a
+// caller can fire every query it needs before blocking once on the first
+// reply. Replies are malloc()'d by libxcb and must be released with free().
+
+struct XcbFree {
+    void operator()(void* p) const { std::free(p); }
+};
+
+template <typename T>
+using XcbReply = std::unique_ptr<T, XcbFree>;
+
+// Wrap a raw reply pointer returned by an xcb_*_reply() call
+template <typename T>
+inline XcbReply<T> xcb_take(T* reply) {
+    return XcbReply<T>(reply);
+}
+
+// Extract a Latin-1/UTF-8 string property value (e.g. WM_NAME, _NET_WM_NAME)
+inline std::string xcb_property_string(const xcb_get_property_reply_t* reply) {
+    if (!reply || reply->format != 8) return std::string();
+    int len = xcb_get_property_value_length(reply);
+    if (len <= 0) return std::string();
+    const char* value = static_cast<const char*>(xcb_get_property_value(reply));
+    return std::string(value, static_cast<size_t>(len));
+}
+
+#endif // SRDWM_X11_XCB_H
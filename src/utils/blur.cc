@@ -0,0 +1,266 @@
+#include "blur.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SRDWM_BLUR_X86 1
+#include <immintrin.h>
+#else
+#define SRDWM_BLUR_X86 0
+#endif
+
+namespace Blur {
+
+namespace {
+
+constexpr int kMaxRadius = 127; // Keeps sum * reciprocal within 32 bits
+
+// Source rows for one column pass; rows outside the image come from the
+// edge row or a row of zeros
+struct Rows {
+    const uint8_t* pixels;
+    const uint8_t* zero;
+    int columns;
+    int count;
+    Edge edge;
+
+    const uint8_t* operator[](int y) const {
+        if (y < 0) return edge == Edge::Clamp ? pixels : zero;
+        if (y >= count) return edge == Edge::Clamp ? pixels + static_cast<size_t>(count - 1) * columns : zero;
+        return pixels + static_cast<size_t>(y) * columns;
+    }
+};
+
+// Division by the window size as a 16.16 fixed-point multiply
+uint32_t reciprocal(int radius) {
+    uint32_t size = static_cast<uint32_t>(2 * radius + 1);
+    return (65536u + size / 2) / size;
+}
+
+void init_sums(const Rows& rows, int radius, uint32_t* sums) {
+    std::fill(sums, sums + rows.columns, 0u);
+    for (int y = -radius; y <= radius; ++y) {
+        const uint8_t* row = rows[y];
+        for (int c = 0; c < rows.columns; ++c) sums[c] += row[c];
+    }
+}
+
+// Columns [begin, end) of one output row, then slide the window down
+inline void step_scalar(uint32_t* sums, const uint8_t* add, const uint8_t* sub, uint8_t* out, int begin, int end,
+                        uint32_t mul) {
+    for (int c = begin; c < end; ++c) {
+        out[c] = static_cast<uint8_t>((sums[c] * mul + 32768u) >> 16);
+        sums[c] = sums[c] + add[c] - sub[c];
+    }
+}
+
+void columns_scalar(const Rows& rows, uint8_t* dst, int radius, uint32_t* sums) {
+    const uint32_t mul = reciprocal(radius);
+    init_sums(rows, radius, sums);
+    for (int y = 0; y < rows.count; ++y) {
+        step_scalar(sums, rows[y + radius + 1], rows[y - radius], dst + static_cast<size_t>(y) * rows.columns, 0,
+                    rows.columns, mul);
+    }
+}
+
+#if SRDWM_BLUR_X86
+
+__attribute__((target("sse4.1")))
+void columns_sse41(const Rows& rows, uint8_t* dst, int radius, uint32_t* sums) {
+    const uint32_t mul = reciprocal(radius);
+    const __m128i mulv = _mm_set1_epi32(static_cast<int>(mul));
+    const __m128i half = _mm_set1_epi32(32768);
+    init_sums(rows, radius, sums);
+
+    const int vector_end = rows.columns & ~3;
+    for (int y = 0; y < rows.count; ++y) {
+        const uint8_t* add = rows[y + radius + 1];
+        const uint8_t* sub = rows[y - radius];
+        uint8_t* out = dst + static_cast<size_t>(y) * rows.columns;
+
+        for (int c = 0; c < vector_end; c += 4) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + c));
+            __m128i v = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(s, mulv), half), 16);
+            v = _mm_packus_epi16(_mm_packus_epi32(v, v), v);
+            int packed = _mm_cvtsi128_si32(v);
+            std::memcpy(out + c, &packed, 4);
+
+            int a, b;
+            std::memcpy(&a, add + c, 4);
+            std::memcpy(&b, sub + c, 4);
+            s = _mm_add_epi32(s, _mm_cvtepu8_epi32(_mm_cvtsi32_si128(a)));
+            s = _mm_sub_epi32(s, _mm_cvtepu8_epi32(_mm_cvtsi32_si128(b)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + c), s);
+        }
+        step_scalar(sums, add, sub, out, vector_end, rows.columns, mul);
+    }
+}
+
+__attribute__((target("avx2")))
+void columns_avx2(const Rows& rows, uint8_t* dst, int radius, uint32_t* sums) {
+    const uint32_t mul = reciprocal(radius);
+    const __m256i mulv = _mm256_set1_epi32(static_cast<int>(mul));
+    const __m256i half = _mm256_set1_epi32(32768);
+    init_sums(rows, radius, sums);
+
+    const int vector_end = rows.columns & ~7;
+    for (int y = 0; y < rows.count; ++y) {
+        const uint8_t* add = rows[y + radius + 1];
+        const uint8_t* sub = rows[y - radius];
+        uint8_t* out = dst + static_cast<size_t>(y) * rows.columns;
+
+        for (int c = 0; c < vector_end; c += 8) {
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + c));
+            __m256i v = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(s, mulv), half), 16);
+            // Packs work per 128-bit lane: lane 0 ends up with columns 0-3
+            // in its low dword, lane 1 with columns 4-7
+            v = _mm256_packus_epi16(_mm256_packus_epi32(v, v), v);
+            int low = _mm_cvtsi128_si32(_mm256_castsi256_si128(v));
+            int high = _mm_cvtsi128_si32(_mm256_extracti128_si256(v, 1));
+            std::memcpy(out + c, &low, 4);
+            std::memcpy(out + c + 4, &high, 4);
+
+            __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(add + c)));
+            __m256i b = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sub + c)));
+            s = _mm256_sub_epi32(_mm256_add_epi32(s, a), b);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + c), s);
+        }
+        step_scalar(sums, add, sub, out, vector_end, rows.columns, mul);
+    }
+}
+
+#endif // SRDWM_BLUR_X86
+
+void box_columns(Isa isa, const Rows& rows, uint8_t* dst, int radius, uint32_t* sums) {
+#if SRDWM_BLUR_X86
+    if (isa == Isa::AVX2) {
+        columns_avx2(rows, dst, radius, sums);
+        return;
+    }
+    if (isa == Isa::SSE41) {
+        columns_sse41(rows, dst, radius, sums);
+        return;
+    }
+#else
+    (void)isa;
+#endif
+    columns_scalar(rows, dst, radius, sums);
+}
+
+// src is height rows of width elements of Size bytes; dst gets width
+// rows of height elements. Blocked to stay within cache lines.
+template <size_t Size>
+void transpose(const uint8_t* src, uint8_t* dst, int width, int height) {
+    constexpr int kBlock = 32;
+    for (int by = 0; by < height; by += kBlock) {
+        int y_end = std::min(height, by + kBlock);
+        for (int bx = 0; bx < width; bx += kBlock) {
+            int x_end = std::min(width, bx + kBlock);
+            for (int y = by; y < y_end; ++y) {
+                const uint8_t* row = src + static_cast<size_t>(y) * width * Size;
+                for (int x = bx; x < x_end; ++x) {
+                    std::memcpy(dst + (static_cast<size_t>(x) * height + y) * Size, row + static_cast<size_t>(x) * Size,
+                                Size);
+                }
+            }
+        }
+    }
+}
+
+void transpose(const uint8_t* src, uint8_t* dst, int width, int height, int channels) {
+    if (channels == 4) {
+        transpose<4>(src, dst, width, height);
+    } else {
+        transpose<1>(src, dst, width, height);
+    }
+}
+
+// Column passes with each radius in turn, then the same along rows
+void separable_blur(uint8_t* pixels, int width, int height, int channels, const int* radii, int passes, Edge edge,
+                    Isa isa) {
+    if (width <= 0 || height <= 0 || (channels != 1 && channels != 4)) return;
+
+    const size_t bytes = static_cast<size_t>(width) * height * channels;
+    std::vector<uint8_t> scratch(bytes);
+    std::vector<uint8_t> transposed(bytes);
+    std::vector<uint8_t> zero(static_cast<size_t>(std::max(width, height)) * channels, 0);
+    std::vector<uint32_t> sums(zero.size());
+
+    auto column_passes = [&](uint8_t* data, int columns, int count) {
+        // Ping-pong between data and scratch; an odd pass count ends in
+        // scratch and is copied back
+        uint8_t* src = data;
+        uint8_t* dst = scratch.data();
+        for (int i = 0; i < passes; ++i) {
+            int radius = std::min(kMaxRadius, std::max(0, radii[i]));
+            box_columns(isa, Rows{src, zero.data(), columns, count, edge}, dst, radius, sums.data());
+            std::swap(src, dst);
+        }
+        if (src != data) std::memcpy(data, src, static_cast<size_t>(columns) * count);
+    };
+
+    column_passes(pixels, width * channels, height);
+    transpose(pixels, transposed.data(), width, height, channels);
+    column_passes(transposed.data(), height * channels, width);
+    transpose(transposed.data(), pixels, height, width, channels);
+}
+
+} // namespace
+
+Isa detect_isa() {
+#if SRDWM_BLUR_X86
+    static const Isa isa = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return Isa::AVX2;
+        if (__builtin_cpu_supports("sse4.1")) return Isa::SSE41;
+        return Isa::Scalar;
+    }();
+    return isa;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::AVX2: return "avx2";
+        case Isa::SSE41: return "sse4.1";
+        default: return "scalar";
+    }
+}
+
+std::array<int, 3> gaussian_box_radii(double sigma) {
+    // Box widths whose three-fold convolution has the Gaussian's variance
+    const int n = 3;
+    double ideal = std::sqrt(12.0 * sigma * sigma / n + 1.0);
+    int lower = static_cast<int>(std::floor(ideal));
+    if (lower % 2 == 0) lower--;
+    lower = std::max(1, lower);
+    int upper = lower + 2;
+    double m_ideal = (12.0 * sigma * sigma - n * lower * lower - 4.0 * n * lower - 3.0 * n) / (-4.0 * lower - 4.0);
+    int m = static_cast<int>(std::lround(m_ideal));
+
+    std::array<int, 3> radii{};
+    for (int i = 0; i < n; ++i) {
+        radii[static_cast<size_t>(i)] = ((i < m ? lower : upper) - 1) / 2;
+    }
+    return radii;
+}
+
+int gaussian_extent(double sigma) {
+    std::array<int, 3> radii = gaussian_box_radii(sigma);
+    return radii[0] + radii[1] + radii[2];
+}
+
+void box_blur(uint8_t* pixels, int width, int height, int channels, int radius, Edge edge, Isa isa) {
+    separable_blur(pixels, width, height, channels, &radius, 1, edge, isa);
+}
+
+void gaussian_blur(uint8_t* pixels, int width, int height, int channels, double sigma, Edge edge, Isa isa) {
+    std::array<int, 3> radii = gaussian_box_radii(sigma);
+    separable_blur(pixels, width, height, channels, radii.data(), 3, edge, isa);
+}
+
+} // namespace Blur
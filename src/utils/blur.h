@@ -0,0 +1,41 @@
+#ifndef SRDWM_BLUR_H
+#define SRDWM_BLUR_H
+
+#include <array>
+#include <cstdint>
+
+// Separable box and Gaussian blur on 8-bit pixel buffers (A8 masks or
+// 32-bit pixels treated as four independent channels).
+//
+// Each pass runs along columns with a running sum, so the cost per pixel
+// does not depend on the radius; a row of sums is updated with SSE4.1 or
+// AVX2 when the CPU has them (chosen at run time, no special build flags).
+// The horizontal direction is done as a column pass over a transposed
+// copy. A Gaussian is approximated by three box passes.
+namespace Blur {
+
+// What lies beyond the image: transparent black (shadow masks) or the
+// nearest edge pixel (background blur)
+enum class Edge { Transparent, Clamp };
+
+enum class Isa { Scalar, SSE41, AVX2 };
+
+Isa detect_isa();
+const char* isa_name(Isa isa);
+
+// Radii of the three box passes approximating a Gaussian of sigma
+std::array<int, 3> gaussian_box_radii(double sigma);
+
+// How far the Gaussian spreads past an edge, in pixels
+int gaussian_extent(double sigma);
+
+// pixels holds height rows of width * channels bytes; channels is 1 or 4.
+// Radii above 127 are clamped.
+void box_blur(uint8_t* pixels, int width, int height, int channels, int radius, Edge edge,
+              Isa isa = detect_isa());
+void gaussian_blur(uint8_t* pixels, int width, int height, int channels, double sigma, Edge edge,
+                   Isa isa = detect_isa());
+
+} // namespace Blur
+
+#endif // SRDWM_BLUR_H
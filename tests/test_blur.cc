@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "../src/utils/blur.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> random_pixels(int width, int height, int channels) {
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * channels);
+    for (uint8_t& p : pixels) p = static_cast<uint8_t>(rng());
+    return pixels;
+}
+
+} // namespace
+
+TEST(BlurTest, VectorKernelsMatchScalarReference) {
+    // Odd sizes exercise the scalar tails of the vector loops
+    for (int channels : {1, 4}) {
+        for (Blur::Edge edge : {Blur::Edge::Transparent, Blur::Edge::Clamp}) {
+            std::vector<uint8_t> reference = random_pixels(67, 45, channels);
+            Blur::gaussian_blur(reference.data(), 67, 45, channels, 4.0, edge, Blur::Isa::Scalar);
+
+            for (Blur::Isa isa : {Blur::Isa::SSE41, Blur::Isa::AVX2}) {
+                if (static_cast<int>(isa) > static_cast<int>(Blur::detect_isa())) continue;
+                std::vector<uint8_t> pixels = random_pixels(67, 45, channels);
+                Blur::gaussian_blur(pixels.data(), 67, 45, channels, 4.0, edge, isa);
+                EXPECT_EQ(pixels, reference) << Blur::isa_name(isa) << " channels=" << channels;
+            }
+        }
+    }
+}
+
+TEST(BlurTest, ClampKeepsFlatImageFlat) {
+    std::vector<uint8_t> pixels(32 * 16, 200);
+    Blur::box_blur(pixels.data(), 32, 16, 1, 5, Blur::Edge::Clamp);
+    for (uint8_t p : pixels) EXPECT_EQ(p, 200);
+}
+
+TEST(BlurTest, TransparentEdgeFadesAndSpreads) {
+    // A single opaque pixel spreads exactly as far as the extent
+    const int size = 41;
+    std::vector<uint8_t> pixels(size * size, 0);
+    pixels[20 * size + 20] = 255;
+    Blur::box_blur(pixels.data(), size, size, 1, 3, Blur::Edge::Transparent);
+    EXPECT_GT(pixels[20 * size + 23], 0);
+    EXPECT_EQ(pixels[20 * size + 24], 0);
+    EXPECT_EQ(pixels[0], 0);
+}
+
+TEST(BlurTest, GaussianBoxRadiiGrowWithSigma) {
+    EXPECT_LE(Blur::gaussian_extent(2.0), Blur::gaussian_extent(6.0));
+    std::array<int, 3> radii = Blur::gaussian_box_radii(6.0);
+    for (int r : radii) EXPECT_GT(r, 0);
+}
+
+TEST(BlurTest, ShadowCornersDoNotDependOnBoxSize) {
+    // The shadow cache relies on this: past 2 * extent the corners of a
+    // blurred box match those of a box of 2 * extent + 1, and the middle
+    // of each edge is one row or column repeated
+    const double sigma = 6.0;
+    const int e = Blur::gaussian_extent(sigma);
+    auto shadow = [&](int w, int h) {
+        std::vector<uint8_t> pixels(static_cast<size_t>((w + 2 * e) * (h + 2 * e)), 0);
+        for (int y = e; y < e + h; ++y) {
+            for (int x = e; x < e + w; ++x) pixels[static_cast<size_t>(y * (w + 2 * e) + x)] = 128;
+        }
+        Blur::gaussian_blur(pixels.data(), w + 2 * e, h + 2 * e, 1, sigma, Blur::Edge::Transparent);
+        return pixels;
+    };
+
+    const int t = 4 * e + 1;
+    std::vector<uint8_t> tmpl = shadow(2 * e + 1, 2 * e + 1);
+    const int w = 150, h = 90, W = w + 2 * e;
+    std::vector<uint8_t> big = shadow(w, h);
+    for (int y = 0; y < 2 * e; ++y) {
+        for (int x = 0; x < 2 * e; ++x) {
+            EXPECT_EQ(big[static_cast<size_t>(y * W + x)], tmpl[static_cast<size_t>(y * t + x)]);
+            EXPECT_EQ(big[static_cast<size_t>(y * W + (W - 2 * e + x))], tmpl[static_cast<size_t>(y * t + 2 * e + 1 + x)]);
+        }
+        for (int x = 2 * e; x < W - 2 * e; ++x) {
+            EXPECT_EQ(big[static_cast<size_t>(y * W + x)], tmpl[static_cast<size_t>(y * t + 2 * e)]);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "../src/input/key_binding_table.h"
+
+class KeyBindingTableTest : public ::testing::Test {
+protected:
+    KeyBindingTable table;
+    int fired = 0;
+};
+
+TEST_F(KeyBindingTableTest, ParseNormalizesModifierOrder) {
+    uint32_t modifiers;
+    std::string key;
+    
+    ASSERT_TRUE(KeyBindingTable::parse("Shift+Mod4+q", modifiers, key));
+    EXPECT_EQ(modifiers, KeyMod::Super | KeyMod::Shift);
+    EXPECT_EQ(key, "q");
+    EXPECT_EQ(KeyBindingTable::normalize(modifiers, key), "Shift+Mod4+q");
+    
+    EXPECT_FALSE(KeyBindingTable::parse("Hyper+q", modifiers, key));
+}
+
+TEST_F(KeyBindingTableTest, LookupMatchesEveryLockVariant) {
+    table.bind("Mod4+Shift+q", [this]() { fired++; });
+    table.compile();
+    
+    for (uint32_t locks : {0u, KeyMod::NumLock, KeyMod::CapsLock, KeyMod::Locks}) {
+        const KeyBindingTable::Action* action = table.find('Q', KeyMod::Super | KeyMod::Shift | locks);
+        ASSERT_NE(action, nullptr);
+        (*action)();
+    }
+    EXPECT_EQ(fired, 4);
+    EXPECT_EQ(table.find('Q', KeyMod::Super), nullptr);
+    EXPECT_EQ(table.grabs().size(), 4u);
+}
+
+TEST_F(KeyBindingTableTest, UnbindTakesEffectOnRecompile) {
+    table.bind("Mod4+1", [this]() { fired++; });
+    table.compile();
+    ASSERT_NE(table.find('1', KeyMod::Super), nullptr);
+    
+    EXPECT_TRUE(table.unbind("Mod4+1"));
+    EXPECT_TRUE(table.dirty());
+    table.compile();
+    EXPECT_EQ(table.find('1', KeyMod::Super), nullptr);
+    EXPECT_TRUE(table.grabs().empty());
+}
+
+TEST_F(KeyBindingTableTest, ResolverSuppliesKeyCodes) {
+    table.set_resolver([](const std::string& name) {
+        return name == "Return" ? std::vector<uint32_t>{36} : std::vector<uint32_t>{};
+    });
+    table.bind("Mod4+Return", [this]() { fired++; });
+    table.compile();
+    
+    EXPECT_NE(table.find(36, KeyMod::Super), nullptr);
+}
+
+TEST_F(KeyBindingTableTest, SequenceAdvancesOneKeyAtATime) {
+    table.bind("Mod4+w f", [this]() { fired++; });
+    table.bind("Mod4+w g", [this]() { fired += 10; });
+    table.compile();
+    
+    // Only the first key of the sequence is grabbed passively
+    EXPECT_EQ(table.grabs().size(), 4u);
+    EXPECT_EQ(table.find('W', KeyMod::Super), nullptr);
+    
+    const KeyBindingTable::Action* action = nullptr;
+    EXPECT_EQ(table.press('W', KeyMod::Super, action), KeyBindingTable::PressResult::Pending);
+    EXPECT_TRUE(table.sequence_pending());
+    EXPECT_TRUE(table.wants_keyboard());
+    
+    EXPECT_EQ(table.press('G', 0, action), KeyBindingTable::PressResult::Handled);
+    ASSERT_NE(action, nullptr);
+    (*action)();
+    EXPECT_EQ(fired, 10);
+    EXPECT_FALSE(table.wants_keyboard());
+    
+    // A key outside the sequence abandons it
+    table.press('W', KeyMod::Super, action);
+    EXPECT_EQ(table.press('X', 0, action), KeyBindingTable::PressResult::Unbound);
+    EXPECT_FALSE(table.sequence_pending());
+}
+
+TEST_F(KeyBindingTableTest, ModeKeepsKeysUntilEscape) {
+    table.set_resolver([](const std::string& name) {
+        return name == "Escape" ? std::vector<uint32_t>{9} : KeyBindingTable::default_key_codes(name);
+    });
+    table.bind("h", [this]() { fired++; }, "resize");
+    table.compile();
+    
+    const KeyBindingTable::Action* action = nullptr;
+    EXPECT_EQ(table.press('H', 0, action), KeyBindingTable::PressResult::Unbound);
+    
+    ASSERT_TRUE(table.enter_mode("resize"));
+    EXPECT_FALSE(table.enter_mode("move"));
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(table.press('H', 0, action), KeyBindingTable::PressResult::Handled);
+        (*action)();
+    }
+    EXPECT_EQ(fired, 3);
+    EXPECT_TRUE(table.in_mode());
+    
+    EXPECT_EQ(table.press(9, KeyMod::NumLock, action), KeyBindingTable::PressResult::Handled);
+    EXPECT_EQ(action, nullptr);
+    EXPECT_FALSE(table.in_mode());
+    EXPECT_FALSE(table.wants_keyboard());
+}
+
+TEST_F(KeyBindingTableTest, RefreshOnlyDirtiesOnChangedKeyCodes) {
+    uint32_t return_code = 36;
+    table.set_resolver([&return_code](const std::string& name) {
+        return name == "Return" ? std::vector<uint32_t>{return_code} : std::vector<uint32_t>{};
+    });
+    table.bind("Mod4+Return", [this]() { fired++; });
+    table.compile();
+    
+    EXPECT_FALSE(table.refresh_key_codes());
+    EXPECT_FALSE(table.dirty());
+    
+    return_code = 104;
+    EXPECT_TRUE(table.refresh_key_codes());
+    EXPECT_TRUE(table.dirty());
+    table.compile();
+    EXPECT_EQ(table.find(36, KeyMod::Super), nullptr);
+    EXPECT_NE(table.find(104, KeyMod::Super), nullptr);
+}
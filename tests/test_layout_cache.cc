@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "../src/layouts/layout_cache.h"
+#include "../src/layouts/tiling_layout.h"
+#include "../src/core/window.h"
+#include <memory>
+
+class LayoutCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        monitor = Monitor(1, 0, 0, 1920, 1080);
+        for (int i = 0; i < 3; ++i) {
+            owned.push_back(std::make_unique<SRDWindow>(i + 1, "Window " + std::to_string(i + 1)));
+            owned.back()->setGeometry(100 * i, 100 * i, 400, 300);
+            windows.push_back(owned.back().get());
+        }
+    }
+    
+    Monitor monitor;
+    std::vector<std::unique_ptr<SRDWindow>> owned;
+    std::vector<SRDWindow*> windows;
+    LayoutCache cache;
+};
+
+TEST_F(LayoutCacheTest, UnchangedInputsStayValid) {
+    EXPECT_FALSE(cache.valid(monitor.id, LayoutCache::stamp(windows, monitor, 1)));
+    
+    cache.store(monitor.id, LayoutCache::stamp(windows, monitor, 1));
+    EXPECT_TRUE(cache.valid(monitor.id, LayoutCache::stamp(windows, monitor, 1)));
+    EXPECT_FALSE(cache.valid(2, LayoutCache::stamp(windows, monitor, 1)));
+}
+
+TEST_F(LayoutCacheTest, AnyInputChangeInvalidates) {
+    cache.store(monitor.id, LayoutCache::stamp(windows, monitor, 1));
+    
+    // Configuration generation
+    EXPECT_FALSE(cache.valid(monitor.id, LayoutCache::stamp(windows, monitor, 2)));
+    
+    // Monitor geometry
+    Monitor resized = monitor;
+    resized.width = 2560;
+    EXPECT_FALSE(cache.valid(monitor.id, LayoutCache::stamp(windows, resized, 1)));
+    
+    // Window order
+    std::vector<SRDWindow*> reordered{windows[1], windows[0], windows[2]};
+    EXPECT_FALSE(cache.valid(monitor.id, LayoutCache::stamp(reordered, monitor, 1)));
+    
+    // Window set
+    std::vector<SRDWindow*> fewer{windows[0], windows[1]};
+    EXPECT_FALSE(cache.valid(monitor.id, LayoutCache::stamp(fewer, monitor, 1)));
+    
+    // A window moved away from where the layout put it
+    windows[2]->setPosition(5, 5);
+    EXPECT_FALSE(cache.valid(monitor.id, LayoutCache::stamp(windows, monitor, 1)));
+}
+
+TEST_F(LayoutCacheTest, RelayoutReproducesStoredStamp) {
+    // What the next pass sees is exactly what was stored after the last
+    // one, so it is skipped
+    TilingLayout tiling;
+    tiling.arrange_windows(windows, monitor);
+    cache.store(monitor.id, LayoutCache::stamp(windows, monitor, 1));
+    
+    EXPECT_TRUE(cache.valid(monitor.id, LayoutCache::stamp(windows, monitor, 1)));
+    tiling.arrange_windows(windows, monitor);
+    EXPECT_TRUE(cache.valid(monitor.id, LayoutCache::stamp(windows, monitor, 1)));
+}
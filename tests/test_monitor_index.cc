@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "../src/layouts/monitor_index.h"
+
+class MonitorIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // A 1080p laptop panel, a 4K screen to its right, and a 1200p
+        // screen stacked above the laptop
+        index.build({Monitor(0, 0, 1200, 1920, 1080), Monitor(1, 1920, 0, 3840, 2160),
+                     Monitor(2, 0, 0, 1920, 1200)});
+    }
+    
+    MonitorIndex index;
+};
+
+TEST_F(MonitorIndexTest, FindsMonitorById) {
+    ASSERT_NE(index.find(1), nullptr);
+    EXPECT_EQ(index.find(1)->width, 3840);
+    EXPECT_EQ(index.find(7), nullptr);
+}
+
+TEST_F(MonitorIndexTest, PointLookup) {
+    ASSERT_NE(index.at(10, 10), nullptr);
+    EXPECT_EQ(index.at(10, 10)->id, 2);
+    EXPECT_EQ(index.at(1919, 1200)->id, 0);
+    EXPECT_EQ(index.at(1920, 1200)->id, 1);
+    EXPECT_EQ(index.at(5759, 2159)->id, 1);
+    
+    // Below the laptop, and past the right edge
+    EXPECT_EQ(index.at(100, 2300), nullptr);
+    EXPECT_EQ(index.at(5760, 100), nullptr);
+}
+
+TEST_F(MonitorIndexTest, NearestClampsIntoGaps) {
+    const Monitor* monitor = index.nearest(100, 2300);
+    ASSERT_NE(monitor, nullptr);
+    EXPECT_EQ(monitor->id, 0);
+    EXPECT_EQ(index.nearest(9000, 100)->id, 1);
+}
+
+TEST_F(MonitorIndexTest, EmptyIndex) {
+    MonitorIndex empty;
+    empty.build({});
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.at(0, 0), nullptr);
+    EXPECT_EQ(empty.nearest(0, 0), nullptr);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "../src/core/occlusion_tracker.h"
+
+class OcclusionTrackerTest : public ::testing::Test {
+protected:
+    void manage(OcclusionTracker::Id id, int x, int y, int width, int height) {
+        tracker.add(id);
+        tracker.set_geometry(id, {x, y, width, height});
+        tracker.set_tracked(id, true);
+        tracker.set_mapped(id, true);
+    }
+
+    OcclusionTracker tracker;
+};
+
+TEST_F(OcclusionTrackerTest, FullyCoveredWindowIsHidden) {
+    manage(1, 100, 100, 400, 300);
+    manage(2, 0, 0, 1920, 1080);
+
+    auto changes = tracker.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].id, 1u);
+    EXPECT_FALSE(changes[0].visible);
+    EXPECT_TRUE(tracker.visible(2));
+}
+
+TEST_F(OcclusionTrackerTest, UnionOfWindowsCanCover) {
+    manage(1, 0, 0, 200, 100);
+    manage(2, 0, 0, 100, 100);
+    manage(3, 100, 0, 100, 100);
+    tracker.update();
+    EXPECT_FALSE(tracker.visible(1));
+
+    // Shrinking one of the covering windows uncovers a strip
+    tracker.set_geometry(3, {100, 0, 90, 100});
+    auto changes = tracker.update();
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_TRUE(changes[0].visible);
+}
+
+TEST_F(OcclusionTrackerTest, RestackAndUnmapUncover) {
+    manage(1, 0, 0, 100, 100);
+    manage(2, 0, 0, 100, 100);
+    tracker.update();
+    EXPECT_FALSE(tracker.visible(1));
+
+    tracker.raise(1);
+    tracker.update();
+    EXPECT_TRUE(tracker.visible(1));
+    EXPECT_FALSE(tracker.visible(2));
+
+    tracker.set_mapped(1, false);
+    tracker.update();
+    EXPECT_TRUE(tracker.visible(2));
+}
+
+TEST_F(OcclusionTrackerTest, UntrackedWindowsDoNotOcclude) {
+    manage(1, 0, 0, 100, 100);
+    tracker.add(2);
+    tracker.set_geometry(2, {0, 0, 500, 500});
+    tracker.set_mapped(2, true);
+
+    EXPECT_TRUE(tracker.update().empty());
+    EXPECT_TRUE(tracker.visible(1));
+}
+
+TEST_F(OcclusionTrackerTest, TranslucentWindowsDoNotOcclude) {
+    manage(1, 0, 0, 100, 100);
+    manage(2, 0, 0, 100, 100);
+    tracker.update();
+    EXPECT_FALSE(tracker.visible(1));
+
+    tracker.set_opaque(2, false);
+    tracker.update();
+    EXPECT_TRUE(tracker.visible(1));
+}
+
+TEST_F(OcclusionTrackerTest, OnlyReportsFlips) {
+    manage(1, 0, 0, 100, 100);
+    manage(2, 500, 500, 100, 100);
+    tracker.update();
+
+    // Moving a window around empty space changes nobody's visibility
+    tracker.set_geometry(2, {600, 600, 100, 100});
+    EXPECT_TRUE(tracker.update().empty());
+
+    tracker.restack(2, 0);
+    EXPECT_TRUE(tracker.update().empty());
+    EXPECT_EQ(tracker.top(), 1u);
+}
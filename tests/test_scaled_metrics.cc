@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include "../src/layouts/scaled_metrics.h"
+
+TEST(ScaledMetricsTest, SnapsScalesToBuckets) {
+    EXPECT_EQ(ScaledMetrics::bucket(1.0f), 4);
+    EXPECT_EQ(ScaledMetrics::bucket(1.1f), 4);
+    EXPECT_EQ(ScaledMetrics::bucket(1.5f), 6);
+    EXPECT_EQ(ScaledMetrics::bucket(2.0f), 8);
+    EXPECT_EQ(ScaledMetrics::bucket(0.1f), 2);
+    EXPECT_EQ(ScaledMetrics::bucket(10.0f), 16);
+    EXPECT_EQ(ScaledMetrics::bucket(0.0f), 4);
+    EXPECT_FLOAT_EQ(ScaledMetrics::bucket_scale(6), 1.5f);
+}
+
+TEST(ScaledMetricsTest, ScalesEveryMetric) {
+    ScaledMetrics metrics;
+    metrics.set_base({30, 10, 1, 8});
+
+    const Metrics& doubled = metrics.at(2.0f);
+    EXPECT_EQ(doubled.titlebar_height, 60);
+    EXPECT_EQ(doubled.text_padding, 20);
+    EXPECT_EQ(doubled.border_width, 2);
+    EXPECT_EQ(doubled.gap, 16);
+
+    // One pixel borders stay visible when scaled down; zero stays zero
+    metrics.set_base({30, 10, 1, 0});
+    EXPECT_EQ(metrics.at(0.5f).border_width, 1);
+    EXPECT_EQ(metrics.at(0.5f).gap, 0);
+}
+
+TEST(ScaledMetricsTest, CachesPerBucketUntilBaseChanges) {
+    ScaledMetrics metrics;
+    const Metrics* first = &metrics.at(2.0f);
+    EXPECT_EQ(&metrics.at(1.95f), first);
+
+    metrics.set_base({40, 10, 2, 0});
+    EXPECT_EQ(metrics.at(2.0f).titlebar_height, 80);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "../src/core/session_snapshot.h"
+
+namespace {
+
+SessionSnapshot sample_snapshot() {
+    SessionSnapshot snapshot;
+    snapshot.current_workspace = 2;
+    snapshot.focused_window = 0x1a00007;
+    snapshot.workspaces = {{1, "web", "tiling", {0x1a00007, 0x1c00003}},
+                           {2, "", "monocle", {}},
+                           {3, "chat", "dynamic", {0x2200001}}};
+    snapshot.floating_windows = {0x1c00003};
+    snapshot.focus_order = {0x1a00007, 0x2200001, 0x1c00003};
+    snapshot.monitor_layouts = {{0, "tiling"}, {1, "monocle"}};
+    snapshot.geometries = {{0x1a00007, 0, 24, 960, 1056}, {0x1c00003, -40, 300, 640, 480}};
+    return snapshot;
+}
+
+} // namespace
+
+TEST(SessionSnapshotTest, RoundTripKeepsEveryField) {
+    const SessionSnapshot snapshot = sample_snapshot();
+    const std::vector<uint8_t> data = snapshot.serialize();
+
+    SessionSnapshot restored;
+    ASSERT_TRUE(SessionSnapshot::deserialize(data.data(), data.size(), restored));
+    EXPECT_EQ(restored.current_workspace, 2);
+    EXPECT_EQ(restored.focused_window, 0x1a00007);
+    ASSERT_EQ(restored.workspaces.size(), 3u);
+    for (size_t i = 0; i < restored.workspaces.size(); ++i) {
+        EXPECT_EQ(restored.workspaces[i].id, snapshot.workspaces[i].id);
+        EXPECT_EQ(restored.workspaces[i].name, snapshot.workspaces[i].name);
+        EXPECT_EQ(restored.workspaces[i].layout, snapshot.workspaces[i].layout);
+        EXPECT_EQ(restored.workspaces[i].windows, snapshot.workspaces[i].windows);
+    }
+    EXPECT_EQ(restored.floating_windows, snapshot.floating_windows);
+    EXPECT_EQ(restored.focus_order, snapshot.focus_order);
+    ASSERT_EQ(restored.monitor_layouts.size(), 2u);
+    EXPECT_EQ(restored.monitor_layouts[1].monitor_id, 1);
+    EXPECT_EQ(restored.monitor_layouts[1].layout, "monocle");
+    ASSERT_EQ(restored.geometries.size(), 2u);
+    EXPECT_EQ(restored.geometries[1].id, 0x1c00003);
+    EXPECT_EQ(restored.geometries[1].x, -40);
+    EXPECT_EQ(restored.geometries[1].height, 480);
+}
+
+TEST(SessionSnapshotTest, TruncatedDataIsRejected) {
+    const std::vector<uint8_t> data = sample_snapshot().serialize();
+
+    // Every proper prefix, down to nothing at all, must fail cleanly
+    for (size_t size = 0; size < data.size(); ++size) {
+        SessionSnapshot restored;
+        EXPECT_FALSE(SessionSnapshot::deserialize(data.data(), size, restored)) << "prefix of " << size;
+    }
+}
+
+TEST(SessionSnapshotTest, ForeignMagicIsRejected) {
+    std::vector<uint8_t> data = sample_snapshot().serialize();
+    data[0] ^= 0xff;
+
+    SessionSnapshot restored;
+    restored.current_workspace = 5;
+    EXPECT_FALSE(SessionSnapshot::deserialize(data.data(), data.size(), restored));
+    // A rejected blob leaves the output alone
+    EXPECT_EQ(restored.current_workspace, 5);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "../src/layouts/work_area.h"
+
+class WorkAreaTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Two 1080p screens side by side
+        tracker.set_monitors({Monitor(0, 0, 0, 1920, 1080), Monitor(1, 1920, 0, 1920, 1080)});
+        tracker.update();
+    }
+
+    WorkAreaTracker tracker;
+};
+
+TEST_F(WorkAreaTest, FullStrutSpansEveryMonitorOnItsEdge) {
+    tracker.set_strut(1, WorkAreaTracker::Strut::from_properties({}, {0, 0, 30, 0}));
+    auto changed = tracker.update();
+    EXPECT_EQ(changed, (std::vector<int>{0, 1}));
+    EXPECT_EQ(tracker.area(0)->y, 30);
+    EXPECT_EQ(tracker.area(1)->height, 1050);
+}
+
+TEST_F(WorkAreaTest, PartialStrutOnlyTouchesItsMonitor) {
+    // A bottom bar across the right screen only
+    tracker.set_strut(7, WorkAreaTracker::Strut::from_properties({0, 0, 0, 24, 0, 0, 0, 0, 0, 0, 1920, 3839}, {}));
+    auto changed = tracker.update();
+    EXPECT_EQ(changed, (std::vector<int>{1}));
+    EXPECT_EQ(tracker.area(0)->height, 1080);
+    EXPECT_EQ(tracker.area(1)->height, 1056);
+
+    // Re-setting the same strut changes nothing; removing it restores the area
+    tracker.set_strut(7, WorkAreaTracker::Strut::from_properties({0, 0, 0, 24, 0, 0, 0, 0, 0, 0, 1920, 3839}, {}));
+    EXPECT_TRUE(tracker.update().empty());
+    tracker.remove(7);
+    EXPECT_EQ(tracker.update(), (std::vector<int>{1}));
+    EXPECT_EQ(tracker.area(1)->height, 1080);
+}
+
+TEST_F(WorkAreaTest, StrutsSurviveMonitorChanges) {
+    tracker.set_strut(1, WorkAreaTracker::Strut::from_properties({}, {40, 0, 0, 0}));
+    tracker.update();
+
+    tracker.set_monitors({Monitor(0, 0, 0, 2560, 1440)});
+    EXPECT_EQ(tracker.update(), (std::vector<int>{0}));
+    EXPECT_EQ(tracker.area(0)->x, 40);
+    EXPECT_EQ(tracker.area(0)->width, 2520);
+    EXPECT_EQ(tracker.area(1), nullptr);
+}
+
+TEST_F(WorkAreaTest, PublishedWorkAreaMatchesTrackedAreas) {
+    // Panels on top of the left screen and at the bottom of the right one
+    tracker.set_strut(1, WorkAreaTracker::Strut::from_properties({0, 0, 28, 0, 0, 0, 0, 0, 0, 1919, 0, 0}, {}));
+    tracker.set_strut(2, WorkAreaTracker::Strut::from_properties({0, 0, 0, 32, 0, 0, 0, 0, 0, 0, 1920, 3839}, {}));
+    tracker.update();
+
+    const Monitor* left = tracker.area(0);
+    const Monitor* right = tracker.area(1);
+    ASSERT_TRUE(left && right);
+    // The bounding box runs from the right screen's top to the left one's bottom
+    const std::vector<uint32_t> box = {static_cast<uint32_t>(left->x), static_cast<uint32_t>(right->y),
+                                       static_cast<uint32_t>(right->x + right->width - left->x),
+                                       static_cast<uint32_t>(left->y + left->height - right->y)};
+    EXPECT_EQ(box, (std::vector<uint32_t>{0, 0, 3840, 1080}));
+
+    // One rectangle per desktop, all the same
+    std::vector<uint32_t> values = tracker.net_workarea(3);
+    ASSERT_EQ(values.size(), 12u);
+    for (size_t i = 0; i < values.size(); i += 4) {
+        EXPECT_EQ(std::vector<uint32_t>(values.begin() + i, values.begin() + i + 4), box);
+    }
+
+    // A strut spanning both screens shrinks the published box too
+    tracker.set_strut(3, WorkAreaTracker::Strut::from_properties({}, {0, 0, 40, 0}));
+    tracker.update();
+    EXPECT_EQ(tracker.net_workarea(1), (std::vector<uint32_t>{0, 40, 3840, 1040}));
+}